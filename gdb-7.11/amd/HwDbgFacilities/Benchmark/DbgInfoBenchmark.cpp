@@ -0,0 +1,851 @@
+//==============================================================================
+// Copyright (c) 2016-2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief Description: Microbenchmarks for the HwDbgFacilities C interface.
+///                     A synthetic kernel is generated as C source and compiled by the host
+///                     compiler into an ELF with DWARF, so no GPU or GPU compiler is needed.
+///                     The results are written to stdout as JSON. With --threads, a frozen
+///                     debug info is also queried from several threads at once, and every
+///                     answer is checked against the single-threaded one.
+//==============================================================================
+// C / C++:
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// HwDbgFacilities:
+#include "FacilitiesInterface.h"
+
+/// The compiler used to build the synthetic kernel, unless --cc is given:
+#define DBGINFO_BENCHMARK_DEFAULT_CC "cc"
+/// Every this many lines, a kernel line calls the chain of inlined functions:
+#define DBGINFO_BENCHMARK_INLINE_CALL_PERIOD 8
+
+/// -----------------------------------------------------------------------------------------------
+/// \struct BenchmarkConfig
+/// \brief Description: The shape of the synthetic kernel and the number of timed runs
+/// -----------------------------------------------------------------------------------------------
+struct BenchmarkConfig
+{
+    BenchmarkConfig()
+        : m_cuCount(4), m_lineCount(2000), m_inlineDepth(4), m_varCount(32), m_iterations(5), m_threadCount(0), m_compiler(DBGINFO_BENCHMARK_DEFAULT_CC), m_keepFiles(false) {};
+
+    unsigned int m_cuCount;         ///< Compilation units, each one holds a kernel function
+    unsigned int m_lineCount;       ///< Statement lines in each kernel function
+    unsigned int m_inlineDepth;     ///< Length of the chain of inlined functions called by the kernels
+    unsigned int m_varCount;        ///< Local variables in each kernel function
+    unsigned int m_iterations;      ///< Timed runs of each benchmark
+    unsigned int m_threadCount;     ///< Threads of the concurrent query stress test, 0 to skip it
+    std::string m_compiler;         ///< The host C compiler
+    bool m_keepFiles;               ///< Keep the generated sources and binaries
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// \struct BenchmarkContext
+/// \brief Description: The inputs shared by the benchmarks
+/// -----------------------------------------------------------------------------------------------
+struct BenchmarkContext
+{
+    BenchmarkContext() : m_pConfig(nullptr), m_dbg(nullptr), m_failures(0) {};
+
+    const BenchmarkConfig* m_pConfig;                       ///< The configuration
+    std::vector<char> m_binary;                             ///< The synthetic kernel binary
+    std::vector<unsigned char> m_index;                     ///< The index of the kernel's debug info
+    HwDbgInfo_debug m_dbg;                                  ///< The debug info queried by the benchmarks
+    std::vector<HwDbgInfo_addr> m_addrs;                    ///< All the mapped addresses
+    std::vector<HwDbgInfo_code_location> m_queryLines;      ///< The lines after each mapped address's line
+    std::vector<std::string> m_varNames;                    ///< A variable name to look up at each mapped address
+    std::vector<std::string> m_descriptions;                ///< The single-threaded description of each mapped address
+    size_t m_failures;                                      ///< Failed calls in the current benchmark
+};
+
+/// A benchmark runs its operations once and returns how many it ran:
+typedef size_t(*BenchmarkFunc)(BenchmarkContext& io_context);
+
+/// -----------------------------------------------------------------------------------------------
+/// \struct BenchmarkResult
+/// \brief Description: The timing of one benchmark
+/// -----------------------------------------------------------------------------------------------
+struct BenchmarkResult
+{
+    std::string m_name;         ///< The benchmark name
+    size_t m_ops;               ///< Operations per run
+    size_t m_failures;          ///< Failed calls over all the runs
+    double m_firstNs;           ///< The first (cold) run
+    double m_minNs;             ///< The fastest run
+    double m_meanNs;            ///< The mean of all the runs
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// GenerateCompilationUnitSource
+/// \brief Description: Writes the source of one compilation unit. The kernel function declares
+///                     the variables, then runs one statement per line; every few lines one of
+///                     them calls the chain of always-inline functions.
+/// \param[in]          config - the kernel shape
+/// \param[in]          cuIndex - the compilation unit index, which makes the kernel name unique
+/// \param[out]         o_source - the C source
+/// -----------------------------------------------------------------------------------------------
+static void GenerateCompilationUnitSource(const BenchmarkConfig& config, unsigned int cuIndex, std::string& o_source)
+{
+    std::ostringstream src;
+    unsigned int varCount = (0 < config.m_varCount) ? config.m_varCount : 1;
+
+    src << "struct bench_pt { int x; float y; };\n";
+
+    for (unsigned int d = 0; d < config.m_inlineDepth; d++)
+    {
+        src << "static inline __attribute__((always_inline)) int bench_inline_" << d << "(int a)\n";
+        src << "{\n";
+
+        if (0 == d)
+        {
+            src << "    int inl_" << d << " = a + 1;\n";
+        }
+        else
+        {
+            src << "    int inl_" << d << " = bench_inline_" << d - 1 << "(a) + " << d << ";\n";
+        }
+
+        src << "    return inl_" << d << ";\n";
+        src << "}\n";
+    }
+
+    src << "int bench_kernel_" << cuIndex << "(int n, struct bench_pt* p)\n";
+    src << "{\n";
+    src << "    struct bench_pt q = p[0];\n";
+
+    for (unsigned int v = 0; v < varCount; v++)
+    {
+        src << "    int var_" << v << " = n + " << v << ";\n";
+    }
+
+    for (unsigned int l = 0; l < config.m_lineCount; l++)
+    {
+        unsigned int v = l % varCount;
+
+        if ((0 < config.m_inlineDepth) && (0 == (l % DBGINFO_BENCHMARK_INLINE_CALL_PERIOD)))
+        {
+            src << "    var_" << v << " += bench_inline_" << config.m_inlineDepth - 1 << "(var_" << (v + 1) % varCount << ");\n";
+        }
+        else
+        {
+            src << "    var_" << v << " += q.x * " << l << ";\n";
+        }
+    }
+
+    src << "    return var_0 + (int)q.y;\n";
+    src << "}\n";
+
+    o_source = src.str();
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// BuildSyntheticKernel
+/// \brief Description: Generates and compiles the compilation units, and links them into a shared
+///                     object so each one gets its own addresses
+/// \param[in]          config - the kernel shape
+/// \param[out]         o_binary - the linked binary
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+static bool BuildSyntheticKernel(const BenchmarkConfig& config, std::vector<char>& o_binary)
+{
+    const char* pTmpDir = getenv("TMPDIR");
+    std::string workDirTemplate = std::string((nullptr != pTmpDir) ? pTmpDir : "/tmp") + "/hwdbgbench.XXXXXX";
+    std::vector<char> workDirBuf(workDirTemplate.begin(), workDirTemplate.end());
+    workDirBuf.push_back('\0');
+
+    if (nullptr == mkdtemp(&(workDirBuf[0])))
+    {
+        fprintf(stderr, "Cannot create a directory from %s\n", workDirTemplate.c_str());
+        return false;
+    }
+
+    std::string workDir = &(workDirBuf[0]);
+    std::string objects;
+    bool retVal = true;
+
+    for (unsigned int i = 0; retVal && (i < config.m_cuCount); i++)
+    {
+        std::ostringstream base;
+        base << workDir << "/cu_" << i;
+        std::string source;
+        GenerateCompilationUnitSource(config, i, source);
+
+        std::ofstream sourceFile((base.str() + ".c").c_str());
+        sourceFile << source;
+        sourceFile.close();
+
+        std::string compileCmd = config.m_compiler + " -gdwarf-2 -O0 -fPIC -c '" + base.str() + ".c' -o '" + base.str() + ".o'";
+        retVal = sourceFile.good() && (0 == system(compileCmd.c_str()));
+        objects += " '" + base.str() + ".o'";
+    }
+
+    std::string binaryPath = workDir + "/kernel.so";
+
+    if (retVal)
+    {
+        std::string linkCmd = config.m_compiler + " -shared -nostdlib" + objects + " -o '" + binaryPath + "'";
+        retVal = (0 == system(linkCmd.c_str()));
+    }
+
+    if (retVal)
+    {
+        std::ifstream binaryFile(binaryPath.c_str(), std::ios::binary);
+        o_binary.assign(std::istreambuf_iterator<char>(binaryFile), std::istreambuf_iterator<char>());
+        retVal = !o_binary.empty();
+    }
+
+    if (!retVal)
+    {
+        fprintf(stderr, "Cannot build the synthetic kernel in %s\n", workDir.c_str());
+    }
+    else if (config.m_keepFiles)
+    {
+        fprintf(stderr, "Synthetic kernel kept in %s\n", workDir.c_str());
+    }
+    else
+    {
+        std::string cleanCmd = "rm -rf '" + workDir + "'";
+        (void)system(cleanCmd.c_str());
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Benchmarks
+/// \brief Description: Each one runs its operations once over the whole context
+/// -----------------------------------------------------------------------------------------------
+static size_t BenchInitSingleLevel(BenchmarkContext& io_context)
+{
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    HwDbgInfo_debug dbg = hwdbginfo_init_with_single_level_binary(&(io_context.m_binary[0]), io_context.m_binary.size(), &err);
+    io_context.m_failures += (nullptr == dbg) ? 1 : 0;
+    hwdbginfo_release_debug_info(&dbg);
+
+    return 1;
+}
+
+static size_t BenchSerializeIndex(BenchmarkContext& io_context)
+{
+    size_t indexSize = 0;
+    HwDbgInfo_err err = hwdbginfo_serialize_index(io_context.m_dbg, 0, nullptr, &indexSize);
+    std::vector<unsigned char> index(indexSize);
+    err = (HWDBGINFO_E_SUCCESS == err) ? hwdbginfo_serialize_index(io_context.m_dbg, index.size(), &(index[0]), &indexSize) : err;
+    io_context.m_failures += (HWDBGINFO_E_SUCCESS != err) ? 1 : 0;
+
+    return 1;
+}
+
+static size_t BenchInitWithIndex(BenchmarkContext& io_context)
+{
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    HwDbgInfo_debug dbg = hwdbginfo_init_with_index(&(io_context.m_index[0]), io_context.m_index.size(), &err);
+    io_context.m_failures += (nullptr == dbg) ? 1 : 0;
+    hwdbginfo_release_debug_info(&dbg);
+
+    return 1;
+}
+
+static size_t BenchAddrToLine(BenchmarkContext& io_context)
+{
+    size_t addrCount = io_context.m_addrs.size();
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        HwDbgInfo_code_location loc = nullptr;
+        HwDbgInfo_err err = hwdbginfo_addr_to_line(io_context.m_dbg, io_context.m_addrs[i], &loc);
+        io_context.m_failures += (HWDBGINFO_E_SUCCESS != err) ? 1 : 0;
+        hwdbginfo_release_code_locations(&loc, 1);
+    }
+
+    return addrCount;
+}
+
+static size_t BenchAddrsToLines(BenchmarkContext& io_context)
+{
+    size_t addrCount = io_context.m_addrs.size();
+    std::vector<HwDbgInfo_linenum> lineNums(addrCount);
+    std::vector<HwDbgInfo_fileid> fileIds(addrCount);
+    HwDbgInfo_err err = hwdbginfo_addrs_to_lines(io_context.m_dbg, addrCount, &(io_context.m_addrs[0]), &(lineNums[0]), &(fileIds[0]));
+    io_context.m_failures += (HWDBGINFO_E_SUCCESS != err) ? 1 : 0;
+
+    return addrCount;
+}
+
+static size_t BenchNearestMappedLine(BenchmarkContext& io_context)
+{
+    size_t lineCount = io_context.m_queryLines.size();
+
+    for (size_t i = 0; i < lineCount; i++)
+    {
+        HwDbgInfo_code_location loc = nullptr;
+        HwDbgInfo_err err = hwdbginfo_nearest_mapped_line(io_context.m_dbg, io_context.m_queryLines[i], &loc);
+        io_context.m_failures += (HWDBGINFO_E_SUCCESS != err) ? 1 : 0;
+        hwdbginfo_release_code_locations(&loc, 1);
+    }
+
+    return lineCount;
+}
+
+static size_t BenchStepAddresses(BenchmarkContext& io_context, bool stepOut)
+{
+    size_t addrCount = io_context.m_addrs.size();
+    std::vector<HwDbgInfo_addr> stepAddrs;
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        // Query the size first, as the debugger does:
+        size_t stepAddrCount = 0;
+        HwDbgInfo_err err = hwdbginfo_step_addresses(io_context.m_dbg, io_context.m_addrs[i], stepOut, 0, nullptr, &stepAddrCount);
+
+        if ((HWDBGINFO_E_SUCCESS == err) && (0 < stepAddrCount))
+        {
+            stepAddrs.resize(stepAddrCount);
+            err = hwdbginfo_step_addresses(io_context.m_dbg, io_context.m_addrs[i], stepOut, stepAddrCount, &(stepAddrs[0]), nullptr);
+        }
+
+        // Stepping out of the kernel function has no targets:
+        io_context.m_failures += ((HWDBGINFO_E_SUCCESS != err) && (HWDBGINFO_E_NOTFOUND != err)) ? 1 : 0;
+    }
+
+    return addrCount;
+}
+
+static size_t BenchStepOverAddresses(BenchmarkContext& io_context)
+{
+    return BenchStepAddresses(io_context, false);
+}
+
+static size_t BenchStepOutAddresses(BenchmarkContext& io_context)
+{
+    return BenchStepAddresses(io_context, true);
+}
+
+static size_t BenchAddrCallStack(BenchmarkContext& io_context)
+{
+    size_t addrCount = io_context.m_addrs.size();
+    std::vector<HwDbgInfo_frame_context> frames;
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        size_t frameCount = 0;
+        HwDbgInfo_err err = hwdbginfo_addr_call_stack(io_context.m_dbg, io_context.m_addrs[i], 0, nullptr, &frameCount);
+
+        if ((HWDBGINFO_E_SUCCESS == err) && (0 < frameCount))
+        {
+            frames.resize(frameCount);
+            err = hwdbginfo_addr_call_stack(io_context.m_dbg, io_context.m_addrs[i], frameCount, &(frames[0]), &frameCount);
+
+            if (HWDBGINFO_E_SUCCESS == err)
+            {
+                hwdbginfo_release_frame_contexts(&(frames[0]), frameCount);
+            }
+        }
+
+        io_context.m_failures += (HWDBGINFO_E_SUCCESS != err) ? 1 : 0;
+    }
+
+    return addrCount;
+}
+
+static size_t BenchVariable(BenchmarkContext& io_context)
+{
+    size_t addrCount = io_context.m_addrs.size();
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+        HwDbgInfo_variable var = hwdbginfo_variable(io_context.m_dbg, io_context.m_addrs[i], true, io_context.m_varNames[i].c_str(), &err);
+
+        // Addresses in inlined code do not see the kernel's variables from their own scope:
+        io_context.m_failures += ((nullptr == var) && (HWDBGINFO_E_NOTFOUND != err)) ? 1 : 0;
+
+        if (nullptr != var)
+        {
+            hwdbginfo_release_variables(io_context.m_dbg, &var, 1);
+        }
+    }
+
+    return addrCount;
+}
+
+static size_t BenchFrameVariables(BenchmarkContext& io_context)
+{
+    size_t addrCount = io_context.m_addrs.size();
+    std::vector<HwDbgInfo_variable> vars;
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        size_t varCount = 0;
+        HwDbgInfo_err err = hwdbginfo_frame_variables(io_context.m_dbg, io_context.m_addrs[i], -1, false, 0, nullptr, &varCount);
+
+        if ((HWDBGINFO_E_SUCCESS == err) && (0 < varCount))
+        {
+            vars.resize(varCount);
+            err = hwdbginfo_frame_variables(io_context.m_dbg, io_context.m_addrs[i], -1, false, varCount, &(vars[0]), nullptr);
+
+            if (HWDBGINFO_E_SUCCESS == err)
+            {
+                hwdbginfo_release_variables(io_context.m_dbg, &(vars[0]), varCount);
+            }
+        }
+
+        io_context.m_failures += ((HWDBGINFO_E_SUCCESS != err) && (HWDBGINFO_E_NOTFOUND != err)) ? 1 : 0;
+    }
+
+    return addrCount;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// DescribeAddress
+/// \brief Description: Runs the queries a debugger makes for a stopped wave - line, call stack,
+///                     frame variables and step targets - and describes all the answers as text
+/// \param[in]          dbg - the debug info
+/// \param[in]          addr - the address
+/// \param[out]         o_description - the answers
+/// -----------------------------------------------------------------------------------------------
+static void DescribeAddress(HwDbgInfo_debug dbg, HwDbgInfo_addr addr, std::string& o_description)
+{
+    std::ostringstream desc;
+    char nameBuf[1024] = "";
+
+    // Line, through the interned file name:
+    HwDbgInfo_code_location loc = nullptr;
+    HwDbgInfo_err err = hwdbginfo_addr_to_line(dbg, addr, &loc);
+    desc << "line " << err;
+
+    if (HWDBGINFO_E_SUCCESS == err)
+    {
+        HwDbgInfo_linenum lineNum = 0;
+        HwDbgInfo_fileid fileId = HWDBGINFO_FILEID_NONE;
+        const char* pFileName = nullptr;
+        hwdbginfo_code_location_file(dbg, loc, &lineNum, &fileId);
+        hwdbginfo_file_name(dbg, fileId, &pFileName);
+        desc << " " << ((nullptr != pFileName) ? pFileName : "") << ":" << lineNum;
+    }
+
+    hwdbginfo_release_code_locations(&loc, 1);
+
+    // Call stack:
+    size_t frameCount = 0;
+    err = hwdbginfo_addr_call_stack(dbg, addr, 0, nullptr, &frameCount);
+    desc << "; stack " << err;
+
+    if ((HWDBGINFO_E_SUCCESS == err) && (0 < frameCount))
+    {
+        std::vector<HwDbgInfo_frame_context> frames(frameCount);
+        err = hwdbginfo_addr_call_stack(dbg, addr, frameCount, &(frames[0]), &frameCount);
+
+        for (size_t i = 0; (HWDBGINFO_E_SUCCESS == err) && (i < frameCount); i++)
+        {
+            HwDbgInfo_addr pc = 0;
+            HwDbgInfo_code_location frameLoc = nullptr;
+            size_t nameLen = 0;
+            hwdbginfo_frame_context_details(frames[i], &pc, nullptr, nullptr, &frameLoc, sizeof(nameBuf), nameBuf, &nameLen);
+            desc << " " << nameBuf << "@" << pc;
+            hwdbginfo_release_code_locations(&frameLoc, 1);
+        }
+
+        if (HWDBGINFO_E_SUCCESS == err)
+        {
+            hwdbginfo_release_frame_contexts(&(frames[0]), frameCount);
+        }
+    }
+
+    // Frame variables:
+    size_t varCount = 0;
+    err = hwdbginfo_frame_variables(dbg, addr, -1, false, 0, nullptr, &varCount);
+    desc << "; vars " << err;
+
+    if ((HWDBGINFO_E_SUCCESS == err) && (0 < varCount))
+    {
+        std::vector<HwDbgInfo_variable> vars(varCount);
+        err = hwdbginfo_frame_variables(dbg, addr, -1, false, varCount, &(vars[0]), nullptr);
+
+        for (size_t i = 0; (HWDBGINFO_E_SUCCESS == err) && (i < varCount); i++)
+        {
+            size_t varSize = 0;
+            hwdbginfo_variable_data(vars[i], sizeof(nameBuf), nameBuf, nullptr, 0, nullptr, nullptr, &varSize, nullptr, nullptr, nullptr);
+            desc << " " << nameBuf << "/" << varSize;
+        }
+
+        if (HWDBGINFO_E_SUCCESS == err)
+        {
+            hwdbginfo_release_variables(dbg, &(vars[0]), varCount);
+        }
+    }
+
+    // Step over targets:
+    size_t stepAddrCount = 0;
+    err = hwdbginfo_step_addresses(dbg, addr, false, 0, nullptr, &stepAddrCount);
+    desc << "; step " << err << " " << stepAddrCount;
+
+    o_description = desc.str();
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// StressThread
+/// \brief Description: Describes all the mapped addresses, starting from a different one in each
+///                     thread, and counts the descriptions that differ from the single-threaded ones
+/// \param[in]          pContext - the benchmark inputs, not modified
+/// \param[in]          firstAddrIndex - the address to start from
+/// \param[out]         pMismatches - the count of differing descriptions
+/// -----------------------------------------------------------------------------------------------
+static void StressThread(const BenchmarkContext* pContext, size_t firstAddrIndex, size_t* pMismatches)
+{
+    size_t addrCount = pContext->m_addrs.size();
+    std::string description;
+    *pMismatches = 0;
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        size_t addrIndex = (firstAddrIndex + i) % addrCount;
+        DescribeAddress(pContext->m_dbg, pContext->m_addrs[addrIndex], description);
+        *pMismatches += (pContext->m_descriptions[addrIndex] != description) ? 1 : 0;
+    }
+}
+
+static size_t BenchDescribeAddress(BenchmarkContext& io_context)
+{
+    size_t addrCount = io_context.m_addrs.size();
+    std::string description;
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        DescribeAddress(io_context.m_dbg, io_context.m_addrs[i], description);
+        io_context.m_failures += (io_context.m_descriptions[i] != description) ? 1 : 0;
+    }
+
+    return addrCount;
+}
+
+static size_t BenchConcurrentDescribeAddress(BenchmarkContext& io_context)
+{
+    unsigned int threadCount = io_context.m_pConfig->m_threadCount;
+    size_t addrCount = io_context.m_addrs.size();
+    std::vector<std::thread> threads;
+    std::vector<size_t> mismatches(threadCount, 0);
+
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread(StressThread, &io_context, (addrCount * i) / threadCount, &(mismatches[i])));
+    }
+
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        threads[i].join();
+        io_context.m_failures += mismatches[i];
+    }
+
+    return addrCount * threadCount;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// RunBenchmark
+/// \brief Description: Times the runs of a benchmark
+/// \param[in]          name - the benchmark name
+/// \param[in]          pfnBenchmark - the benchmark
+/// \param[in,out]      io_context - the benchmark inputs
+/// \param[out]         o_results - the result is appended here
+/// -----------------------------------------------------------------------------------------------
+static void RunBenchmark(const char* name, BenchmarkFunc pfnBenchmark, BenchmarkContext& io_context, std::vector<BenchmarkResult>& o_results)
+{
+    BenchmarkResult result;
+    result.m_name = name;
+    result.m_ops = 0;
+    result.m_firstNs = 0;
+    result.m_minNs = 0;
+    result.m_meanNs = 0;
+    io_context.m_failures = 0;
+
+    unsigned int iterations = (0 < io_context.m_pConfig->m_iterations) ? io_context.m_pConfig->m_iterations : 1;
+    double totalNs = 0;
+
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        result.m_ops = pfnBenchmark(io_context);
+        std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+        double runNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+
+        if (0 == i)
+        {
+            result.m_firstNs = runNs;
+            result.m_minNs = runNs;
+        }
+        else if (runNs < result.m_minNs)
+        {
+            result.m_minNs = runNs;
+        }
+
+        totalNs += runNs;
+    }
+
+    result.m_meanNs = totalNs / iterations;
+    result.m_failures = io_context.m_failures;
+    o_results.push_back(result);
+
+    fprintf(stderr, "%-24s %10.0f ns/op\n", name, (0 < result.m_ops) ? (result.m_minNs / result.m_ops) : result.m_minNs);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// RunStressTest
+/// \brief Description: Freezes a fresh debug info, describes every mapped address from one thread,
+///                     then from m_threadCount threads at once. Differing answers are counted as
+///                     failures of the concurrent benchmark.
+/// \param[in,out]      io_context - the benchmark inputs
+/// \param[out]         o_results - the results are appended here
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+static bool RunStressTest(BenchmarkContext& io_context, std::vector<BenchmarkResult>& o_results)
+{
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    hwdbginfo_release_debug_info(&io_context.m_dbg);
+    io_context.m_dbg = hwdbginfo_init_with_single_level_binary(&(io_context.m_binary[0]), io_context.m_binary.size(), &err);
+
+    if ((nullptr == io_context.m_dbg) || (HWDBGINFO_E_SUCCESS != hwdbginfo_freeze(io_context.m_dbg)))
+    {
+        fprintf(stderr, "Cannot freeze the synthetic kernel's debug information (error %u)\n", err);
+        return false;
+    }
+
+    size_t addrCount = io_context.m_addrs.size();
+    io_context.m_descriptions.resize(addrCount);
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        DescribeAddress(io_context.m_dbg, io_context.m_addrs[i], io_context.m_descriptions[i]);
+    }
+
+    RunBenchmark("describe_address", BenchDescribeAddress, io_context, o_results);
+    RunBenchmark("concurrent_describe_address", BenchConcurrentDescribeAddress, io_context, o_results);
+
+    return (0 == o_results.back().m_failures);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// PrepareQueries
+/// \brief Description: Lists the mapped addresses and prepares the per-address query inputs
+/// \param[in,out]      io_context - the context, whose m_dbg is set
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+static bool PrepareQueries(BenchmarkContext& io_context)
+{
+    size_t addrCount = 0;
+    HwDbgInfo_err err = hwdbginfo_all_mapped_addrs(io_context.m_dbg, 0, nullptr, &addrCount);
+
+    if ((HWDBGINFO_E_SUCCESS != err) || (0 == addrCount))
+    {
+        return false;
+    }
+
+    io_context.m_addrs.resize(addrCount);
+    err = hwdbginfo_all_mapped_addrs(io_context.m_dbg, addrCount, &(io_context.m_addrs[0]), &addrCount);
+
+    if (HWDBGINFO_E_SUCCESS != err)
+    {
+        return false;
+    }
+
+    unsigned int varCount = (0 < io_context.m_pConfig->m_varCount) ? io_context.m_pConfig->m_varCount : 1;
+
+    for (size_t i = 0; i < addrCount; i++)
+    {
+        std::ostringstream varName;
+        varName << "var_" << (i % varCount);
+        io_context.m_varNames.push_back(varName.str());
+
+        // Query the line after each address's line, which is not always mapped:
+        HwDbgInfo_code_location loc = nullptr;
+        err = hwdbginfo_addr_to_line(io_context.m_dbg, io_context.m_addrs[i], &loc);
+
+        if (HWDBGINFO_E_SUCCESS == err)
+        {
+            HwDbgInfo_linenum lineNum = 0;
+            char fileName[1024] = "";
+            hwdbginfo_code_location_details(loc, &lineNum, sizeof(fileName), fileName, nullptr);
+            io_context.m_queryLines.push_back(hwdbginfo_make_code_location(fileName, lineNum + 1));
+        }
+
+        hwdbginfo_release_code_locations(&loc, 1);
+    }
+
+    size_t indexSize = 0;
+    err = hwdbginfo_serialize_index(io_context.m_dbg, 0, nullptr, &indexSize);
+
+    if ((HWDBGINFO_E_SUCCESS == err) && (0 < indexSize))
+    {
+        io_context.m_index.resize(indexSize);
+        err = hwdbginfo_serialize_index(io_context.m_dbg, indexSize, &(io_context.m_index[0]), &indexSize);
+    }
+
+    return (HWDBGINFO_E_SUCCESS == err) && !io_context.m_queryLines.empty();
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteResults
+/// \brief Description: Writes the configuration and the results as JSON
+/// \param[in]          context - the benchmark inputs
+/// \param[in]          results - the results
+/// -----------------------------------------------------------------------------------------------
+static void WriteResults(const BenchmarkContext& context, const std::vector<BenchmarkResult>& results)
+{
+    const BenchmarkConfig& config = *context.m_pConfig;
+
+    printf("{\n");
+    printf("  \"benchmark\": \"HwDbgFacilities\",\n");
+    printf("  \"config\": { \"cus\": %u, \"lines\": %u, \"inline_depth\": %u, \"vars\": %u, \"iterations\": %u, \"threads\": %u },\n",
+           config.m_cuCount, config.m_lineCount, config.m_inlineDepth, config.m_varCount, config.m_iterations, config.m_threadCount);
+    printf("  \"binary_size\": %zu,\n", context.m_binary.size());
+    printf("  \"index_size\": %zu,\n", context.m_index.size());
+    printf("  \"mapped_addresses\": %zu,\n", context.m_addrs.size());
+    printf("  \"results\": [\n");
+
+    size_t resultCount = results.size();
+
+    for (size_t i = 0; i < resultCount; i++)
+    {
+        const BenchmarkResult& result = results[i];
+        double nsPerOp = (0 < result.m_ops) ? (result.m_minNs / result.m_ops) : result.m_minNs;
+        printf("    { \"name\": \"%s\", \"ops\": %zu, \"failures\": %zu, \"first_ns\": %.0f, \"min_ns\": %.0f, \"mean_ns\": %.0f, \"ns_per_op\": %.1f }%s\n",
+               result.m_name.c_str(), result.m_ops, result.m_failures, result.m_firstNs, result.m_minNs, result.m_meanNs, nsPerOp,
+               (i + 1 < resultCount) ? "," : "");
+    }
+
+    printf("  ]\n");
+    printf("}\n");
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ParseArguments
+/// \brief Description: Reads the command line options into the configuration
+/// \param[in]          argc - argument count
+/// \param[in]          argv - arguments
+/// \param[out]         o_config - the configuration
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+static bool ParseArguments(int argc, char** argv, BenchmarkConfig& o_config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* pArg = argv[i];
+        const char* pValue = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        unsigned int* pNumber = nullptr;
+
+        if (0 == strcmp(pArg, "--cus"))
+        {
+            pNumber = &o_config.m_cuCount;
+        }
+        else if (0 == strcmp(pArg, "--lines"))
+        {
+            pNumber = &o_config.m_lineCount;
+        }
+        else if (0 == strcmp(pArg, "--inline-depth"))
+        {
+            pNumber = &o_config.m_inlineDepth;
+        }
+        else if (0 == strcmp(pArg, "--vars"))
+        {
+            pNumber = &o_config.m_varCount;
+        }
+        else if (0 == strcmp(pArg, "--iterations"))
+        {
+            pNumber = &o_config.m_iterations;
+        }
+        else if (0 == strcmp(pArg, "--threads"))
+        {
+            pNumber = &o_config.m_threadCount;
+        }
+        else if ((0 == strcmp(pArg, "--cc")) && (nullptr != pValue))
+        {
+            o_config.m_compiler = pValue;
+            i++;
+            continue;
+        }
+        else if (0 == strcmp(pArg, "--keep"))
+        {
+            o_config.m_keepFiles = true;
+            continue;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (nullptr == pValue)
+        {
+            return false;
+        }
+
+        *pNumber = (unsigned int)strtoul(pValue, nullptr, 10);
+        i++;
+    }
+
+    return (0 < o_config.m_cuCount) && (0 < o_config.m_lineCount);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkConfig config;
+
+    if (!ParseArguments(argc, argv, config))
+    {
+        fprintf(stderr, "Usage: %s [--cus N] [--lines N] [--inline-depth N] [--vars N] [--iterations N] [--threads N] [--cc compiler] [--keep]\n", argv[0]);
+        return 2;
+    }
+
+    BenchmarkContext context;
+    context.m_pConfig = &config;
+
+    if (!BuildSyntheticKernel(config, context.m_binary))
+    {
+        return 1;
+    }
+
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    context.m_dbg = hwdbginfo_init_with_single_level_binary(&(context.m_binary[0]), context.m_binary.size(), &err);
+
+    if ((nullptr == context.m_dbg) || !PrepareQueries(context))
+    {
+        fprintf(stderr, "Cannot read the synthetic kernel's debug information (error %u)\n", err);
+        hwdbginfo_release_debug_info(&context.m_dbg);
+        return 1;
+    }
+
+    // The query benchmarks use a freshly parsed object, so their first run includes reading the variables:
+    hwdbginfo_release_debug_info(&context.m_dbg);
+    context.m_dbg = hwdbginfo_init_with_single_level_binary(&(context.m_binary[0]), context.m_binary.size(), &err);
+
+    std::vector<BenchmarkResult> results;
+    RunBenchmark("init_single_level", BenchInitSingleLevel, context, results);
+    RunBenchmark("init_with_index", BenchInitWithIndex, context, results);
+    RunBenchmark("addr_to_line", BenchAddrToLine, context, results);
+    RunBenchmark("addrs_to_lines", BenchAddrsToLines, context, results);
+    RunBenchmark("nearest_mapped_line", BenchNearestMappedLine, context, results);
+    RunBenchmark("step_addresses_over", BenchStepOverAddresses, context, results);
+    RunBenchmark("step_addresses_out", BenchStepOutAddresses, context, results);
+    RunBenchmark("addr_call_stack", BenchAddrCallStack, context, results);
+    RunBenchmark("variable", BenchVariable, context, results);
+    RunBenchmark("frame_variables", BenchFrameVariables, context, results);
+    RunBenchmark("serialize_index", BenchSerializeIndex, context, results);
+
+    bool isStressTestPassed = (0 == config.m_threadCount) || RunStressTest(context, results);
+
+    WriteResults(context, results);
+
+    hwdbginfo_release_code_locations(&(context.m_queryLines[0]), context.m_queryLines.size());
+    hwdbginfo_release_debug_info(&context.m_dbg);
+
+    return isStressTestPassed ? 0 : 1;
+}
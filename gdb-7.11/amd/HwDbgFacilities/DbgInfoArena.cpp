@@ -0,0 +1,116 @@
+//==============================================================================
+// Copyright (c) 2016-2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief Description: Block allocator for the debug information object graphs
+//==============================================================================
+#include "DbgInfoArena.h"
+
+using namespace HwDbg;
+
+/// -----------------------------------------------------------------------------------------------
+/// DbgInfoArena
+/// \brief Description: Constructor, no block is allocated until the first allocation
+/// -----------------------------------------------------------------------------------------------
+DbgInfoArena::DbgInfoArena()
+    : m_pCurrentBlockFree(nullptr), m_currentBlockRemaining(0), m_allocatedSize(0)
+{
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ~DbgInfoArena
+/// \brief Description: Destructor
+/// -----------------------------------------------------------------------------------------------
+DbgInfoArena::~DbgInfoArena()
+{
+    Release();
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Allocate
+/// \brief Description: Carves a buffer out of the current block, starting a new block when it is
+///                     full. Buffers larger than a quarter block get a block of their own, so the
+///                     current block is not wasted.
+/// \param[in]          size - the buffer size
+/// \return The buffer, aligned for any fundamental type, or nullptr if no memory is available
+/// -----------------------------------------------------------------------------------------------
+void* DbgInfoArena::Allocate(size_t size)
+{
+    void* pRetVal = nullptr;
+
+    // Blocks are allocated with new[], which aligns them for any fundamental type. Rounding each
+    // size keeps the buffers inside the blocks aligned as well:
+    static const size_t alignment = alignof(std::max_align_t);
+    size_t alignedSize = (0 < size) ? ((size + alignment - 1) & ~(alignment - 1)) : alignment;
+
+    if (alignedSize > m_currentBlockRemaining)
+    {
+        bool isLargeBuffer = (alignedSize > (DBGINFO_ARENA_BLOCK_SIZE / 4));
+        size_t blockSize = isLargeBuffer ? alignedSize : DBGINFO_ARENA_BLOCK_SIZE;
+        unsigned char* pBlock = new(std::nothrow) unsigned char[blockSize];
+
+        if (nullptr != pBlock)
+        {
+            m_blocks.push_back(pBlock);
+            m_allocatedSize += alignedSize;
+            pRetVal = (void*)pBlock;
+
+            // A large buffer fills its block, the current block stays as it is:
+            if (!isLargeBuffer)
+            {
+                m_pCurrentBlockFree = pBlock + alignedSize;
+                m_currentBlockRemaining = blockSize - alignedSize;
+            }
+        }
+    }
+    else
+    {
+        pRetVal = (void*)m_pCurrentBlockFree;
+        m_pCurrentBlockFree += alignedSize;
+        m_currentBlockRemaining -= alignedSize;
+        m_allocatedSize += alignedSize;
+    }
+
+    return pRetVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Adopt
+/// \brief Description: Takes over the blocks of another arena, so objects allocated there live as
+///                     long as this arena. The free space in the other arena's current block is
+///                     not reused.
+/// \param[in,out]      other - the arena to empty
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoArena::Adopt(DbgInfoArena& other)
+{
+    if (this != &other)
+    {
+        m_blocks.insert(m_blocks.end(), other.m_blocks.begin(), other.m_blocks.end());
+        m_allocatedSize += other.m_allocatedSize;
+
+        other.m_blocks.clear();
+        other.m_pCurrentBlockFree = nullptr;
+        other.m_currentBlockRemaining = 0;
+        other.m_allocatedSize = 0;
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Release
+/// \brief Description: Frees all the blocks. Objects in the arena must already be destroyed.
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoArena::Release()
+{
+    size_t numberOfBlocks = m_blocks.size();
+
+    for (size_t i = 0; i < numberOfBlocks; i++)
+    {
+        delete[] m_blocks[i];
+    }
+
+    m_blocks.clear();
+    m_pCurrentBlockFree = nullptr;
+    m_currentBlockRemaining = 0;
+    m_allocatedSize = 0;
+}
@@ -0,0 +1,78 @@
+//==============================================================================
+// Copyright (c) 2016-2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief Description: Block allocator for the debug information object graphs
+//==============================================================================
+#ifndef DBGINFOARENA_H_
+#define DBGINFOARENA_H_
+
+// STL:
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Local:
+#include "DbgInfoDefinitions.h"
+
+/// The size of the blocks the arena carves its allocations from:
+#define DBGINFO_ARENA_BLOCK_SIZE (64 * 1024)
+
+namespace HwDbg
+{
+/// -----------------------------------------------------------------------------------------------
+/// \class DbgInfoArena
+/// \brief Description: Allocates objects from large blocks and frees all the blocks together.
+/// The arena does not run destructors, the objects must be destroyed (see \a Destroy) before the
+/// arena releases their memory. An arena is not thread safe; threads should fill their own arenas
+/// and hand the blocks over with \a Adopt.
+/// -----------------------------------------------------------------------------------------------
+class DBGINF_API DbgInfoArena
+{
+public:
+    /// Constructor
+    DbgInfoArena();
+    /// Destructor - frees all the blocks
+    ~DbgInfoArena();
+
+    /// Allocates a buffer aligned for any fundamental type, nullptr if no memory is available
+    void* Allocate(size_t size);
+    /// Takes over all the blocks of another arena, which is left empty
+    void Adopt(DbgInfoArena& other);
+    /// Frees all the blocks
+    void Release();
+    /// The number of bytes requested from the blocks
+    size_t GetAllocatedSize() const { return m_allocatedSize; };
+
+    /// Default constructs an object in the arena
+    template<typename T> T* New()
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types cannot be allocated in the arena");
+        void* pBuffer = Allocate(sizeof(T));
+        return (nullptr != pBuffer) ? new(pBuffer) T : nullptr;
+    };
+
+    /// Destroys an object allocated with \a New, its memory is freed with the arena
+    template<typename T> static void Destroy(T* pObject)
+    {
+        if (nullptr != pObject)
+        {
+            pObject->~T();
+        }
+    };
+
+private:
+    /// Disallow copying
+    DbgInfoArena(const DbgInfoArena& other);
+    /// Disallow copying
+    DbgInfoArena& operator=(const DbgInfoArena& other);
+
+    std::vector<unsigned char*> m_blocks;   ///< All the blocks owned by the arena
+    unsigned char* m_pCurrentBlockFree;     ///< The first free byte in the current block
+    size_t m_currentBlockRemaining;         ///< The free bytes left in the current block
+    size_t m_allocatedSize;                 ///< The number of bytes requested from the blocks
+};
+}
+
+#endif // DBGINFOARENA_H_
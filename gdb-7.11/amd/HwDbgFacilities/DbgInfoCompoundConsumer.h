@@ -11,6 +11,7 @@
 #include "DbgInfoIConsumer.h"
 
 // STL:
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -117,10 +118,18 @@ public:
     virtual bool ListVariablesFromAddress(const LAddrType& addr, int stackFrameDepth, bool finalMembers, std::vector<std::string>& o_variableNames) const;
     /// Returns the high level stack depth.
     virtual int GetAddressStackDepth(const LAddrType& lAddr) const;
+    /// Freezes both consumers
+    virtual void Freeze();
+    /// Returns true if both consumers are frozen
+    virtual bool IsFrozen() const { return m_pHConsumer->IsFrozen() && m_pLConsumer->IsFrozen(); };
 
 private:
     /// Recursively fills a low level variable from a high level variable
     void CopyHighToLowVariable(const LAddrType& lAddr, const HighLvlVariableInfo& hVar, LowLvlVariableInfo& o_lVar) const;
+    /// Composes the high level line to low level address tables from the two consumers
+    void BuildComposedLineTables();
+    /// Finds a high level line in the composed line table, returns false if it is not mapped in the high level
+    bool FindComposedLine(const HLineType& hLine, size_t& o_lineIndex) const;
 
 private:
     DbgInfoIConsumer<HAddrType, HLineType, HVarLocationType>* m_pHConsumer; ///< Pointer to High Level Consumer - set at constructor
@@ -130,6 +139,11 @@ private:
     LineResolver m_pLineResolver; ///< Function pointer, converts a low-level line (LLine) to high-level address (HAddr)
     void* m_pResolverUserData; ///< User data: used for resolver functions, can contain whatever metadata the user needs, in DWARF case, contains a pointer to the brig variable containing the low level variable name
     bool m_firstMappedLLAddr; ///< True if we use only the first LL address for each HL address / LL line. False if we use all of them.
+    std::vector<HLineType> m_composedLines;             ///< All lines mapped in the high level, sorted
+    std::vector<unsigned int> m_composedLineOffsets;    ///< The low level addresses of m_composedLines[i] are m_composedAddrs[m_composedLineOffsets[i]] to m_composedAddrs[m_composedLineOffsets[i + 1] - 1]
+    std::vector<unsigned int> m_composedFirstAddrEnds;  ///< Per line in m_composedLines: the end of its low level addresses which come from its first high level address
+    std::vector<LAddrType> m_composedAddrs;             ///< The low level addresses of each line, in the order the two consumers resolve them
+    std::vector<LAddrType> m_composedMappedAddrs;       ///< All low level addresses of mapped high level addresses, as returned by GetMappedAddresses
 }; /// class DbgInfoIConsumer
 
 
@@ -144,6 +158,7 @@ private:
 /// \param[in]          pLineResolver
 /// \param[in]          userData - needed for the location resolver - serves as meta data to be passed in by the user in order to resolve the location type
 /// \param[in]          firstMappedLLAddr - should this consumer resolve HL addresses (= LL lines) to the first LL address or to all of them.
+/// \brief Note:        Both consumers must hold their line mappings, as the line to address tables are composed here.
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
 DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::DbgInfoCompoundConsumer(HighLvlConsumer* pHConsumer, LowLvlConsumer* pLConsumer, LocationResolver pLocationResolver, AddressResolver pAddrResolver, LineResolver pLineResolver, void* userData, bool firstMappedLLAddr)
@@ -152,6 +167,8 @@ DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarL
     // We must assume these pointers to be non-nullptr:
     HWDBG_ASSERT(nullptr != m_pHConsumer);
     HWDBG_ASSERT(nullptr != m_pLConsumer);
+
+    BuildComposedLineTables();
 }
 
 
@@ -206,28 +223,25 @@ template<typename HAddrType, typename HLineType, typename HVarLocationType, type
 bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::GetAddressesFromLine(const HLineType& hLine, std::vector<LAddrType>& o_lAddresses, bool append, bool firstAddr) const
 {
     bool retVal = false;
-    std::vector<HAddrType> hAddresses;
 
     if (!append)
     {
         o_lAddresses.clear();
     }
 
-    // Request high level addresses from the high level line
-    if (m_pHConsumer->GetAddressesFromLine(hLine, hAddresses, false, firstAddr))
-    {
-        // Iterate over all the high level addresses:
-        int numberOfHAddrs = (int)hAddresses.size();
+    bool hadAddresses = (0 < o_lAddresses.size());
 
-        for (int i = 0; i < numberOfHAddrs; i++)
-        {
-            // Resolve to low level line:
-            LLineType hAddrAsLLine = m_pAddrResolver(hAddresses[i], m_pResolverUserData);
+    // Use the composed table, of the nearest line that is mapped in the high level:
+    size_t lineIndex = 0;
 
-            // We specify the last parameter to be true because we wish to append the results:
-            // And fill the low level address vector:
-            retVal = m_pLConsumer->GetAddressesFromLine(hAddrAsLLine, o_lAddresses, true, m_firstMappedLLAddr) || retVal;
-        }
+    if (FindComposedLine(hLine, lineIndex))
+    {
+        unsigned int firstAddrIndex = m_composedLineOffsets[lineIndex];
+        unsigned int endAddrIndex = firstAddr ? m_composedFirstAddrEnds[lineIndex] : m_composedLineOffsets[lineIndex + 1];
+        o_lAddresses.insert(o_lAddresses.end(), m_composedAddrs.begin() + firstAddrIndex, m_composedAddrs.begin() + endAddrIndex);
+
+        // When resolving to all the low level addresses, the low level consumer succeeds if the (appended) output is not empty:
+        retVal = (firstAddrIndex < endAddrIndex) || (hadAddresses && !m_firstMappedLLAddr);
     }
 
     return retVal;
@@ -252,28 +266,12 @@ bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType,
     if (retVal)
     {
         // Check if this line is mapped to anything in the low level:
-        std::vector<HAddrType> tryAddresses;
-        retVal = m_pHConsumer->GetAddressesFromLine(tryHLine, tryAddresses, true);
+        size_t lineIndex = 0;
+        retVal = FindComposedLine(tryHLine, lineIndex) && (m_composedLineOffsets[lineIndex] < m_composedLineOffsets[lineIndex + 1]);
 
         if (retVal)
         {
-            retVal = false;
-            int numberOfHAddrs = (int)tryAddresses.size();
-
-            for (int i = 0; i < numberOfHAddrs; i++)
-            {
-                // Resolve each high level address to a low level line:
-                LLineType tryLLine = m_pAddrResolver(tryAddresses[i], m_pResolverUserData);
-                LLineType ignoredLine;
-
-                if (m_pLConsumer->GetNearestMappedLine(tryLLine, ignoredLine))
-                {
-                    // If this low level line exists, we've succeeded:
-                    o_nearestMappedHLine = tryHLine;
-                    retVal = true;
-                    break;
-                }
-            }
+            o_nearestMappedHLine = tryHLine;
         }
     }
 
@@ -302,35 +300,11 @@ bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType,
 template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
 bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::GetMappedAddresses(std::vector<LAddrType>& o_lAddresses) const
 {
-    bool retVal = false;
-    o_lAddresses.clear();
-
-    // Get the mapped addresses from
-    std::vector<HAddrType> hAddrs;
-    retVal = m_pHConsumer->GetMappedAddresses(hAddrs);
-
-    if (retVal)
-    {
-        int numberOfHAddrs = (int)hAddrs.size();
-
-        for (int i = 0; i < numberOfHAddrs; i++)
-        {
-            // Get the line number:
-            LLineType lLineOrig = m_pAddrResolver(hAddrs[i], m_pResolverUserData);
-            LLineType lLine;
-            bool rcLn = m_pLConsumer->GetNearestMappedLine(lLineOrig, lLine);
-
-            if (rcLn)
-            {
-                // Get its low level addresses:
-                std::vector<LAddrType> currentLAddrs;
-                retVal = m_pLConsumer->GetAddressesFromLine(lLine, o_lAddresses, true, m_firstMappedLLAddr) || retVal;
-            }
-        }
-    }
+    // The addresses were composed at construction:
+    o_lAddresses = m_composedMappedAddrs;
 
     // We consider a success if we got any address:
-    retVal = retVal && (0 < (int)o_lAddresses.size());
+    bool retVal = (0 < (int)o_lAddresses.size());
 
     return retVal;
 }
@@ -487,6 +461,143 @@ int DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, L
     return retVal;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Freeze
+/// \brief Description: Freezes the high and low level consumers. The compound consumer itself keeps
+///                     no state besides them, so afterwards its const queries may run concurrently.
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
+void DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::Freeze()
+{
+    m_pHConsumer->Freeze();
+    m_pLConsumer->Freeze();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+/// BuildComposedLineTables
+/// \brief Description: Resolves every high level line through the high level addresses mapped to it and the
+///                     low level lines they stand for, to the low level addresses, once. The lookups of
+///                     \a GetAddressesFromLine, \a GetNearestMappedLine and \a GetMappedAddresses then only
+///                     search these tables, instead of going through both consumers on each call.
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
+void DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::BuildComposedLineTables()
+{
+    m_composedLines.clear();
+    m_composedLineOffsets.clear();
+    m_composedFirstAddrEnds.clear();
+    m_composedAddrs.clear();
+    m_composedMappedAddrs.clear();
+
+    std::vector<HAddrType> hAddrs;
+
+    if (m_pHConsumer->GetMappedAddresses(hAddrs))
+    {
+        int numberOfHAddrs = (int)hAddrs.size();
+
+        // Collect the mapped high level lines:
+        std::vector<HLineType> hLines;
+        hLines.reserve(numberOfHAddrs);
+
+        for (int i = 0; i < numberOfHAddrs; i++)
+        {
+            HLineType hLine;
+
+            if (m_pHConsumer->GetLineFromAddress(hAddrs[i], hLine))
+            {
+                hLines.push_back(hLine);
+            }
+        }
+
+        std::sort(hLines.begin(), hLines.end());
+
+        // Compose the low level addresses of each line:
+        int numberOfHLines = (int)hLines.size();
+
+        for (int i = 0; i < numberOfHLines; i++)
+        {
+            const HLineType& hLine = hLines[i];
+
+            if (!m_composedLines.empty() && !(m_composedLines.back() < hLine))
+            {
+                // Already composed:
+                continue;
+            }
+
+            std::vector<HAddrType> lineHAddrs;
+            m_pHConsumer->GetAddressesFromLine(hLine, lineHAddrs, false, false);
+
+            m_composedLines.push_back(hLine);
+            m_composedLineOffsets.push_back((unsigned int)m_composedAddrs.size());
+            m_composedFirstAddrEnds.push_back((unsigned int)m_composedAddrs.size());
+            int numberOfLineHAddrs = (int)lineHAddrs.size();
+
+            for (int j = 0; j < numberOfLineHAddrs; j++)
+            {
+                // Resolve to low level line, and append its low level addresses:
+                LLineType hAddrAsLLine = m_pAddrResolver(lineHAddrs[j], m_pResolverUserData);
+                m_pLConsumer->GetAddressesFromLine(hAddrAsLLine, m_composedAddrs, true, m_firstMappedLLAddr);
+
+                if (0 == j)
+                {
+                    m_composedFirstAddrEnds.back() = (unsigned int)m_composedAddrs.size();
+                }
+            }
+        }
+
+        m_composedLineOffsets.push_back((unsigned int)m_composedAddrs.size());
+
+        // Compose the mapped low level addresses, in the order of the mapped high level addresses:
+        for (int i = 0; i < numberOfHAddrs; i++)
+        {
+            // Get the line number:
+            LLineType lLineOrig = m_pAddrResolver(hAddrs[i], m_pResolverUserData);
+            LLineType lLine;
+            bool rcLn = m_pLConsumer->GetNearestMappedLine(lLineOrig, lLine);
+
+            if (rcLn)
+            {
+                // Get its low level addresses:
+                m_pLConsumer->GetAddressesFromLine(lLine, m_composedMappedAddrs, true, m_firstMappedLLAddr);
+            }
+        }
+    }
+    else
+    {
+        m_composedLineOffsets.push_back(0);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+/// FindComposedLine
+/// \brief Description: Finds the nearest line mapped in the high level in the composed line table, the same
+///                     line the high level consumer would look up the addresses of
+/// \param[in]          hLine - High level line
+/// \param[out]         o_lineIndex - The index of the line in m_composedLines
+/// \return             True if the line (or a line near it) is mapped in the high level
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
+bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::FindComposedLine(const HLineType& hLine, size_t& o_lineIndex) const
+{
+    bool retVal = false;
+    HLineType mappedHLine;
+
+    if (!m_pHConsumer->GetNearestMappedLine(hLine, mappedHLine))
+    {
+        mappedHLine = hLine;
+    }
+
+    typename std::vector<HLineType>::const_iterator findIter = std::lower_bound(m_composedLines.begin(), m_composedLines.end(), mappedHLine);
+
+    if ((m_composedLines.end() != findIter) && !(mappedHLine < *findIter))
+    {
+        o_lineIndex = findIter - m_composedLines.begin();
+        retVal = true;
+    }
+
+    return retVal;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 /// CopyHighToLowVariable
 /// \brief Description: This function recursively fills a low level variable from a high level variable by:
@@ -78,6 +78,10 @@ public:
     virtual bool ListVariablesFromAddress(const AddrType& addr, int stackFrameDepth, bool finalMembers, std::vector<std::string>& o_variableNames) const;
     /// Gets the stack depth of an address
     virtual int GetAddressStackDepth(const AddrType& addr) const;
+    /// Loads the deferred variables and the line lookup tables, making the consumer safe for concurrent queries
+    virtual void Freeze();
+    /// Returns true if the consumer was frozen
+    virtual bool IsFrozen() const { return m_isFrozen; };
 
 private:
     void addLeafMemberNamesToVector(const ConsumedVariableInfo& rVarInfo, const std::string& namesBase, std::vector<std::string>& io_variableNames) const;
@@ -87,6 +91,8 @@ private:
     FullLineNumberMapping* m_pMapping;
     /// A pointer to a Code Scope
     HwDbg::CodeScope<AddrType, LineType, VarLocationType>* m_pTopCodeScope;
+    /// Was the consumer frozen
+    bool m_isFrozen;
 }; // class DbgInfoConsumerImpl
 
 /// ---------------------------------------------------------------------------
@@ -98,6 +104,7 @@ DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::DbgInfoConsumerImpl()
 {
     m_pMapping = nullptr;
     m_pTopCodeScope = nullptr;
+    m_isFrozen = false;
 }
 
 
@@ -573,7 +580,7 @@ bool DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::ListVariablesFrom
             {
                 // Get the variables vector:
                 const std::vector<ConsumedVariableInfo*>& currentScopeVariables =
-                                                                pCurrentScope->m_scopeVars;
+                                                                pCurrentScope->GetScopeVariables();
 
                 // We add the variables in three cases:
                 // 1. The parameter is -1, signifying the caller wants all the locals from all levels.
@@ -630,6 +637,29 @@ bool DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::ListVariablesFrom
     return retVal;
 }
 
+/// ---------------------------------------------------------------------------
+/// Freeze
+/// \brief Description: Loads the deferred variables of all the scopes and builds the line lookup
+///                     tables, which the queries would otherwise do on first use. After this the
+///                     const queries only read the consumer's data, so one consumer can be queried
+///                     from several threads. The data must not be modified afterwards.
+/// ---------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::Freeze()
+{
+    if (nullptr != m_pMapping)
+    {
+        m_pMapping->Freeze();
+    }
+
+    if (nullptr != m_pTopCodeScope)
+    {
+        m_pTopCodeScope->LoadDeferredVariables();
+    }
+
+    m_isFrozen = true;
+}
+
 } // namespace HwDbg
 
 #endif //DBGINFOCONSUMERIMPL_H_
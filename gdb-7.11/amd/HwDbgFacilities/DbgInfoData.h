@@ -30,13 +30,16 @@
 /// ----------------------------------------------------------------------
 
 // STL:
-#include <set>
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <string>
 #include <string.h> // ::memcpy()
 
 // Local:
+#include "DbgInfoArena.h"
 #include "DbgInfoDefinitions.h"
+#include "DbgInfoLines.h"
 #include "DbgInfoUtils.h"
 #include "DbgInfoLogging.h"
 #include "FacilitiesInterface.h"
@@ -119,6 +122,8 @@ public:
     typedef VariableInfo<AddrType, VarLocationType> FullVariableInfo;
     /// The matching function:
     typedef typename FullVariableInfo::VariableMatchingFunc VarMatchFunc;
+    /// Fills the variables of a scope whose variables were deferred, see \a SetVariablesLoader:
+    typedef void(*VariablesLoaderFunc)(FullCodeScope& io_scope, void* pLoaderData);
 
 public:
     /// The scope type - The top level is a compilation unit
@@ -162,6 +167,12 @@ public:
     virtual ~CodeScope();
     /// Find the innermost CodeScope which contains addr
     const FullCodeScope* FindSmallestScopeContainingAddress(const AddrType& addr) const;
+    /// Flatten the scope tree into an index of address intervals - needs to receive the topmost scope
+    void BuildAddressIndex();
+    /// Get the address index made by \a BuildAddressIndex, returns false if there is none
+    bool GetAddressIndex(std::vector<AddrType>& o_intervalStarts, std::vector<const FullCodeScope*>& o_intervalScopes) const;
+    /// Use a saved address index instead of building it - the scopes must be in this scope's tree
+    void SetAddressIndex(std::vector<AddrType>& io_intervalStarts, std::vector<const FullCodeScope*>& io_intervalScopes);
     /// Find the innermost scope containing an address and variable name, and return that variable
     const FullCodeScope* FindClosestScopeContainingVariable(AddrType startAddr, VarMatchFunc pfnMatch,
                                                             const void* pMatchData,
@@ -176,6 +187,18 @@ public:
     bool MapAddressesToCodeScopes(const std::vector<AddrType>& addresses);
     /// Makes sure that variable ranges do not overlap
     void IntersectVariablesInScope();
+    /// Get the variables defined in this scope, loading them first if they were deferred
+    const std::vector<FullVariableInfo*>& GetScopeVariables() const;
+    /// Defer filling m_scopeVars until the variables are first requested with \a GetScopeVariables
+    void SetVariablesLoader(VariablesLoaderFunc pfnLoader, void* pLoaderData);
+    /// Load the deferred variables of this scope and its descendants, after which reading the tree does not modify it
+    void LoadDeferredVariables() const;
+    /// Allocate a child scope from this scope's arena, the caller adds it to m_children
+    FullCodeScope* AllocateChildScope();
+    /// Allocate a variable from this scope's arena, the caller adds it to m_scopeVars
+    FullVariableInfo* AllocateVariable();
+    /// Set the arena of this scope and its descendants - the whole tree must move from the same arena
+    void SetArena(DbgInfoArena* pArena);
 
     /// Members:
     std::string m_scopeName;                           ///< The name of the scope (e.g. function name, class name, etc).
@@ -185,11 +208,13 @@ public:
     std::vector<AddressRange> m_scopeAddressRanges;    ///< Range of addresses for the scope - can be fragmented so we need more than one.
     bool m_scopeHasNonTrivialAddressRanges;         ///< true iff m_scopeAddressRanges is non-trivial
     InlineInformation m_inlineInfo;                 ///< Inline information - optional, only for inline functions.
-    std::set<AddrType> m_addressCache;              ///< Cache of addresses inside the scope, used for "step over" and "step out" operations
+    std::vector<AddrType> m_addressCache;           ///< Sorted cache of addresses inside the scope, used for "step over" and "step out" operations
     std::vector<FullCodeScope*> m_children;         ///< Child scopes.
-    std::vector<FullVariableInfo*> m_scopeVars;     ///< Variables defined in this scope
+    std::vector<FullVariableInfo*> m_scopeVars;     ///< Variables defined in this scope - use GetScopeVariables() to read them
+    std::vector<HwDbgUInt64> m_deferredVariableSources; ///< Where the loader finds the deferred variables (e.g. DWARF DIE offsets)
     bool m_isKernel;                                ///< is hsa kernel
     VarLocationType* m_pWorkitemOffset;             ///< work item offset value location
+    DbgInfoArena* m_pArena;                         ///< Holds the child scopes and variables, nullptr if they are on the heap
 
 private:
     /// Internal function which puts each address in the innermost CodeScope containing it - Recursive
@@ -199,6 +224,17 @@ private:
     bool GetAddressesInRange(const std::vector<AddrType>& addresses, std::vector<AddrType>& o_AddressesInRange) const;
     /// Check whether the specified address is in the code scope
     bool IsAddressInCodeScope(const AddrType& addr) const;
+    /// Find the innermost CodeScope which contains addr by walking the scope tree - Recursive
+    const FullCodeScope* InternalFindSmallestScopeContainingAddress(const AddrType& addr) const;
+    /// Add the addresses where this scope's or its children's ranges start or end - Recursive
+    void GetAddressRangeBoundaries(std::vector<AddrType>& io_boundaries) const;
+
+    bool m_isAddressIndexBuilt;                     ///< Does this scope have an address index
+    std::vector<AddrType> m_addressIndexStarts;     ///< Sorted start addresses of the index intervals, each one ends where the next one starts
+    std::vector<const FullCodeScope*> m_addressIndexScopes; ///< The innermost scope for each index interval, nullptr if no scope contains it
+
+    VariablesLoaderFunc m_pfnVariablesLoader;       ///< Loads the deferred variables, nullptr once they are loaded
+    void* m_pVariablesLoaderData;                   ///< User data for m_pfnVariablesLoader
     /// Private Copy constructor - Disallow copying
     CodeScope(const FullCodeScope& other);
     /// Private assignment operator- Disallow copying
@@ -339,33 +375,30 @@ template<typename AddrType, typename VarLocationType>
 bool VariableInfo<AddrType, VarLocationType>::CanMatchMemberName(const std::string& memberFullName,
                                                                  const FullVariableInfo*& o_pFoundMember) const
 {
-    // Tokenize the name:
+    // Tokenize the name on '.', skipping empty tokens. strtok is not used since it keeps its position
+    // in a global, which would corrupt concurrent lookups:
     bool retVal = false;
-    std::string varName = m_varName;
-
-    // Tokenize the string:
-    static const char* delimiters = ".";
+    static const char delimiter = '.';
     size_t strLen = memberFullName.length();
-    char* pTokBuffer = new char[strLen + 1];
-    ::memcpy(pTokBuffer, memberFullName.c_str(), strLen);
-    pTokBuffer[strLen] = (char)0;
+    size_t tokenStart = memberFullName.find_first_not_of(delimiter);
 
-    char* pCurrentTok = strtok(pTokBuffer, delimiters);
-
-    if (nullptr != pCurrentTok)
+    if (std::string::npos != tokenStart)
     {
-        std::string currentToken = pCurrentTok;;
+        size_t tokenEnd = memberFullName.find(delimiter, tokenStart);
+        tokenEnd = (std::string::npos != tokenEnd) ? tokenEnd : strLen;
 
         // The first token should be the variable name:
-        if (varName == currentToken)
+        if (0 == memberFullName.compare(tokenStart, tokenEnd - tokenStart, m_varName))
         {
             // The base variable was found, start looking in its member list:
             retVal = true;
             const VariableInfo<AddrType, VarLocationType>* pCurrentMemberDetails = this;
 
-            while (nullptr != (pCurrentTok = strtok(nullptr, delimiters)))
+            while (std::string::npos != (tokenStart = memberFullName.find_first_not_of(delimiter, tokenEnd)))
             {
-                currentToken = pCurrentTok;
+                tokenEnd = memberFullName.find(delimiter, tokenStart);
+                tokenEnd = (std::string::npos != tokenEnd) ? tokenEnd : strLen;
+                std::string currentToken = memberFullName.substr(tokenStart, tokenEnd - tokenStart);
 
                 // Check if this is a member of the current struct:
                 int numberOfSubitems = (int)pCurrentMemberDetails->m_varMembers.size();
@@ -404,8 +437,6 @@ bool VariableInfo<AddrType, VarLocationType>::CanMatchMemberName(const std::stri
         }
     }
 
-    delete[] pTokBuffer;
-
     return retVal;
 }
 
@@ -417,7 +448,7 @@ template<typename AddrType, typename LineType, typename VarLocationType>
 CodeScope<AddrType, LineType, VarLocationType>::CodeScope()
     : m_scopeType(DID_SCT_COMPILATION_UNIT), m_pFrameBase(nullptr), m_pParentScope(nullptr),
       m_scopeHasNonTrivialAddressRanges(false),
-      m_isKernel(false), m_pWorkitemOffset(nullptr)
+      m_isKernel(false), m_pWorkitemOffset(nullptr), m_pArena(nullptr), m_isAddressIndexBuilt(false), m_pfnVariablesLoader(nullptr), m_pVariablesLoaderData(nullptr)
 {
 };
 
@@ -434,12 +465,20 @@ CodeScope<AddrType, LineType, VarLocationType>::~CodeScope()
         m_pFrameBase = nullptr;
     }
 
-    // Delete the children:
+    // Delete the children. Arena objects are only destroyed, the arena owner frees their memory:
     size_t numberOfChildren = m_children.size();
 
     for (size_t i = 0; i < numberOfChildren; i++)
     {
-        delete m_children[i];
+        if (nullptr != m_pArena)
+        {
+            DbgInfoArena::Destroy(m_children[i]);
+        }
+        else
+        {
+            delete m_children[i];
+        }
+
         m_children[i] = nullptr;
     }
 
@@ -452,7 +491,15 @@ CodeScope<AddrType, LineType, VarLocationType>::~CodeScope()
     {
         if (m_scopeVars[i] != nullptr)
         {
-            delete m_scopeVars[i];
+            if (nullptr != m_pArena)
+            {
+                DbgInfoArena::Destroy(m_scopeVars[i]);
+            }
+            else
+            {
+                delete m_scopeVars[i];
+            }
+
             m_scopeVars[i] = nullptr;
         }
     }
@@ -463,6 +510,7 @@ CodeScope<AddrType, LineType, VarLocationType>::~CodeScope()
 /// -----------------------------------------------------------------------------------------------
 /// FindSmallestScopeContainingAddress
 /// \brief Description: Find the innermost child scope containing the address - we assume that sibling scopes do not intersect.
+/// Uses the address index if it was built, see \a BuildAddressIndex
 /// \param[in]          addr - the address to find
 /// \return A pointer to the codescope
 /// -----------------------------------------------------------------------------------------------
@@ -472,6 +520,37 @@ CodeScope<AddrType, LineType, VarLocationType>::FindSmallestScopeContainingAddre
     const AddrType& addr) const
 {
     const FullCodeScope* pRetVal = nullptr;
+
+    if (m_isAddressIndexBuilt)
+    {
+        // Find the last interval starting at or before the address:
+        typename std::vector<AddrType>::const_iterator findIter = std::upper_bound(m_addressIndexStarts.begin(), m_addressIndexStarts.end(), addr);
+
+        if (m_addressIndexStarts.begin() != findIter)
+        {
+            pRetVal = m_addressIndexScopes[(findIter - m_addressIndexStarts.begin()) - 1];
+        }
+    }
+    else
+    {
+        pRetVal = InternalFindSmallestScopeContainingAddress(addr);
+    }
+
+    return pRetVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// InternalFindSmallestScopeContainingAddress
+/// \brief Description: Internal version of the above function which walks the scope tree
+/// \param[in]          addr - the address to find
+/// \return A pointer to the codescope
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+const CodeScope<AddrType, LineType, VarLocationType>*
+CodeScope<AddrType, LineType, VarLocationType>::InternalFindSmallestScopeContainingAddress(
+    const AddrType& addr) const
+{
+    const FullCodeScope* pRetVal = nullptr;
     const FullCodeScope* pTmpVal = nullptr;
 
     if (IsAddressInCodeScope(addr))
@@ -492,7 +571,7 @@ CodeScope<AddrType, LineType, VarLocationType>::FindSmallestScopeContainingAddre
                 if (pCurrentScope->m_scopeHasNonTrivialAddressRanges)
                 {
                     // Recursive call - to find the 'deepest' child scope containing the address:
-                    pTmpVal = pCurrentScope->FindSmallestScopeContainingAddress(addr);
+                    pTmpVal = pCurrentScope->InternalFindSmallestScopeContainingAddress(addr);
 
                     if (nullptr != pTmpVal)
                     {
@@ -514,7 +593,7 @@ CodeScope<AddrType, LineType, VarLocationType>::FindSmallestScopeContainingAddre
                     if (!pCurrentScope->m_scopeHasNonTrivialAddressRanges)
                     {
                         // Recursive call - to find the 'deepest' child scope containing the address:
-                        pTmpVal = pCurrentScope->FindSmallestScopeContainingAddress(addr);
+                        pTmpVal = pCurrentScope->InternalFindSmallestScopeContainingAddress(addr);
 
                         if (nullptr != pTmpVal)
                         {
@@ -531,6 +610,116 @@ CodeScope<AddrType, LineType, VarLocationType>::FindSmallestScopeContainingAddre
     return pRetVal;
 }
 
+/// -----------------------------------------------------------------------------------------------
+/// BuildAddressIndex
+/// \brief Description: Splits the address space at every scope range boundary. The innermost scope
+/// is the same for all the addresses between two boundaries, so it is looked up once per interval
+/// and address queries become a binary search. Call once the scope tree is complete.
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::BuildAddressIndex()
+{
+    m_isAddressIndexBuilt = false;
+    m_addressIndexStarts.clear();
+    m_addressIndexScopes.clear();
+
+    std::vector<AddrType> boundaries;
+    GetAddressRangeBoundaries(boundaries);
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    int numberOfBoundaries = (int)boundaries.size();
+
+    for (int i = 0; i < numberOfBoundaries; i++)
+    {
+        const FullCodeScope* pIntervalScope = InternalFindSmallestScopeContainingAddress(boundaries[i]);
+
+        // Merge neighboring intervals which have the same scope:
+        if (m_addressIndexScopes.empty() || (m_addressIndexScopes.back() != pIntervalScope))
+        {
+            m_addressIndexStarts.push_back(boundaries[i]);
+            m_addressIndexScopes.push_back(pIntervalScope);
+        }
+    }
+
+    m_isAddressIndexBuilt = true;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// GetAddressIndex
+/// \brief Description: Copies out the address index, so it can be saved with the scope tree
+/// \param[out]         o_intervalStarts - the sorted start addresses of the index intervals
+/// \param[out]         o_intervalScopes - the innermost scope of each interval, nullptr if there is none
+/// \return True : the index was built
+/// \return False: Otherwise
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+bool CodeScope<AddrType, LineType, VarLocationType>::GetAddressIndex(std::vector<AddrType>& o_intervalStarts, std::vector<const FullCodeScope*>& o_intervalScopes) const
+{
+    o_intervalStarts = m_addressIndexStarts;
+    o_intervalScopes = m_addressIndexScopes;
+
+    return m_isAddressIndexBuilt;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// SetAddressIndex
+/// \brief Description: Takes over an address index saved with \a GetAddressIndex, instead of
+/// building it again. The input vectors are swapped with the index and left empty.
+/// \param[in,out]      io_intervalStarts - the sorted start addresses of the index intervals
+/// \param[in,out]      io_intervalScopes - the innermost scope of each interval, nullptr if there is none
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::SetAddressIndex(std::vector<AddrType>& io_intervalStarts, std::vector<const FullCodeScope*>& io_intervalScopes)
+{
+    HWDBG_ASSERT(io_intervalStarts.size() == io_intervalScopes.size());
+
+    m_addressIndexStarts.clear();
+    m_addressIndexScopes.clear();
+    m_addressIndexStarts.swap(io_intervalStarts);
+    m_addressIndexScopes.swap(io_intervalScopes);
+    m_isAddressIndexBuilt = true;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// GetAddressRangeBoundaries
+/// \brief Description: Adds the first address of each range and the address after its end, for this
+/// scope and all its children
+/// \param[in,out]      io_boundaries - the boundaries vector to add to
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::GetAddressRangeBoundaries(std::vector<AddrType>& io_boundaries) const
+{
+    int numberOfRanges = (int)m_scopeAddressRanges.size();
+
+    for (int i = 0; i < numberOfRanges; i++)
+    {
+        // The ranges include their upper limit, see IsAddressInCodeScope:
+        const AddressRange& currentRange = m_scopeAddressRanges[i];
+        io_boundaries.push_back(currentRange.m_minAddr);
+        AddrType afterMaxAddr = currentRange.m_maxAddr;
+        ++afterMaxAddr;
+
+        // The range may reach the end of the address space:
+        if (afterMaxAddr > currentRange.m_maxAddr)
+        {
+            io_boundaries.push_back(afterMaxAddr);
+        }
+    }
+
+    int numberOfChildren = (int)m_children.size();
+
+    for (int i = 0; i < numberOfChildren; i++)
+    {
+        const FullCodeScope* pCurrentChild = m_children[i];
+
+        if (nullptr != pCurrentChild)
+        {
+            pCurrentChild->GetAddressRangeBoundaries(io_boundaries);
+        }
+    }
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// GetStackDepth
 /// \brief Description: Return the stack depth of the chosen address
@@ -711,7 +900,8 @@ bool CodeScope<AddrType, LineType, VarLocationType>::MapAddressesToCodeScopes(co
                 FullCodeScope* pCodeScope = it->second;
                 HWDBG_ASSERT(pCodeScope->m_pParentScope == nullptr || pCodeScope->m_scopeType == FullCodeScope::DID_SCT_INLINED_FUNCTION
                              || pCodeScope->m_scopeType == FullCodeScope::DID_SCT_FUNCTION);
-                pCodeScope->m_addressCache.insert(addrType);
+                // The map is ordered, so each cache stays sorted:
+                pCodeScope->m_addressCache.push_back(addrType);
             }
         }
     }
@@ -816,13 +1006,14 @@ CodeScope<AddrType, LineType, VarLocationType>::FindClosestScopeContainingVariab
                     << std::dec << "\n");
 
         // See if this scope contains a variable named correctly:
-        int numberOfVars = (int)pCurrentScope->m_scopeVars.size();
+        const std::vector<FullVariableInfo*>& currentScopeVars = pCurrentScope->GetScopeVariables();
+        int numberOfVars = (int)currentScopeVars.size();
         bool foundVar = false;
 
         for (int i = 0; i < numberOfVars; ++i)
         {
             // Check if this variable is the correct one:
-            const FullVariableInfo* pCurrentVar = pCurrentScope->m_scopeVars[i];
+            const FullVariableInfo* pCurrentVar = currentScopeVars[i];
             HWDBG_ASSERT(pCurrentVar != nullptr);
 
             if (pCurrentVar != nullptr)
@@ -977,6 +1168,116 @@ void CodeScope<AddrType, LineType, VarLocationType>::IntersectVariablesInScope()
         }
     }
 }
+
+/// -----------------------------------------------------------------------------------------------
+/// GetScopeVariables
+/// \brief Description: Gets the variables defined in the scope. If they were deferred, the loader
+/// is called to fill them the first time they are requested.
+/// \return The variables vector
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+const std::vector<VariableInfo<AddrType, VarLocationType>*>& CodeScope<AddrType, LineType, VarLocationType>::GetScopeVariables() const
+{
+    if (nullptr != m_pfnVariablesLoader)
+    {
+        // Loading the variables does not change the scope as seen by its users, only when the work is done:
+        FullCodeScope* pThis = const_cast<FullCodeScope*>(this);
+        VariablesLoaderFunc pfnLoader = m_pfnVariablesLoader;
+        pThis->m_pfnVariablesLoader = nullptr;
+        pfnLoader(*pThis, m_pVariablesLoaderData);
+    }
+
+    return m_scopeVars;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// SetVariablesLoader
+/// \brief Description: Defers filling the scope variables until they are first requested. The
+/// loader data must remain valid until then.
+/// \param[in]          pfnLoader - the function filling m_scopeVars
+/// \param[in]          pLoaderData - user data passed to the loader
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::SetVariablesLoader(VariablesLoaderFunc pfnLoader, void* pLoaderData)
+{
+    m_pfnVariablesLoader = pfnLoader;
+    m_pVariablesLoaderData = pLoaderData;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// LoadDeferredVariables
+/// \brief Description: Loads the variables of this scope and of all its descendants whose variables
+/// were deferred. Scopes whose variables are already loaded are not changed.
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::LoadDeferredVariables() const
+{
+    GetScopeVariables();
+
+    int numberOfChildren = (int)m_children.size();
+
+    for (int i = 0; i < numberOfChildren; i++)
+    {
+        const FullCodeScope* pCurrentChild = m_children[i];
+
+        if (nullptr != pCurrentChild)
+        {
+            pCurrentChild->LoadDeferredVariables();
+        }
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// AllocateChildScope
+/// \brief Description: Allocates a scope from this scope's arena, or from the heap if it has none.
+/// The new scope uses the same arena for its own children and variables.
+/// \return The new scope, nullptr if no memory is available
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+CodeScope<AddrType, LineType, VarLocationType>* CodeScope<AddrType, LineType, VarLocationType>::AllocateChildScope()
+{
+    FullCodeScope* pRetVal = (nullptr != m_pArena) ? m_pArena->New<FullCodeScope>() : new(std::nothrow) FullCodeScope;
+
+    if (nullptr != pRetVal)
+    {
+        pRetVal->m_pArena = m_pArena;
+    }
+
+    return pRetVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// AllocateVariable
+/// \brief Description: Allocates a variable from this scope's arena, or from the heap if it has none.
+/// \return The new variable, nullptr if no memory is available
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+VariableInfo<AddrType, VarLocationType>* CodeScope<AddrType, LineType, VarLocationType>::AllocateVariable()
+{
+    return (nullptr != m_pArena) ? m_pArena->New<FullVariableInfo>() : new(std::nothrow) FullVariableInfo;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// SetArena
+/// \brief Description: Sets the arena of this scope and its descendants, e.g. after their blocks
+/// were adopted by another arena. Must not be used to move a tree between the heap and an arena.
+/// \param[in]          pArena - the arena now holding the tree
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::SetArena(DbgInfoArena* pArena)
+{
+    m_pArena = pArena;
+
+    size_t numberOfChildren = m_children.size();
+
+    for (size_t i = 0; i < numberOfChildren; i++)
+    {
+        if (nullptr != m_children[i])
+        {
+            m_children[i]->SetArena(pArena);
+        }
+    }
+}
 } // namespace HwDbg
 
 #endif //DBGINFODATA_H_
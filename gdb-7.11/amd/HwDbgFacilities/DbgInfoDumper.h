@@ -443,7 +443,7 @@ void DbgInfoDumper<AddrType, LineType, VarLocationType>::InternalPrintScope(cons
     string_prepend(frameBase, "{") += "}";
     std::string cachedAddresses = "CachedAddresses=[";
 
-    for (typename std::set<AddrType>::const_iterator it = scopeInfo.m_addressCache.begin(); it != scopeInfo.m_addressCache.end(); ++it)
+    for (typename std::vector<AddrType>::const_iterator it = scopeInfo.m_addressCache.begin(); it != scopeInfo.m_addressCache.end(); ++it)
     {
         std::string cachedAddr;
         m_addrTypeDumper(*it, cachedAddr);
@@ -480,11 +480,13 @@ void DbgInfoDumper<AddrType, LineType, VarLocationType>::InternalPrintScope(cons
          workitemOffset) += "\n";
 
     // Print each variable child:
-    if (scopeInfo.m_scopeVars.size() > 0)
+    const std::vector<VariableInfo<AddrType, VarLocationType>*>& scopeVars = scopeInfo.GetScopeVariables();
+
+    if (scopeVars.size() > 0)
     {
         (o_appendedOutputString += innerScopeIndent) += "Variables:\n";
 
-        for (typename std::vector<VariableInfo<AddrType, VarLocationType>*>::const_iterator scopeVarsIt = scopeInfo.m_scopeVars.begin(); scopeVarsIt != scopeInfo.m_scopeVars.end(); ++scopeVarsIt)
+        for (typename std::vector<VariableInfo<AddrType, VarLocationType>*>::const_iterator scopeVarsIt = scopeVars.begin(); scopeVarsIt != scopeVars.end(); ++scopeVarsIt)
         {
             PrintVariableInformation((**scopeVarsIt), innerScopeIndent, o_appendedOutputString);
         }
@@ -24,10 +24,15 @@
 #endif
 
 /// STL:
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <mutex>
 #include <queue>
 #include <stack>
 #include <string.h>
+#include <system_error>
+#include <thread>
 
 /// HSA:
 // #include <hsa_dwarf.h> // include this header when it is added to the HSA promoted libraries
@@ -97,6 +102,20 @@ enum Amd_HSA_address_class
 
 using namespace HwDbg;
 
+/// The most threads used to parse the compilation units of one binary:
+#define DWARF_PARSER_MAX_CU_WORKERS 4
+
+/// -----------------------------------------------------------------------------------------------
+/// InitializeElfVersion
+/// \brief Description: Sets the libelf version once, since binaries may be parsed concurrently
+/// \return void
+/// -----------------------------------------------------------------------------------------------
+static void InitializeElfVersion()
+{
+    static std::once_flag elfVersionFlag;
+    std::call_once(elfVersionFlag, elf_version, (unsigned int)EV_CURRENT);
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// Initialize
 /// \brief Description: Init function - as cannot have constructor in Union
@@ -293,6 +312,7 @@ bool DbgInfoDwarfParser::FillLineMappingFromDwarf(Dwarf_Die cuDIE,
 /// \param[in] programDIE - Input ptr
 /// \param[in] firstSourceFileRealPath
 /// \param[in] pDwarf - Allocation/Deallocation object ptr
+/// \param[in] pDeferredVariables - if not null, the variables are read when first requested
 /// \param[in] pParentScope - parent scope null for top level
 /// \param[in] scopeType - the type of scope Compilation unit for Top Level
 /// \param[out] o_scope - Out param scope to fill
@@ -301,6 +321,7 @@ bool DbgInfoDwarfParser::FillLineMappingFromDwarf(Dwarf_Die cuDIE,
 void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die           programDIE,
                                                 const std::string&        firstSourceFileRealPath,
                                                 Dwarf_Debug         pDwarf,
+                                                DwarfDeferredVariables* pDeferredVariables,
                                                 DwarfCodeScope*     pParentScope,
                                                 const DwarfCodeScopeType& scopeType,
                                                 DwarfCodeScope&     o_scope)
@@ -321,13 +342,13 @@ void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die           programDIE,
     FillFrameBase(programDIE, pDwarf, o_scope);
 
     // Iterate over children and fill the scope with them:
-    FillChildren(programDIE, firstSourceFileRealPath, pDwarf, o_scope);
+    FillChildren(programDIE, firstSourceFileRealPath, pDwarf, pDeferredVariables, o_scope);
 
     // Intersect the variables in this program:
     o_scope.IntersectVariablesInScope();
 
     // Fill from dwarf DIE reference
-    FillCodeScopeFromDwarfRef(programDIE, firstSourceFileRealPath, pDwarf, o_scope);
+    FillCodeScopeFromDwarfRef(programDIE, firstSourceFileRealPath, pDwarf, pDeferredVariables, o_scope);
 }
 
 /// ---------------------------------------------------------------------------
@@ -336,12 +357,14 @@ void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die           programDIE,
 /// \param[in] programDIE - Input ptr
 /// \param[in] firstSourceFileRealPath
 /// \param[in] pDwarf - Allocation/Deallocation object ptr
+/// \param[in] pDeferredVariables - if not null, the variables are read when first requested
 /// \param[out] o_scope - Out param scope to fill
 /// \return void
 /// ---------------------------------------------------------------------------
 void DbgInfoDwarfParser::FillCodeScopeFromDwarfRef(Dwarf_Die programDIE,
                                                    const std::string& firstSourceFileRealPath,
                                                    Dwarf_Debug pDwarf,
+                                                   DwarfDeferredVariables* pDeferredVariables,
                                                    DwarfCodeScope& o_scope)
 {
     Dwarf_Attribute functionAbstractOriginAsAttribute = nullptr;
@@ -356,8 +379,8 @@ void DbgInfoDwarfParser::FillCodeScopeFromDwarfRef(Dwarf_Die programDIE,
 
         if ((rc == DW_DLV_OK) && (functionAbstractOriginDIE != nullptr))
         {
-            FillCodeScopeFromDwarf(functionAbstractOriginDIE, firstSourceFileRealPath, pDwarf, o_scope.m_pParentScope,
-                                   o_scope.m_scopeType, o_scope);
+            FillCodeScopeFromDwarf(functionAbstractOriginDIE, firstSourceFileRealPath, pDwarf, pDeferredVariables,
+                                   o_scope.m_pParentScope, o_scope.m_scopeType, o_scope);
 
             // Release the DIE:
             dwarf_dealloc(pDwarf, (Dwarf_Ptr)functionAbstractOriginDIE, DW_DLA_DIE);
@@ -374,23 +397,42 @@ void DbgInfoDwarfParser::FillCodeScopeFromDwarfRef(Dwarf_Die programDIE,
 /// \param[in] programDIE - Input die
 /// \param[in] firstSourceFileRealPath - default source file path
 /// \param[in] pDwarf - Allocation/Deallocation object
-/// \param[in] err - Error container
+/// \param[in] pDeferredVariables - if not null, only the DIE offset is kept and the variables are read when first requested
 /// \param[out] o_scope - Output parameter the scope with the child vars and scopes filled in
 /// \return void
 /// ---------------------------------------------------------------------------
 
 void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath,
-                                      Dwarf_Debug pDwarf, DwarfCodeScope& o_scope)
+                                      Dwarf_Debug pDwarf, DwarfDeferredVariables* pDeferredVariables, DwarfCodeScope& o_scope)
 {
+    Dwarf_Error err = {0};
+    int rc = DW_DLV_OK;
+
+    // Remember where the variables are, to fill them when they are first requested:
+    if (nullptr != pDeferredVariables)
+    {
+        Dwarf_Off programDIEOffset = 0;
+        rc = dwarf_dieoffset(programDIE, &programDIEOffset, &err);
+
+        if (rc == DW_DLV_OK)
+        {
+            o_scope.m_deferredVariableSources.push_back((HwDbgUInt64)programDIEOffset);
+            o_scope.SetVariablesLoader(LoadDeferredVariables, (void*)pDeferredVariables);
+        }
+        else
+        {
+            // Could not get the offset, fill the variables now:
+            pDeferredVariables = nullptr;
+        }
+    }
+
     // Iterate this DIE's Children, and create program and variable data objects for them:
     Dwarf_Die currentChild = nullptr;
-    Dwarf_Error err = {0};
-    int rc = dwarf_child(programDIE, &currentChild, &err);
+    rc = dwarf_child(programDIE, &currentChild, &err);
     bool goOn = ((rc == DW_DLV_OK) && (currentChild != nullptr));
 
     while (goOn)
     {
-        bool isMember = false;
         // Get the current child's DWARF TAG:
         Dwarf_Half currentChildTag = 0;
         rc = dwarf_tag(currentChild, &currentChildTag, &err);
@@ -426,6 +468,7 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
                     AddChildScope(currentChild,
                                  firstSourceFileRealPath,
                                  pDwarf,
+                                 pDeferredVariables,
                                  GetScopeTypeFromTAG(currentChildTag),
                                  o_scope);
                 }
@@ -444,65 +487,10 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
                 case DW_TAG_enumerator:
                 case DW_TAG_variable:
                 {
-                    // We set the isMember flag based on the DW_TAG_member tag here since
-                    // the FillVariableWithInformationFromDIE() function will decide
-                    // whether to read the expression at "DW_AT_data_member_location" or
-                    // DW_AT_location" based on isMember
-                    if (currentChildTag == DW_TAG_member)
-                    {
-                        isMember = true;
-                    }
-
-                    // This is a variable/const/parameter, create an object: (note: if this is a const we will need to get the value and call SetConstantValue())
-                    bool isConst = false;
-                    bool isParam = false;
-                    GetVariableValueTypeFromTAG(currentChildTag, isConst, isParam);
-                    DwarfVariableInfo* pVariable = new DwarfVariableInfo;
-
-                    // Need to Initialize the location:
-                    if (isConst)
-                    {
-                        pVariable->m_varValue.m_varConstantValue = nullptr;
-                    }
-                    else // !isConst
-                    {
-                        pVariable->m_varValue.m_varValueLocation.Initialize();
-                        // Set the address to be the upper limit of the scope by default:
-                        o_scope.GetHighestAddressInScope(pVariable->m_highVariablePC);
-                    }
-
-                    std::vector<DwarfVariableLocation> variableAdditionalLocations;
-
-                    FillVariableWithInformationFromDIE(currentChild,
-                                                       pDwarf,
-                                                       isMember,
-                                                       *pVariable,
-                                                       variableAdditionalLocations);
-
-                    // Add it to our variables vector:
-                    o_scope.m_scopeVars.push_back(pVariable);
-
-                    // Also add any duplicates it has with other locations:
-                    int numberOfAdditionalLocations = (int)variableAdditionalLocations.size();
-                    // Check that we do not have a const value type AND locations as const vars do not have location:
-                    HWDBG_ASSERT((!isConst) || numberOfAdditionalLocations == 0);
-
-                    // Add additional locations if const or if FillVariableWithInformationFromDIE
-                    // found any others while parsing the DWARF
-                    if ((isConst) || (numberOfAdditionalLocations != 0))
+                    // Deferred variables are filled by LoadDeferredVariables:
+                    if (nullptr == pDeferredVariables)
                     {
-                        for (int i = 0; i < numberOfAdditionalLocations; i++)
-                        {
-                            // Copy the name and other metadata:
-                            DwarfVariableInfo* pVariableAdditionalLocation = new DwarfVariableInfo;
-                            *pVariableAdditionalLocation = *pVariable;
-
-                            // Copy the different location:
-                            pVariableAdditionalLocation->m_varValue.m_varValueLocation = variableAdditionalLocations[i];
-
-                            // Add the variable to the vector:
-                            o_scope.m_scopeVars.push_back(pVariableAdditionalLocation);
-                        }
+                        AddChildVariable(currentChild, currentChildTag, pDwarf, o_scope);
                     }
                 }
                 break;
@@ -541,6 +529,193 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
     HWDBG_ASSERT((DW_DLV_NO_ENTRY == rc) || (DW_DLE_NO_ENTRY == rc) || (DW_DLV_OK == rc));
 }
 
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::FillChildVariables
+/// \brief Description: Fill only the child variables of a DIE into a scope
+/// \param[in] programDIE - Input die
+/// \param[in] pDwarf - Allocation/Deallocation object
+/// \param[out] o_scope - Output parameter the scope with the child vars filled in
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::FillChildVariables(Dwarf_Die programDIE, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope)
+{
+    Dwarf_Die currentChild = nullptr;
+    Dwarf_Error err = {0};
+    int rc = dwarf_child(programDIE, &currentChild, &err);
+    bool goOn = ((rc == DW_DLV_OK) && (currentChild != nullptr));
+
+    while (goOn)
+    {
+        Dwarf_Half currentChildTag = 0;
+        rc = dwarf_tag(currentChild, &currentChildTag, &err);
+        HWDBG_ASSERT(rc == DW_DLV_OK);
+
+        if (rc == DW_DLV_OK)
+        {
+            switch (currentChildTag)
+            {
+                case DW_TAG_member:
+                case DW_TAG_formal_parameter:
+                case DW_TAG_constant:
+                case DW_TAG_enumerator:
+                case DW_TAG_variable:
+                {
+                    AddChildVariable(currentChild, currentChildTag, pDwarf, o_scope);
+                }
+                break;
+
+                default:
+                {
+                    // Child scopes were filled by FillChildren:
+                }
+                break;
+            }; // switch
+        }
+
+        // Get the next child:
+        Dwarf_Die nextChild = nullptr;
+        rc = dwarf_siblingof(pDwarf, currentChild, &nextChild, &err);
+
+        // Release the current child:
+        dwarf_dealloc(pDwarf, (Dwarf_Ptr)currentChild, DW_DLA_DIE);
+
+        // Move to the next iteration:
+        currentChild = nextChild;
+        goOn = ((rc == DW_DLV_OK) && (currentChild != nullptr));
+    }
+
+    // See the note in FillChildren:
+    HWDBG_ASSERT((DW_DLV_NO_ENTRY == rc) || (DW_DLE_NO_ENTRY == rc) || (DW_DLV_OK == rc));
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::AddChildVariable
+/// \brief Description: Fill a variable from its DIE and add it to a scope
+/// \param[in] childDIE - Input die
+/// \param[in] childTag - The DWARF tag of childDIE
+/// \param[in] pDwarf - Allocation/Deallocation object
+/// \param[out] o_scope - Output parameter The scope to which we add the variable
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::AddChildVariable(Dwarf_Die childDIE, Dwarf_Half childTag, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope)
+{
+    // We set the isMember flag based on the DW_TAG_member tag here since
+    // the FillVariableWithInformationFromDIE() function will decide
+    // whether to read the expression at "DW_AT_data_member_location" or
+    // DW_AT_location" based on isMember
+    bool isMember = (childTag == DW_TAG_member);
+
+    // This is a variable/const/parameter, create an object: (note: if this is a const we will need to get the value and call SetConstantValue())
+    bool isConst = false;
+    bool isParam = false;
+    GetVariableValueTypeFromTAG(childTag, isConst, isParam);
+    DwarfVariableInfo* pVariable = o_scope.AllocateVariable();
+
+    if (nullptr == pVariable)
+    {
+        return;
+    }
+
+    // Need to Initialize the location:
+    if (isConst)
+    {
+        pVariable->m_varValue.m_varConstantValue = nullptr;
+    }
+    else // !isConst
+    {
+        pVariable->m_varValue.m_varValueLocation.Initialize();
+        // Set the address to be the upper limit of the scope by default:
+        o_scope.GetHighestAddressInScope(pVariable->m_highVariablePC);
+    }
+
+    std::vector<DwarfVariableLocation> variableAdditionalLocations;
+
+    FillVariableWithInformationFromDIE(childDIE,
+                                       pDwarf,
+                                       isMember,
+                                       *pVariable,
+                                       variableAdditionalLocations);
+
+    // Add it to our variables vector:
+    o_scope.m_scopeVars.push_back(pVariable);
+
+    // Also add any duplicates it has with other locations:
+    int numberOfAdditionalLocations = (int)variableAdditionalLocations.size();
+    // Check that we do not have a const value type AND locations as const vars do not have location:
+    HWDBG_ASSERT((!isConst) || numberOfAdditionalLocations == 0);
+
+    // Add additional locations if const or if FillVariableWithInformationFromDIE
+    // found any others while parsing the DWARF
+    if ((isConst) || (numberOfAdditionalLocations != 0))
+    {
+        for (int i = 0; i < numberOfAdditionalLocations; i++)
+        {
+            // Copy the name and other metadata:
+            DwarfVariableInfo* pVariableAdditionalLocation = o_scope.AllocateVariable();
+
+            if (nullptr == pVariableAdditionalLocation)
+            {
+                break;
+            }
+
+            *pVariableAdditionalLocation = *pVariable;
+
+            // Copy the different location:
+            pVariableAdditionalLocation->m_varValue.m_varValueLocation = variableAdditionalLocations[i];
+
+            // Add the variable to the vector:
+            o_scope.m_scopeVars.push_back(pVariableAdditionalLocation);
+        }
+    }
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::LoadDeferredVariables
+/// \brief Description: Fills the variables of a scope from the DIE offsets FillChildren kept.
+///                     This is the scope's variables loader, called on the first request.
+/// \param[in,out] io_scope - The scope to fill
+/// \param[in] pLoaderData - The DwarfDeferredVariables the scope was parsed with
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::LoadDeferredVariables(DwarfCodeScope& io_scope, void* pLoaderData)
+{
+    DwarfDeferredVariables* pDeferredVariables = (DwarfDeferredVariables*)pLoaderData;
+    HWDBG_ASSERT(nullptr != pDeferredVariables);
+
+    if ((nullptr != pDeferredVariables) && (nullptr != pDeferredVariables->m_pDwarf))
+    {
+        Dwarf_Debug pDwarf = pDeferredVariables->m_pDwarf;
+        size_t numberOfSources = io_scope.m_deferredVariableSources.size();
+
+        for (size_t i = 0; i < numberOfSources; ++i)
+        {
+            Dwarf_Die programDIE = nullptr;
+            Dwarf_Error err = {0};
+            Dwarf_Off programDIEOffset = (Dwarf_Off)io_scope.m_deferredVariableSources[i];
+            int rc = DW_DLV_NO_ENTRY;
+
+            // The children of the DIE are read from its compilation unit:
+            if (SelectCompilationUnit(pDwarf, pDeferredVariables->m_cuEndOffsets, pDeferredVariables->m_nextCU, programDIEOffset))
+            {
+                rc = dwarf_offdie(pDwarf, programDIEOffset, &programDIE, &err);
+            }
+
+            if ((rc == DW_DLV_OK) && (programDIE != nullptr))
+            {
+                FillChildVariables(programDIE, pDwarf, io_scope);
+
+                // Release the DIE:
+                dwarf_dealloc(pDwarf, (Dwarf_Ptr)programDIE, DW_DLA_DIE);
+            }
+        }
+
+        // Intersect the variables in this program:
+        io_scope.IntersectVariablesInScope();
+    }
+
+    io_scope.m_deferredVariableSources.clear();
+}
+
 /// ---------------------------------------------------------------------------
 /// DbgInfoDwarfParser::AddChildScope
 /// \brief Description: Fill a child scope from the die recursively and add it to its parent.
@@ -548,13 +723,14 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
 /// \param[in] childDIE - Input die
 /// \param[in] firstSourceFileRealPath - default source file path
 /// \param[in] pDwarf - Allocation/Deallocation object
-/// \param[in] err - Error container
+/// \param[in] pDeferredVariables - if not null, the variables are read when first requested
 /// \param[in] childScopeType - the type of child scope to add
 /// \param[out] o_scope - Output parameter The scope to which we add the child scope
 /// \return void
 /// ---------------------------------------------------------------------------
 void DbgInfoDwarfParser::AddChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath,
-                                       Dwarf_Debug pDwarf, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope)
+                                       Dwarf_Debug pDwarf, DwarfDeferredVariables* pDeferredVariables,
+                                       const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope)
 {
     bool shouldAddSubprogram = true;
     Dwarf_Error err = {0};
@@ -572,9 +748,10 @@ void DbgInfoDwarfParser::AddChildScope(Dwarf_Die childDIE, const std::string& fi
         }
     }
 
-    if (shouldAddSubprogram)
+    DwarfCodeScope* pChildScope = shouldAddSubprogram ? o_scope.AllocateChildScope() : nullptr;
+
+    if (nullptr != pChildScope)
     {
-        DwarfCodeScope* pChildScope = new DwarfCodeScope;
         pChildScope->m_scopeType = childScopeType;
 
         if (DwarfCodeScope::DID_SCT_INLINED_FUNCTION == childScopeType)
@@ -583,7 +760,7 @@ void DbgInfoDwarfParser::AddChildScope(Dwarf_Die childDIE, const std::string& fi
         }
 
         // Recursively fill the program objects:
-        FillCodeScopeFromDwarf(childDIE, firstSourceFileRealPath, pDwarf, &o_scope, childScopeType, *pChildScope);
+        FillCodeScopeFromDwarf(childDIE, firstSourceFileRealPath, pDwarf, pDeferredVariables, &o_scope, childScopeType, *pChildScope);
 
         // Add the child scope:
         o_scope.m_children.push_back(pChildScope);
@@ -1426,7 +1603,7 @@ bool DbgInfoDwarfParser::ListVariableRegisterLocations(const DwarfCodeScope* pTo
             if (pCurrentScope != nullptr)
             {
                 // Add this program's variables to the locations list:
-                const std::vector<DwarfVariableInfo*>& currentScopeVariables = pCurrentScope->m_scopeVars;
+                const std::vector<DwarfVariableInfo*>& currentScopeVariables = pCurrentScope->GetScopeVariables();
                 int numberOfVariables = (int)currentScopeVariables.size();
 
                 for (int i = 0; i < numberOfVariables; i++)
@@ -1981,108 +2158,100 @@ void DbgInfoDwarfParser::FillTypeNameAndDetailsFromTypeDIE(Dwarf_Die typeDIE,
 }
 
 /// ---------------------------------------------------------------------------
-/// DbgInfoDwarfParser::InitializeWithBinary
-/// \brief Description: Main function: Looks for DWARF sections in the supplied ELF binary and initializes the reading from it.
-/// \param[in] kernelBinary - the data containing the ELF, including size
-/// \param[out] o_scope - Out Param -the top code scope
-/// \param[out] o_lineNumberMapping - Out Param the line <-> address mapping
-/// \param[in] firstSourceFileRealPath - the path to the original source file for the mapping
-/// \return Success / failure.
+/// \struct DbgInfoDwarfParser::CompilationUnitsParseState
+/// \brief Description: The work shared by the threads parsing the compilation units of a binary.
+///                     Each unit is filled into its own scope and line mapping, so the threads
+///                     only share the index of the next unit to parse.
 /// ---------------------------------------------------------------------------
-bool DbgInfoDwarfParser::InitializeWithBinary(const KernelBinary& kernelBinary,
-                                              DwarfCodeScope& o_scope,
-                                              DwarfLineMapping& o_lineNumberMapping,
-                                              const std::string& firstSourceFileRealPath)
+struct DbgInfoDwarfParser::CompilationUnitsParseState
 {
-    bool retVal = false;
-
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
+    const KernelBinary* m_pBinary;                      ///< The binary the DWARF is read from
+    const std::vector<Dwarf_Off>* m_pCUDIEOffsets;      ///< The compilation units to parse
+    const std::vector<Dwarf_Unsigned>* m_pCUEndOffsets; ///< The end offsets of the compilation units
+    const std::string* m_pFirstSourceFileRealPath;      ///< Replaces the main source path of the first unit
+    DwarfDeferredVariables* m_pDeferredVariables;       ///< If not null, the variables are read when first requested
+    DwarfCodeScope* m_pParentScope;                     ///< The scope the units will be merged into
+    std::vector<DwarfCodeScope*> m_cuScopes;            ///< The scope of each unit
+    std::vector<DbgInfoArena*> m_cuArenas;              ///< The arena of each unit's descendants, if the parent scope has an arena
+    std::vector<DwarfLineMapping*> m_cuLineMappings;    ///< The line mapping of each unit
+    std::vector<unsigned char> m_cuSucceeded;           ///< Whether each unit was filled
+    std::atomic<size_t> m_nextCU;                       ///< The next unit to parse
+};
 
-    // Initialize an Elf object with the buffer:
-    Elf* pElf = elf_memory((char*)(kernelBinary.m_pBinaryData), kernelBinary.m_binarySize);
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::SelectCompilationUnit
+/// \brief Description: Makes the compilation unit containing a DIE the current one. libdwarf
+///                     only iterates DIE siblings within the current compilation unit, and only
+///                     moves between units in order, so the unit is found by a binary search and
+///                     the iteration is only advanced when the DIE is in another unit.
+/// \param[in] pDwarf - Allocation/Deallocation object ptr
+/// \param[in] cuEndOffsets - the end offsets of the compilation units, from ListCompilationUnits
+/// \param[in,out] io_nextCU - the unit the next dwarf_next_cu_header call returns
+/// \param[in] dieOffset - the offset of a DIE in the compilation unit
+/// \return True : the compilation unit was found
+/// \return False: Otherwise
+/// ---------------------------------------------------------------------------
+bool DbgInfoDwarfParser::SelectCompilationUnit(Dwarf_Debug pDwarf, const std::vector<Dwarf_Unsigned>& cuEndOffsets, size_t& io_nextCU, Dwarf_Off dieOffset)
+{
+    bool retVal = false;
     Dwarf_Error err = {0};
-    Dwarf_Debug pDwarf = nullptr;
+    Dwarf_Unsigned nextCUHeaderOffset = 0;
 
-    HWDBG_ASSERT(pElf != nullptr);
+    // The CUs are in offset order, find the first one which ends after the DIE:
+    std::vector<Dwarf_Unsigned>::const_iterator findIter = std::upper_bound(cuEndOffsets.begin(), cuEndOffsets.end(), (Dwarf_Unsigned)dieOffset);
 
-    if (pElf != nullptr)
+    if (cuEndOffsets.end() != findIter)
     {
-        // Initialize a D with this Elf object:
-        int rcDW = dwarf_elf_init(pElf, DW_DLC_READ, nullptr, nullptr, &pDwarf, &err);
+        size_t cuIndex = (size_t)(findIter - cuEndOffsets.begin());
 
-        if ((rcDW == DW_DLV_OK) && (pDwarf != nullptr))
-        {
-            // Mark that we succeeded:
-            retVal = true;
+        // The unit is already the current one:
+        retVal = (io_nextCU == cuIndex + 1);
 
-            // Get the offset for the compilation unit. Note that we expect OpenCL kernels
-            // to only have one CU. Check that we have one at all:
-            Dwarf_Unsigned cuHeaderOffset = 0;
+        if (!retVal)
+        {
+            // Reaching the end of the CU headers restarts the iteration from the first one:
+            if (cuIndex < io_nextCU)
+            {
+                while (DW_DLV_OK == dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &nextCUHeaderOffset, &err))
+                {
+                }
 
-            int rc = dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &cuHeaderOffset, &err);
+                io_nextCU = 0;
+            }
 
-            if (rc == DW_DLV_OK)
+            while ((io_nextCU <= cuIndex) && (DW_DLV_OK == dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &nextCUHeaderOffset, &err)))
             {
-                // Get the DIE for the first CU by calling for the sibling of nullptr:
-                Dwarf_Die cuDIE = nullptr;
-                rc = dwarf_siblingof(pDwarf, nullptr, &cuDIE, &err);
+                io_nextCU++;
+            }
+
+            retVal = (io_nextCU == cuIndex + 1) && (cuEndOffsets[cuIndex] == nextCUHeaderOffset);
+        }
 
-                // This is the location of the CU DIE.
-                // We need to get the directory name from here to possibly deal with HSADBG-855
+        if (!retVal)
+        {
+            // Something else moved the iteration, restart it and count the units again:
+            while (DW_DLV_OK == dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &nextCUHeaderOffset, &err))
+            {
+            }
 
-                if (rc == DW_DLV_OK)
-                {
-                    // Start recursion to fill code scope
-                    FillCodeScopeFromDwarf(cuDIE,
-                                           firstSourceFileRealPath,
-                                           pDwarf,
-                                           nullptr,
-                                           DwarfCodeScope::DID_SCT_COMPILATION_UNIT,
-                                           o_scope);
-
-                    // Use the CU DIE to get the line number information.
-                    // This needs to happen after the programs are initialized, since each
-                    // entry must be associated with a program:
-                    DwarfLineMapping lineNumberMapping;
-                    bool rcLn = FillLineMappingFromDwarf(cuDIE,
-                                                        firstSourceFileRealPath,
-                                                        pDwarf,
-                                                        o_lineNumberMapping);
-                    HWDBG_ASSERT(rcLn);
+            io_nextCU = 0;
 
-                    // Fill addresses from mapping:
-                    std::vector<DwarfAddrType> addresses;
-                    o_lineNumberMapping.GetMappedAddresses(addresses);
-                    retVal = o_scope.MapAddressesToCodeScopes(addresses);
-                    HWDBG_ASSERT(retVal);
+            while (DW_DLV_OK == dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &nextCUHeaderOffset, &err))
+            {
+                io_nextCU++;
 
-                    // Release the CU DIE:
-                    dwarf_dealloc(pDwarf, (Dwarf_Ptr)cuDIE, DW_DLA_DIE);
+                if ((Dwarf_Unsigned)dieOffset < nextCUHeaderOffset)
+                {
+                    retVal = true;
+                    break;
                 }
             }
-        }
-        else
-        {
-            // Report initialization errors:
-            HWDBG_DW_REPORT_ERROR(err, false);
-        }
-    }
-
-    // If we failed, clean up:
-    if (!retVal)
-    {
-        if (pDwarf != nullptr)
-        {
-            int rcDF = dwarf_finish(pDwarf, &err);
-            HWDBG_ASSERT(DW_DLV_OK == rcDF);
-        }
 
-        if (pElf != nullptr)
-        {
-            int rcEF = elf_end(pElf);
-            HWDBG_ASSERT(rcEF == 0);
-            pElf = nullptr;
+            // The iteration restarted:
+            if (!retVal)
+            {
+                io_nextCU = 0;
+            }
         }
     }
 
@@ -2090,50 +2259,487 @@ bool DbgInfoDwarfParser::InitializeWithBinary(const KernelBinary& kernelBinary,
 }
 
 /// ---------------------------------------------------------------------------
-/// DbgInfoDwarfParser::FillVariableWithInformationFromDIE
-/// \brief Description: Recursively fills variable information from the DIE
-/// \param[in] variableDIE - Input DIE
-/// \param[in] pDwarf - Allocation/Deallocation object
-/// \param[in] err - Error container
-/// \param[in] isMember - whether this variable is a member of another
-/// \param[out] o_variableData - Output Param the filled variable
-/// \param[out] o_variableAdditionalLocations - additional locations of this same variable added so that we know if we have at least one location.
+/// DbgInfoDwarfParser::ListCompilationUnits
+/// \brief Description: Lists the DIE offsets of all the compilation units. Code objects which
+///                     link device libraries have more than one.
+/// \param[in] pDwarf - Allocation/Deallocation object ptr
+/// \param[out] o_cuDIEOffsets - the offsets of the compilation unit DIEs
+/// \param[out] o_cuEndOffsets - the end offset of each compilation unit, used to select them
 /// \return void
 /// ---------------------------------------------------------------------------
-void DbgInfoDwarfParser::FillVariableWithInformationFromDIE(Dwarf_Die variableDIE,
-                                                            Dwarf_Debug pDwarf,
-                                                            bool isMember,
-                                                            DwarfVariableInfo& o_variableData,
-                                                            std::vector<DwarfVariableLocation>& o_variableAdditionalLocations)
+void DbgInfoDwarfParser::ListCompilationUnits(Dwarf_Debug pDwarf, std::vector<Dwarf_Off>& o_cuDIEOffsets, std::vector<Dwarf_Unsigned>& o_cuEndOffsets)
 {
+    o_cuDIEOffsets.clear();
+    o_cuEndOffsets.clear();
     Dwarf_Error err = {0};
-    // Get the variable's location attribute:
-    o_variableAdditionalLocations.clear();
+    Dwarf_Unsigned cuHeaderOffset = 0;
 
-    // Get the variable name:
-    FillVarName(variableDIE, pDwarf, o_variableData);
+    // Iterate all the CU headers, reaching the end also resets the iteration:
+    while (DW_DLV_OK == dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &cuHeaderOffset, &err))
+    {
+        // The next header starts where this unit ends:
+        o_cuEndOffsets.push_back(cuHeaderOffset);
 
-    // Check if const:
-    bool isConst = o_variableData.IsConst();
+        // Get the DIE for the current CU by calling for the sibling of nullptr:
+        Dwarf_Die cuDIE = nullptr;
+        int rc = dwarf_siblingof(pDwarf, nullptr, &cuDIE, &err);
 
-    // Locations:
-    Dwarf_Attribute varLocDescAsAttribute = nullptr;
-    int rc = dwarf_attr(variableDIE,
-                        isMember ? DW_AT_data_member_location : DW_AT_location, // Choose attribute based on input
-                        &varLocDescAsAttribute,
-                        &err);
+        if (DW_DLV_OK == rc)
+        {
+            Dwarf_Off cuDIEOffset = 0;
+            rc = dwarf_dieoffset(cuDIE, &cuDIEOffset, &err);
 
-    // Do not go in here if const or if any variable location attribute is not found
-    if ((rc == DW_DLV_OK) && (varLocDescAsAttribute != nullptr) && (!isConst))
-    {
-        // Get the location list from the attribute:
-        Dwarf_Locdesc* pVarLocationDescriptions = nullptr;
-        Dwarf_Signed locationsCount = 0;
+            if (DW_DLV_OK == rc)
+            {
+                o_cuDIEOffsets.push_back(cuDIEOffset);
+            }
 
-        // Before calling the loclist function, make sure the attribute is the correct format (one of the block formats).
-        // See BUG365690 - the compiler sometime emits numbers instead of data blocks here, and our DWARF implementation does not
-        // verify the input of dwarf_loclist.
-        Dwarf_Half attrFormat = DW_FORM_block;
+            dwarf_dealloc(pDwarf, (Dwarf_Ptr)cuDIE, DW_DLA_DIE);
+        }
+    }
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::FillCompilationUnitFromDwarf
+/// \brief Description: Fills the scope tree and line mapping of one compilation unit
+/// \param[in] cuDIEOffset - the offset of the compilation unit DIE
+/// \param[in] firstSourceFileRealPath - the path to the original source file for the mapping
+/// \param[in] pDwarf - Allocation/Deallocation object ptr
+/// \param[in] cuEndOffsets - the end offsets of the compilation units, from ListCompilationUnits
+/// \param[in,out] io_nextCU - the unit pDwarf's next dwarf_next_cu_header call returns
+/// \param[in] pDeferredVariables - if not null, the variables are read when first requested
+/// \param[in] pParentScope - parent scope, null if the unit is the top level
+/// \param[out] o_scope - Out param the compilation unit scope
+/// \param[out] o_lineNumberMapping - Out param the line <-> address mapping
+/// \return True : the compilation unit DIE was found
+/// \return False: Otherwise
+/// ---------------------------------------------------------------------------
+bool DbgInfoDwarfParser::FillCompilationUnitFromDwarf(Dwarf_Off cuDIEOffset,
+                                                      const std::string& firstSourceFileRealPath,
+                                                      Dwarf_Debug pDwarf,
+                                                      const std::vector<Dwarf_Unsigned>& cuEndOffsets,
+                                                      size_t& io_nextCU,
+                                                      DwarfDeferredVariables* pDeferredVariables,
+                                                      DwarfCodeScope* pParentScope,
+                                                      DwarfCodeScope& o_scope,
+                                                      DwarfLineMapping& o_lineNumberMapping)
+{
+    bool retVal = false;
+    Dwarf_Error err = {0};
+    Dwarf_Die cuDIE = nullptr;
+    int rc = DW_DLV_NO_ENTRY;
+
+    // Get the DIE for the CU by calling for the sibling of nullptr:
+    if (SelectCompilationUnit(pDwarf, cuEndOffsets, io_nextCU, cuDIEOffset))
+    {
+        rc = dwarf_siblingof(pDwarf, nullptr, &cuDIE, &err);
+    }
+
+    // This is the location of the CU DIE.
+    // We need to get the directory name from here to possibly deal with HSADBG-855
+
+    if (DW_DLV_OK == rc)
+    {
+        retVal = true;
+
+        // Start recursion to fill code scope
+        FillCodeScopeFromDwarf(cuDIE,
+                               firstSourceFileRealPath,
+                               pDwarf,
+                               pDeferredVariables,
+                               pParentScope,
+                               DwarfCodeScope::DID_SCT_COMPILATION_UNIT,
+                               o_scope);
+
+        // Use the CU DIE to get the line number information.
+        // This needs to happen after the programs are initialized, since each
+        // entry must be associated with a program:
+        bool rcLn = FillLineMappingFromDwarf(cuDIE,
+                                             firstSourceFileRealPath,
+                                             pDwarf,
+                                             o_lineNumberMapping);
+        HWDBG_ASSERT(rcLn);
+
+        // Release the CU DIE:
+        dwarf_dealloc(pDwarf, (Dwarf_Ptr)cuDIE, DW_DLA_DIE);
+    }
+
+    return retVal;
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::FillCompilationUnitsWorker
+/// \brief Description: Worker thread function. libdwarf handles may not be shared between
+///                     threads, so each worker opens the binary on its own.
+/// \param[in,out] pState - the shared parse state
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::FillCompilationUnitsWorker(CompilationUnitsParseState* pState)
+{
+    const KernelBinary& kernelBinary = *pState->m_pBinary;
+    Elf* pElf = elf_memory((char*)(kernelBinary.m_pBinaryData), kernelBinary.m_binarySize);
+    Dwarf_Error err = {0};
+    Dwarf_Debug pDwarf = nullptr;
+
+    if (pElf != nullptr)
+    {
+        int rcDW = dwarf_elf_init(pElf, DW_DLC_READ, nullptr, nullptr, &pDwarf, &err);
+
+        if ((rcDW == DW_DLV_OK) && (pDwarf != nullptr))
+        {
+            const std::vector<Dwarf_Off>& cuDIEOffsets = *pState->m_pCUDIEOffsets;
+            size_t numberOfCUs = cuDIEOffsets.size();
+            const std::string noRealPath;
+
+            // A new DWARF starts the CU header iteration from the first unit:
+            size_t nextCU = 0;
+
+            for (size_t i = pState->m_nextCU++; i < numberOfCUs; i = pState->m_nextCU++)
+            {
+                if (nullptr == pState->m_cuScopes[i])
+                {
+                    continue;
+                }
+
+                // Only the first unit is the kernel main source:
+                const std::string& firstSourceFileRealPath = (0 == i) ? *pState->m_pFirstSourceFileRealPath : noRealPath;
+                bool rcCU = FillCompilationUnitFromDwarf(cuDIEOffsets[i],
+                                                         firstSourceFileRealPath,
+                                                         pDwarf,
+                                                         *pState->m_pCUEndOffsets,
+                                                         nextCU,
+                                                         pState->m_pDeferredVariables,
+                                                         pState->m_pParentScope,
+                                                         *pState->m_cuScopes[i],
+                                                         *pState->m_cuLineMappings[i]);
+                pState->m_cuSucceeded[i] = rcCU ? 1 : 0;
+            }
+
+            int rcDF = dwarf_finish(pDwarf, &err);
+            HWDBG_ASSERT(DW_DLV_OK == rcDF);
+        }
+        else
+        {
+            // Report initialization errors:
+            HWDBG_DW_REPORT_ERROR(err, false);
+        }
+
+        int rcEF = elf_end(pElf);
+        HWDBG_ASSERT(rcEF == 0);
+    }
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::FillCompilationUnitsInParallel
+/// \brief Description: Fills each compilation unit into its own scope and line mapping on a
+///                     small pool of threads, then merges them in order: the units become the
+///                     children of a global scope, and their line mappings are joined.
+/// \param[in] kernelBinary - the data containing the ELF, including size
+/// \param[in] cuDIEOffsets - the offsets of the compilation unit DIEs
+/// \param[in] cuEndOffsets - the end offsets of the compilation units
+/// \param[in] firstSourceFileRealPath - the path to the original source file for the mapping
+/// \param[in] pDeferredVariables - if not null, the variables are read when first requested
+/// \param[out] o_scope - Out Param - the global scope
+/// \param[out] o_lineNumberMapping - Out Param the line <-> address mapping
+/// \return True : at least one compilation unit was filled
+/// \return False: Otherwise
+/// ---------------------------------------------------------------------------
+bool DbgInfoDwarfParser::FillCompilationUnitsInParallel(const KernelBinary& kernelBinary,
+                                                        const std::vector<Dwarf_Off>& cuDIEOffsets,
+                                                        const std::vector<Dwarf_Unsigned>& cuEndOffsets,
+                                                        const std::string& firstSourceFileRealPath,
+                                                        DwarfDeferredVariables* pDeferredVariables,
+                                                        DwarfCodeScope& o_scope,
+                                                        DwarfLineMapping& o_lineNumberMapping)
+{
+    bool retVal = false;
+    size_t numberOfCUs = cuDIEOffsets.size();
+
+    CompilationUnitsParseState state;
+    state.m_pBinary = &kernelBinary;
+    state.m_pCUDIEOffsets = &cuDIEOffsets;
+    state.m_pCUEndOffsets = &cuEndOffsets;
+    state.m_pFirstSourceFileRealPath = &firstSourceFileRealPath;
+    state.m_pDeferredVariables = pDeferredVariables;
+    state.m_pParentScope = &o_scope;
+    state.m_cuSucceeded.resize(numberOfCUs, 0);
+    state.m_nextCU = 0;
+
+    for (size_t i = 0; i < numberOfCUs; i++)
+    {
+        DwarfCodeScope* pCUScope = o_scope.AllocateChildScope();
+        DbgInfoArena* pCUArena = nullptr;
+
+        // The threads do not share an arena, each unit's blocks are adopted by the parent's arena when merging:
+        if ((nullptr != pCUScope) && (nullptr != o_scope.m_pArena))
+        {
+            pCUArena = new DbgInfoArena;
+            pCUScope->m_pArena = pCUArena;
+        }
+
+        state.m_cuScopes.push_back(pCUScope);
+        state.m_cuArenas.push_back(pCUArena);
+        state.m_cuLineMappings.push_back(new DwarfLineMapping);
+    }
+
+    // The calling thread is one of the workers:
+    size_t numberOfWorkers = std::min(numberOfCUs, (size_t)DWARF_PARSER_MAX_CU_WORKERS);
+    numberOfWorkers = std::min(numberOfWorkers, (size_t)std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+
+    for (size_t i = 1; i < numberOfWorkers; i++)
+    {
+        try
+        {
+            workers.push_back(std::thread(FillCompilationUnitsWorker, &state));
+        }
+        catch (const std::system_error&)
+        {
+            // The running workers take over the remaining units:
+            break;
+        }
+    }
+
+    FillCompilationUnitsWorker(&state);
+
+    size_t numberOfStartedWorkers = workers.size();
+
+    for (size_t i = 0; i < numberOfStartedWorkers; i++)
+    {
+        workers[i].join();
+    }
+
+    // The global scope covers all the compilation units:
+    o_scope.m_scopeType = DwarfCodeScope::DID_SCT_GLOBAL_SCOPE;
+    o_scope.m_pParentScope = nullptr;
+
+    for (size_t i = 0; i < numberOfCUs; i++)
+    {
+        DwarfCodeScope* pCUScope = state.m_cuScopes[i];
+        DbgInfoArena* pCUArena = state.m_cuArenas[i];
+        retVal = retVal || (0 != state.m_cuSucceeded[i]);
+
+        if (nullptr != pCUArena)
+        {
+            o_scope.m_pArena->Adopt(*pCUArena);
+            pCUScope->SetArena(o_scope.m_pArena);
+            delete pCUArena;
+        }
+
+        if (nullptr != pCUScope)
+        {
+            o_scope.m_children.push_back(pCUScope);
+            o_scope.m_scopeAddressRanges.insert(o_scope.m_scopeAddressRanges.end(), pCUScope->m_scopeAddressRanges.begin(), pCUScope->m_scopeAddressRanges.end());
+            o_scope.m_scopeHasNonTrivialAddressRanges = o_scope.m_scopeHasNonTrivialAddressRanges || pCUScope->m_scopeHasNonTrivialAddressRanges;
+        }
+
+        // Join the line mappings in order, an address already mapped by an earlier unit keeps its line:
+        DwarfLineMapping* pCULineMapping = state.m_cuLineMappings[i];
+        std::vector<DwarfAddrType> cuAddresses;
+        pCULineMapping->GetMappedAddresses(cuAddresses);
+        size_t numberOfAddrs = cuAddresses.size();
+
+        for (size_t j = 0; j < numberOfAddrs; j++)
+        {
+            FileLocation cuLine;
+
+            if (pCULineMapping->GetLineFromAddress(cuAddresses[j], cuLine))
+            {
+                o_lineNumberMapping.AddLineMapping(cuLine, cuAddresses[j]);
+            }
+        }
+
+        delete pCULineMapping;
+    }
+
+    return retVal;
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::InitializeWithBinary
+/// \brief Description: Main function: Looks for DWARF sections in the supplied ELF binary and initializes the reading from it.
+/// \param[in] kernelBinary - the data containing the ELF, including size
+/// \param[out] o_scope - Out Param -the top code scope
+/// \param[out] o_lineNumberMapping - Out Param the line <-> address mapping
+/// \param[in] firstSourceFileRealPath - the path to the original source file for the mapping
+/// \param[out] o_pDeferredVariables - if not null, keeps the DWARF open so variables are read when first requested
+/// \return Success / failure.
+/// ---------------------------------------------------------------------------
+bool DbgInfoDwarfParser::InitializeWithBinary(const KernelBinary& kernelBinary,
+                                              DwarfCodeScope& o_scope,
+                                              DwarfLineMapping& o_lineNumberMapping,
+                                              const std::string& firstSourceFileRealPath,
+                                              DwarfDeferredVariables* o_pDeferredVariables)
+{
+    bool retVal = false;
+
+    // Set the version of elf:
+    InitializeElfVersion();
+
+    // The DWARF reads from the binary, so deferred variables need a copy that lives as long as the scopes.
+    // Only the DWARF sections are copied, the code and data are usually most of a kernel binary.
+    // Otherwise, the binary is parsed in place:
+    const KernelBinary* pParsedBinary = &kernelBinary;
+
+    if (nullptr != o_pDeferredVariables)
+    {
+        o_pDeferredVariables->Release();
+
+        if (!kernelBinary.getElfDebugSectionsAsBinary(o_pDeferredVariables->m_binary))
+        {
+            o_pDeferredVariables->m_binary.setBinary(kernelBinary.m_pBinaryData, kernelBinary.m_binarySize);
+        }
+
+        pParsedBinary = &o_pDeferredVariables->m_binary;
+    }
+
+    // Initialize an Elf object with the buffer:
+    Elf* pElf = elf_memory((char*)(pParsedBinary->m_pBinaryData), pParsedBinary->m_binarySize);
+    Dwarf_Error err = {0};
+    Dwarf_Debug pDwarf = nullptr;
+
+    // The compilation unit ranges, and where the CU header iteration of pDwarf is:
+    std::vector<Dwarf_Unsigned> cuEndOffsets;
+    size_t nextCU = 0;
+
+    HWDBG_ASSERT(pElf != nullptr);
+
+    if (pElf != nullptr)
+    {
+        // Initialize a D with this Elf object:
+        int rcDW = dwarf_elf_init(pElf, DW_DLC_READ, nullptr, nullptr, &pDwarf, &err);
+
+        if ((rcDW == DW_DLV_OK) && (pDwarf != nullptr))
+        {
+            // Mark that we succeeded:
+            retVal = true;
+
+            // Find the compilation units:
+            std::vector<Dwarf_Off> cuDIEOffsets;
+            ListCompilationUnits(pDwarf, cuDIEOffsets, cuEndOffsets);
+            size_t numberOfCUs = cuDIEOffsets.size();
+
+            if (1 == numberOfCUs)
+            {
+                // The only compilation unit is the top scope:
+                retVal = FillCompilationUnitFromDwarf(cuDIEOffsets[0],
+                                                      firstSourceFileRealPath,
+                                                      pDwarf,
+                                                      cuEndOffsets,
+                                                      nextCU,
+                                                      o_pDeferredVariables,
+                                                      nullptr,
+                                                      o_scope,
+                                                      o_lineNumberMapping);
+            }
+            else if (1 < numberOfCUs)
+            {
+                retVal = FillCompilationUnitsInParallel(*pParsedBinary,
+                                                        cuDIEOffsets,
+                                                        cuEndOffsets,
+                                                        firstSourceFileRealPath,
+                                                        o_pDeferredVariables,
+                                                        o_scope,
+                                                        o_lineNumberMapping);
+            }
+
+            if (retVal && (0 < numberOfCUs))
+            {
+                o_lineNumberMapping.Freeze();
+
+                // Fill addresses from mapping:
+                std::vector<DwarfAddrType> addresses;
+                o_lineNumberMapping.GetMappedAddresses(addresses);
+                retVal = o_scope.MapAddressesToCodeScopes(addresses);
+                HWDBG_ASSERT(retVal);
+                o_scope.BuildAddressIndex();
+            }
+        }
+        else
+        {
+            // Report initialization errors:
+            HWDBG_DW_REPORT_ERROR(err, false);
+        }
+    }
+
+    if (retVal && (nullptr != o_pDeferredVariables))
+    {
+        // The scopes read their variables from the DWARF later:
+        o_pDeferredVariables->m_pElf = pElf;
+        o_pDeferredVariables->m_pDwarf = pDwarf;
+        o_pDeferredVariables->m_cuEndOffsets.swap(cuEndOffsets);
+        o_pDeferredVariables->m_nextCU = nextCU;
+    }
+    else
+    {
+        // Everything was copied out of the DWARF, or we failed - clean up:
+        if (pDwarf != nullptr)
+        {
+            int rcDF = dwarf_finish(pDwarf, &err);
+            HWDBG_ASSERT(DW_DLV_OK == rcDF);
+        }
+
+        if (pElf != nullptr)
+        {
+            int rcEF = elf_end(pElf);
+            HWDBG_ASSERT(rcEF == 0);
+            pElf = nullptr;
+        }
+
+        if (nullptr != o_pDeferredVariables)
+        {
+            o_pDeferredVariables->Release();
+        }
+    }
+
+    return retVal;
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::FillVariableWithInformationFromDIE
+/// \brief Description: Recursively fills variable information from the DIE
+/// \param[in] variableDIE - Input DIE
+/// \param[in] pDwarf - Allocation/Deallocation object
+/// \param[in] err - Error container
+/// \param[in] isMember - whether this variable is a member of another
+/// \param[out] o_variableData - Output Param the filled variable
+/// \param[out] o_variableAdditionalLocations - additional locations of this same variable added so that we know if we have at least one location.
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::FillVariableWithInformationFromDIE(Dwarf_Die variableDIE,
+                                                            Dwarf_Debug pDwarf,
+                                                            bool isMember,
+                                                            DwarfVariableInfo& o_variableData,
+                                                            std::vector<DwarfVariableLocation>& o_variableAdditionalLocations)
+{
+    Dwarf_Error err = {0};
+    // Get the variable's location attribute:
+    o_variableAdditionalLocations.clear();
+
+    // Get the variable name:
+    FillVarName(variableDIE, pDwarf, o_variableData);
+
+    // Check if const:
+    bool isConst = o_variableData.IsConst();
+
+    // Locations:
+    Dwarf_Attribute varLocDescAsAttribute = nullptr;
+    int rc = dwarf_attr(variableDIE,
+                        isMember ? DW_AT_data_member_location : DW_AT_location, // Choose attribute based on input
+                        &varLocDescAsAttribute,
+                        &err);
+
+    // Do not go in here if const or if any variable location attribute is not found
+    if ((rc == DW_DLV_OK) && (varLocDescAsAttribute != nullptr) && (!isConst))
+    {
+        // Get the location list from the attribute:
+        Dwarf_Locdesc* pVarLocationDescriptions = nullptr;
+        Dwarf_Signed locationsCount = 0;
+
+        // Before calling the loclist function, make sure the attribute is the correct format (one of the block formats).
+        // See BUG365690 - the compiler sometime emits numbers instead of data blocks here, and our DWARF implementation does not
+        // verify the input of dwarf_loclist.
+        Dwarf_Half attrFormat = DW_FORM_block;
         rc = dwarf_whatform(varLocDescAsAttribute, &attrFormat, &err);
 
         if ((DW_DLV_OK == rc) &&
@@ -2605,8 +3211,8 @@ void DbgInfoDwarfParser::CreateVarNameFromType(Dwarf_Die typeDIE, DwarfVariableI
         o_variable.m_varName += "member_";
     }
 
-    // Add a serial number (spanning between types, etc):
-    static int unknownMemberIndex = 0;
+    // Add a serial number (spanning between types, etc), compilation units may be parsed concurrently:
+    static std::atomic<int> unknownMemberIndex(0);
     o_variable.m_varName += string_format("%d", unknownMemberIndex++);
 }
 
@@ -2779,43 +3385,111 @@ bool DbgInfoDwarfParser::DwarfLocationResolver(
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// KernelBinary
+/// DwarfDeferredVariables
 /// \brief Description: Constructor
-/// \param[in]          pBinaryData - buffer
-/// \param[in]          binarySize - size
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::KernelBinary(const void* pBinaryData, size_t binarySize) : m_pBinaryData(nullptr), m_binarySize(0)
+DwarfDeferredVariables::DwarfDeferredVariables() : m_binary(nullptr, 0), m_pElf(nullptr), m_pDwarf(nullptr), m_nextCU(0)
 {
-    setBinary(pBinaryData, binarySize);
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// KernelBinary
-/// \brief Description: Copy Constructor
-/// \param[in]          rhs - other KernelBinary
+/// ~DwarfDeferredVariables
+/// \brief Description: Destructor
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::KernelBinary(const KernelBinary& rhs) : m_pBinaryData(nullptr), m_binarySize(0)
+DwarfDeferredVariables::~DwarfDeferredVariables()
 {
-    setBinary(rhs.m_pBinaryData, rhs.m_binarySize);
+    Release();
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// ~KernelBinary
-/// \brief Description: Releases the buffer
+/// Release
+/// \brief Description: Closes the DWARF and releases the binary. Scopes whose variables were not
+///                     loaded yet will have no variables after this.
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::~KernelBinary()
+void DwarfDeferredVariables::Release()
 {
-    setBinary(nullptr, 0);
+    if (nullptr != m_pDwarf)
+    {
+        Dwarf_Error err = {0};
+        int rcDF = dwarf_finish(m_pDwarf, &err);
+        HWDBG_ASSERT(DW_DLV_OK == rcDF);
+        m_pDwarf = nullptr;
+    }
+
+    if (nullptr != m_pElf)
+    {
+        int rcEF = elf_end(m_pElf);
+        HWDBG_ASSERT(rcEF == 0);
+        m_pElf = nullptr;
+    }
+
+    m_binary.setBinary(nullptr, 0);
+    m_cuEndOffsets.clear();
+    m_nextCU = 0;
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// operator=
-/// \brief Description: Copy assignment operator
-/// \param[in]          rhs - other KernelBinary
-/// -----------------------------------------------------------------------------------------------
-KernelBinary& KernelBinary::operator=(const KernelBinary& rhs)
+/// KernelBinary
+/// \brief Description: Constructor
+/// \param[in]          pBinaryData - buffer
+/// \param[in]          binarySize - size
+/// \param[in]          copyData - copy the buffer, or view it in place. A viewed buffer must outlive the binary
+/// -----------------------------------------------------------------------------------------------
+KernelBinary::KernelBinary(const void* pBinaryData, size_t binarySize, bool copyData)
+    : m_pBinaryData(nullptr), m_binarySize(0), m_ownsData(false), m_isElfSectionIndexBuilt(false)
+{
+    if (copyData)
+    {
+        setBinary(pBinaryData, binarySize);
+    }
+    else
+    {
+        setBinaryView(pBinaryData, binarySize);
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// KernelBinary
+/// \brief Description: Copy Constructor. A copy of a view is a view of the same buffer
+/// \param[in]          rhs - other KernelBinary
+/// -----------------------------------------------------------------------------------------------
+KernelBinary::KernelBinary(const KernelBinary& rhs)
+    : m_pBinaryData(nullptr), m_binarySize(0), m_ownsData(false), m_isElfSectionIndexBuilt(false)
+{
+    operator=(rhs);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ~KernelBinary
+/// \brief Description: Releases the buffer
+/// -----------------------------------------------------------------------------------------------
+KernelBinary::~KernelBinary()
 {
-    setBinary(rhs.m_pBinaryData, rhs.m_binarySize);
+    releaseBinary();
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// operator=
+/// \brief Description: Copy assignment operator
+/// \param[in]          rhs - other KernelBinary
+/// -----------------------------------------------------------------------------------------------
+KernelBinary& KernelBinary::operator=(const KernelBinary& rhs)
+{
+    if (this != &rhs)
+    {
+        if (rhs.m_ownsData)
+        {
+            setBinary(rhs.m_pBinaryData, rhs.m_binarySize);
+        }
+        else
+        {
+            setBinaryView(rhs.m_pBinaryData, rhs.m_binarySize);
+        }
+
+        // The section offsets are relative to the buffer start, so they remain valid for the copy:
+        m_elfSections = rhs.m_elfSections;
+        m_isElfSectionIndexBuilt = rhs.m_isElfSectionIndexBuilt;
+    }
 
     return *this;
 }
@@ -2826,10 +3500,15 @@ KernelBinary& KernelBinary::operator=(const KernelBinary& rhs)
 /// \brief Description: Move Constructor
 /// \param[in]          xhs - other KernelBinary
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::KernelBinary(KernelBinary&& xhs) : m_pBinaryData(xhs.m_pBinaryData), m_binarySize(xhs.m_binarySize)
+KernelBinary::KernelBinary(KernelBinary&& xhs)
+    : m_pBinaryData(xhs.m_pBinaryData), m_binarySize(xhs.m_binarySize), m_ownsData(xhs.m_ownsData),
+      m_elfSections(std::move(xhs.m_elfSections)), m_isElfSectionIndexBuilt(xhs.m_isElfSectionIndexBuilt)
 {
     xhs.m_pBinaryData = nullptr;
     xhs.m_binarySize = 0;
+    xhs.m_ownsData = false;
+    xhs.m_elfSections.clear();
+    xhs.m_isElfSectionIndexBuilt = false;
 }
 
 /// -----------------------------------------------------------------------------------------------
@@ -2839,15 +3518,44 @@ KernelBinary::KernelBinary(KernelBinary&& xhs) : m_pBinaryData(xhs.m_pBinaryData
 /// -----------------------------------------------------------------------------------------------
 KernelBinary& KernelBinary::operator=(KernelBinary&& xhs)
 {
-    m_pBinaryData = xhs.m_pBinaryData;
-    m_binarySize = xhs.m_binarySize;
-    xhs.m_pBinaryData = nullptr;
-    xhs.m_binarySize = 0;
+    if (this != &xhs)
+    {
+        releaseBinary();
+
+        m_pBinaryData = xhs.m_pBinaryData;
+        m_binarySize = xhs.m_binarySize;
+        m_ownsData = xhs.m_ownsData;
+        m_elfSections = std::move(xhs.m_elfSections);
+        m_isElfSectionIndexBuilt = xhs.m_isElfSectionIndexBuilt;
+        xhs.m_pBinaryData = nullptr;
+        xhs.m_binarySize = 0;
+        xhs.m_ownsData = false;
+        xhs.m_elfSections.clear();
+        xhs.m_isElfSectionIndexBuilt = false;
+    }
 
     return *this;
 }
 #endif
 
+/// -----------------------------------------------------------------------------------------------
+/// releaseBinary
+/// \brief Description: Releases the buffer if it is owned, and forgets the section index
+/// -----------------------------------------------------------------------------------------------
+void KernelBinary::releaseBinary()
+{
+    if ((nullptr != m_pBinaryData) && m_ownsData)
+    {
+        delete[](unsigned char*)m_pBinaryData;
+    }
+
+    m_pBinaryData = nullptr;
+    m_binarySize = 0;
+    m_ownsData = false;
+    m_elfSections.clear();
+    m_isElfSectionIndexBuilt = false;
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// setBinary
 /// \brief Description: Releases the previous buffer and copies the new one over:
@@ -2856,12 +3564,7 @@ KernelBinary& KernelBinary::operator=(KernelBinary&& xhs)
 /// -----------------------------------------------------------------------------------------------
 void KernelBinary::setBinary(const void* pBinaryData, size_t binarySize)
 {
-    if (nullptr != m_pBinaryData)
-    {
-        delete[](unsigned char*)m_pBinaryData;
-        m_pBinaryData = nullptr;
-        m_binarySize = 0;
-    }
+    releaseBinary();
 
     m_binarySize = binarySize;
 
@@ -2873,10 +3576,29 @@ void KernelBinary::setBinary(const void* pBinaryData, size_t binarySize)
         {
             ::memcpy(pBuffer, pBinaryData, m_binarySize);
             m_pBinaryData = (const void*)pBuffer;
+            m_ownsData = true;
         }
     }
 }
 
+/// -----------------------------------------------------------------------------------------------
+/// setBinaryView
+/// \brief Description: Releases the previous buffer and points to the new one, without copying it.
+///                     The caller keeps ownership of the buffer, which must outlive this binary.
+/// \param[in]          pBinaryData
+/// \param[in]          binarySize
+/// -----------------------------------------------------------------------------------------------
+void KernelBinary::setBinaryView(const void* pBinaryData, size_t binarySize)
+{
+    releaseBinary();
+
+    if (nullptr != pBinaryData)
+    {
+        m_pBinaryData = pBinaryData;
+        m_binarySize = binarySize;
+    }
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// isElf32Binary
 /// \brief Description: Checks if the binary is a 32-bit elf (ELF32) format
@@ -2932,7 +3654,8 @@ bool KernelBinary::isElf64Binary() const
 /// \param[in]          offset
 /// \param[in]          size
 /// \param[out]         o_bufferAsBinary
-/// \brief Description: Gets the sub buffer as a binary of itself:
+/// \brief Description: Gets the sub buffer as a binary of itself. The output is a view into this
+///                     binary's buffer, and is valid as long as that buffer is.
 /// \return bool success
 /// -----------------------------------------------------------------------------------------------
 bool KernelBinary::getSubBufferAsBinary(size_t offset, size_t size, KernelBinary& o_bufferAsBinary) const
@@ -2940,10 +3663,10 @@ bool KernelBinary::getSubBufferAsBinary(size_t offset, size_t size, KernelBinary
     bool retVal = false;
 
     // Validate the values:
-    if (offset + size <= m_binarySize)
+    if ((offset <= m_binarySize) && (size <= m_binarySize - offset))
     {
-        // Copy the data:
-        o_bufferAsBinary.setBinary((const void*)((size_t)m_pBinaryData + offset), size);
+        // View the data:
+        o_bufferAsBinary.setBinaryView((const void*)((size_t)m_pBinaryData + offset), size);
         retVal = true;
     }
 
@@ -2972,72 +3695,22 @@ bool KernelBinary::getTrimmedBufferAsBinary(size_t start_trim, size_t end_trim,
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// getElfSectionAsBinary
-/// \param[in]          sectionIndex
-/// \param[out]         o_sectionAsBinary
-/// \brief Description: Extract an ELF section as a binary itself
-/// \return bool success
+/// getElfSectionIndex
+/// \brief Description: Gets the ELF section headers, reading them on the first call. This lets
+///                     section and symbol lookups share a single pass of libelf over the binary.
+/// \return The sections by section index, empty if the binary is not an ELF
 /// -----------------------------------------------------------------------------------------------
-bool KernelBinary::getElfSectionAsBinary(int sectionIndex, KernelBinary& o_sectionAsBinary) const
+const std::vector<KernelBinary::ElfSectionInfo>& KernelBinary::getElfSectionIndex() const
 {
-    bool retVal = false;
-
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
-
-    if (nullptr != pContainerElf)
+    if (m_isElfSectionIndexBuilt)
     {
-        // Iterate the sections:
-        Elf_Scn* pCurrentSection = nullptr;
-
-        for (int i = 0; i < sectionIndex; i++)
-        {
-            pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
-
-            if (nullptr == pCurrentSection)
-            {
-                break;
-            }
-        }
-
-        // If the section exists:
-        if (nullptr != pCurrentSection)
-        {
-            // Get the section's data:
-            Elf_Data* pSectionData = elf_getdata(pCurrentSection, nullptr);
-
-            if (nullptr != pSectionData)
-            {
-                // Copy the values to the output parameter:
-                o_sectionAsBinary.setBinary(pSectionData->d_buf, (size_t)pSectionData->d_size);
-
-                // Report success:
-                retVal = true;
-            }
-        }
+        return m_elfSections;
     }
 
-    return retVal;
-}
-
-/// -----------------------------------------------------------------------------------------------
-/// getElfSectionAsBinary
-/// \param[in]          sectionName
-/// \param[out]         o_sectionAsBinary
-/// \param[out]         o_pSectionLinkIndex
-/// \brief Description: Extract an ELF section as a binary itself
-/// \return bool success
-/// -----------------------------------------------------------------------------------------------
-bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelBinary& o_sectionAsBinary,
-                                         int* o_pSectionLinkIndex) const
-{
-    bool retVal = false;
+    m_isElfSectionIndexBuilt = true;
 
     // Set the version of elf:
-    elf_version(EV_CURRENT);
+    InitializeElfVersion();
 
     // Initialize the binary as ELF from memory:
     Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
@@ -3050,14 +3723,20 @@ bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelB
 
         if ((0 == rcShrstr) && ((size_t)(-1) != sharedStringSectionIndex))
         {
+            // Section index 0 is the null section, which is not returned by elf_nextscn:
+            ElfSectionInfo sectionInfo = { std::string(), 0, 0, 0 };
+            m_elfSections.push_back(sectionInfo);
+
             // Iterate the sections:
             Elf_Scn* pCurrentSection = elf_nextscn(pContainerElf, nullptr);
 
             while (nullptr != pCurrentSection)
             {
                 // Only support ELF32 and ELF64:
-                bool supportedBinaryFormat = false;
                 size_t strOffset = 0;
+                size_t shType = SHT_NULL;
+                size_t shOffset = 0;
+                size_t shSize = 0;
                 size_t shLink = 0;
 
                 if (isElf32Binary())
@@ -3067,10 +3746,11 @@ bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelB
 
                     if (nullptr != pCurrentSectionHeader)
                     {
-                        // Get the name and link if needed:
                         strOffset = pCurrentSectionHeader->sh_name;
+                        shType = pCurrentSectionHeader->sh_type;
+                        shOffset = pCurrentSectionHeader->sh_offset;
+                        shSize = pCurrentSectionHeader->sh_size;
                         shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
                     }
                 }
                 else if (isElf64Binary())
@@ -3080,149 +3760,237 @@ bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelB
 
                     if (nullptr != pCurrentSectionHeader)
                     {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
+                        strOffset = (size_t)pCurrentSectionHeader->sh_name;
+                        shType = (size_t)pCurrentSectionHeader->sh_type;
+                        shOffset = (size_t)pCurrentSectionHeader->sh_offset;
+                        shSize = (size_t)pCurrentSectionHeader->sh_size;
+                        shLink = (size_t)pCurrentSectionHeader->sh_link;
                     }
                 }
 
-                if (supportedBinaryFormat)
+                // Get the current section's name:
+                char* pCurrentSectionName = elf_strptr(pContainerElf, sharedStringSectionIndex, strOffset);
+                sectionInfo.m_name = (nullptr != pCurrentSectionName) ? pCurrentSectionName : "";
+                sectionInfo.m_link = (int)shLink;
+
+                // Sections that occupy no space in the file, or that point outside of it, are empty:
+                if ((SHT_NOBITS != shType) && (shOffset <= m_binarySize) && (shSize <= m_binarySize - shOffset))
+                {
+                    sectionInfo.m_offset = shOffset;
+                    sectionInfo.m_size = shSize;
+                }
+                else
                 {
-                    // Get the current section's name:
-                    char* pCurrentSectionName = elf_strptr(pContainerElf, sharedStringSectionIndex, strOffset);
+                    sectionInfo.m_offset = 0;
+                    sectionInfo.m_size = 0;
+                }
 
-                    if (nullptr != pCurrentSectionName)
-                    {
-                        std::string currentSectionName;
-                        currentSectionName = pCurrentSectionName;
+                m_elfSections.push_back(sectionInfo);
 
-                        if ((!currentSectionName.empty()) && (sectionName == currentSectionName))
-                        {
-                            // Get the section's data:
-                            Elf_Data* pSectionData = elf_getdata(pCurrentSection, nullptr);
+                // Get the next section:
+                pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
+            }
+        }
 
-                            if (nullptr != pSectionData)
-                            {
-                                // Copy the values to the output parameter:
-                                o_sectionAsBinary.setBinary(pSectionData->d_buf, (size_t)pSectionData->d_size);
+        // The index holds all we need, so release the ELF:
+        elf_end(pContainerElf);
+    }
 
-                                // Return the link if requested:
-                                if (nullptr != o_pSectionLinkIndex)
-                                {
-                                    *o_pSectionLinkIndex = (int)shLink;
-                                }
+    return m_elfSections;
+}
 
-                                // Report success:
-                                retVal = true;
-                                break;
-                            }
-                        }
-                    }
-                }
+/// -----------------------------------------------------------------------------------------------
+/// findElfSection
+/// \param[in]          sectionName
+/// \brief Description: Finds the first section with a given name
+/// \return The section, or nullptr if there is no such section
+/// -----------------------------------------------------------------------------------------------
+const KernelBinary::ElfSectionInfo* KernelBinary::findElfSection(const std::string& sectionName) const
+{
+    const ElfSectionInfo* pRetVal = nullptr;
 
-                // Get the next section:
-                pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
+    if (!sectionName.empty())
+    {
+        const std::vector<ElfSectionInfo>& sections = getElfSectionIndex();
+        size_t sectionCount = sections.size();
+
+        for (size_t i = 0; i < sectionCount; ++i)
+        {
+            if (sectionName == sections[i].m_name)
+            {
+                pRetVal = &sections[i];
+                break;
             }
         }
     }
 
+    return pRetVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// getElfSectionAsBinary
+/// \param[in]          sectionIndex
+/// \param[out]         o_sectionAsBinary
+/// \brief Description: Extract an ELF section as a binary itself. The output is a view into this
+///                     binary's buffer, and is valid as long as that buffer is.
+/// \return bool success
+/// -----------------------------------------------------------------------------------------------
+bool KernelBinary::getElfSectionAsBinary(int sectionIndex, KernelBinary& o_sectionAsBinary) const
+{
+    bool retVal = false;
+
+    const std::vector<ElfSectionInfo>& sections = getElfSectionIndex();
+
+    // The null section has no data:
+    if ((0 < sectionIndex) && ((size_t)sectionIndex < sections.size()))
+    {
+        const ElfSectionInfo& section = sections[sectionIndex];
+        retVal = getSubBufferAsBinary(section.m_offset, section.m_size, o_sectionAsBinary);
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// getElfSectionAsBinary
+/// \param[in]          sectionName
+/// \param[out]         o_sectionAsBinary
+/// \param[out]         o_pSectionLinkIndex
+/// \brief Description: Extract an ELF section as a binary itself. The output is a view into this
+///                     binary's buffer, and is valid as long as that buffer is.
+/// \return bool success
+/// -----------------------------------------------------------------------------------------------
+bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelBinary& o_sectionAsBinary,
+                                         int* o_pSectionLinkIndex) const
+{
+    bool retVal = false;
+
+    const ElfSectionInfo* pSection = findElfSection(sectionName);
+
+    if (nullptr != pSection)
+    {
+        retVal = getSubBufferAsBinary(pSection->m_offset, pSection->m_size, o_sectionAsBinary);
+
+        // Return the link if requested:
+        if (retVal && (nullptr != o_pSectionLinkIndex))
+        {
+            *o_pSectionLinkIndex = pSection->m_link;
+        }
+    }
+
     return retVal;
 }
 
+/// -----------------------------------------------------------------------------------------------
+/// GetElfString
+/// \param[in]          stringTable - the string table section
+/// \param[in]          offset - the string offset in the table
+/// \brief Description: Gets a string from an ELF string table section
+/// \return The string, or nullptr if it is not terminated inside the table
+/// -----------------------------------------------------------------------------------------------
+static const char* GetElfString(const KernelBinary& stringTable, size_t offset)
+{
+    const char* pRetVal = nullptr;
+
+    if ((nullptr != stringTable.m_pBinaryData) && (offset < stringTable.m_binarySize))
+    {
+        const char* pString = (const char*)stringTable.m_pBinaryData + offset;
+
+        if (nullptr != ::memchr(pString, 0, stringTable.m_binarySize - offset))
+        {
+            pRetVal = pString;
+        }
+    }
+
+    return pRetVal;
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// getElfSymbolAsBinary
 /// \param[in]          symbol
 /// \param[out]         o_symbolAsBinary
-/// \brief Description: Extract an ELF symbol as a binary itself
+/// \brief Description: Extract an ELF symbol as a binary itself. The output is a view into this
+///                     binary's buffer, and is valid as long as that buffer is.
 /// \return bool success
 /// -----------------------------------------------------------------------------------------------
 bool KernelBinary::getElfSymbolAsBinary(const std::string& symbol, KernelBinary& o_symbolAsBinary) const
 {
     bool retVal = false;
 
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
+    // First get the symbol table section and its string table:
+    KernelBinary symTabSection(nullptr, 0);
+    KernelBinary strTabSection(nullptr, 0);
+    int symbolStringTableIndex = -1;
+    bool rcST = getElfSectionAsBinary(".symtab", symTabSection, &symbolStringTableIndex);
 
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
-
-    if (nullptr != pContainerElf)
+    if (rcST && (0 < symbolStringTableIndex) && getElfSectionAsBinary(symbolStringTableIndex, strTabSection))
     {
-        // First get the symbol table section:
-        KernelBinary symTabSection(nullptr, 0);
-        int symbolStringTableIndex = -1;
-        bool rcST = getElfSectionAsBinary(".symtab", symTabSection, &symbolStringTableIndex);
-
-        if (rcST && (0 < symbolStringTableIndex))
+        if (!symbol.empty())
         {
-            if (!symbol.empty())
+            // Get the symbol data:
+            int sectionIndex = -1;
+            size_t offsetInSection = 0;
+            size_t symbolSize = 0;
+
+            if (isElf32Binary())
             {
-                // Get the symbol data:
-                int sectionIndex = -1;
-                size_t offsetInSection = 0;
-                size_t symbolSize = 0;
+                int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
+                const Elf32_Sym* pCurrentSymbol = (const Elf32_Sym*)symTabSection.m_pBinaryData;
 
-                if (isElf32Binary())
+                for (int i = 0; i < numberOfSymbols; i++)
                 {
-                    int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
-                    Elf32_Sym* pCurrentSymbol = (Elf32_Sym*)symTabSection.m_pBinaryData;
+                    // Get the symbol name as a string:
+                    const char* pCurrentSymbolName = GetElfString(strTabSection, pCurrentSymbol->st_name);
 
-                    for (int i = 0; i < numberOfSymbols; i++)
+                    if ((nullptr != pCurrentSymbolName) && (symbol == pCurrentSymbolName))
                     {
-                        // Get the symbol name as a string:
-                        char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
-
-                        if (symbol == pCurrentSymbolName)
-                        {
-                            // Get the parameters:
-                            sectionIndex = (int)pCurrentSymbol->st_shndx;
-                            offsetInSection = (size_t)pCurrentSymbol->st_value;
-                            symbolSize = (size_t)pCurrentSymbol->st_size;
-
-                            // Stop searching:
-                            break;
-                        }
+                        // Get the parameters:
+                        sectionIndex = (int)pCurrentSymbol->st_shndx;
+                        offsetInSection = (size_t)pCurrentSymbol->st_value;
+                        symbolSize = (size_t)pCurrentSymbol->st_size;
 
-                        // Move the pointer ahead:
-                        pCurrentSymbol++;
+                        // Stop searching:
+                        break;
                     }
+
+                    // Move the pointer ahead:
+                    pCurrentSymbol++;
                 }
-                else if (isElf64Binary())
+            }
+            else if (isElf64Binary())
+            {
+                int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
+                const Elf64_Sym* pCurrentSymbol = (const Elf64_Sym*)symTabSection.m_pBinaryData;
+
+                for (int i = 0; i < numberOfSymbols; i++)
                 {
-                    int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
-                    Elf64_Sym* pCurrentSymbol = (Elf64_Sym*)symTabSection.m_pBinaryData;
+                    // Get the symbol name as a string:
+                    const char* pCurrentSymbolName = GetElfString(strTabSection, pCurrentSymbol->st_name);
 
-                    for (int i = 0; i < numberOfSymbols; i++)
+                    if ((nullptr != pCurrentSymbolName) && (symbol == pCurrentSymbolName))
                     {
-                        // Get the symbol name as a string:
-                        char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
-
-                        if (symbol == pCurrentSymbolName)
-                        {
-                            // Get the parameters:
-                            sectionIndex = (int)pCurrentSymbol->st_shndx;
-                            offsetInSection = (size_t)pCurrentSymbol->st_value;
-                            symbolSize = (size_t)pCurrentSymbol->st_size;
+                        // Get the parameters:
+                        sectionIndex = (int)pCurrentSymbol->st_shndx;
+                        offsetInSection = (size_t)pCurrentSymbol->st_value;
+                        symbolSize = (size_t)pCurrentSymbol->st_size;
 
-                            // Stop searching:
-                            break;
-                        }
-
-                        // Move the pointer ahead:
-                        pCurrentSymbol++;
+                        // Stop searching:
+                        break;
                     }
+
+                    // Move the pointer ahead:
+                    pCurrentSymbol++;
                 }
+            }
 
-                // Get the containing section:
-                KernelBinary containingSection(nullptr, 0);
-                bool rcSc = getElfSectionAsBinary(sectionIndex, containingSection);
+            // Get the containing section:
+            KernelBinary containingSection(nullptr, 0);
+            bool rcSc = getElfSectionAsBinary(sectionIndex, containingSection);
 
-                if (rcSc)
-                {
-                    // Get the data from it:
-                    retVal = containingSection.getSubBufferAsBinary(offsetInSection, symbolSize, o_symbolAsBinary);
-                }
+            if (rcSc)
+            {
+                // Get the data from it:
+                retVal = containingSection.getSubBufferAsBinary(offsetInSection, symbolSize, o_symbolAsBinary);
             }
         }
     }
@@ -3238,156 +4006,224 @@ bool KernelBinary::getElfSymbolAsBinary(const std::string& symbol, KernelBinary&
 /// -----------------------------------------------------------------------------------------------
 void KernelBinary::listELFSectionNames(std::vector<std::string>& o_sectionNames) const
 {
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
+    const std::vector<ElfSectionInfo>& sections = getElfSectionIndex();
+    size_t sectionCount = sections.size();
 
-    if (nullptr != pContainerElf)
+    for (size_t i = 0; i < sectionCount; ++i)
     {
-        // Get the shared strings section:
-        size_t sharedStringSectionIndex = (size_t)(-1);
-        int rcShrstr = elf_getshdrstrndx(pContainerElf, &sharedStringSectionIndex);
+        // If it's not empty, add it to the vector:
+        if (!sections[i].m_name.empty())
+        {
+            o_sectionNames.push_back(sections[i].m_name);
+        }
+    }
+}
 
-        if ((0 == rcShrstr) && ((size_t)(-1) != sharedStringSectionIndex))
+/// -----------------------------------------------------------------------------------------------
+/// listELFSymbolNames
+/// \param[out]         ov_symbolNames
+/// \brief Description: Lists all the ELF symbol names
+/// \return void
+/// -----------------------------------------------------------------------------------------------
+void KernelBinary::listELFSymbolNames(std::vector<std::string>& o_symbolNames) const
+{
+    // First get the symbol table section and its string table:
+    KernelBinary symTabSection(nullptr, 0);
+    KernelBinary strTabSection(nullptr, 0);
+    int symbolStringTableIndex = -1;
+    bool rcST = getElfSectionAsBinary(".symtab", symTabSection, &symbolStringTableIndex);
+
+    if (rcST && (0 < symbolStringTableIndex) && getElfSectionAsBinary(symbolStringTableIndex, strTabSection))
+    {
+        // Get the symbol data:
+        if (isElf32Binary())
         {
-            // Iterate the sections:
-            Elf_Scn* pCurrentSection = elf_nextscn(pContainerElf, nullptr);
+            int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
+            const Elf32_Sym* pCurrentSymbol = (const Elf32_Sym*)symTabSection.m_pBinaryData;
 
-            while (nullptr != pCurrentSection)
+            for (int i = 0; i < numberOfSymbols; i++)
             {
-                // Only support ELF32 and ELF64:
-                bool supportedBinaryFormat = false;
-                size_t strOffset = 0;
-                //size_t shLink = 0;
+                // Get the symbol name as a string:
+                const char* pCurrentSymbolName = GetElfString(strTabSection, pCurrentSymbol->st_name);
 
-                if (isElf32Binary())
+                // If it's not empty, add it to the vector:
+                if ((nullptr != pCurrentSymbolName) && (0 != pCurrentSymbolName[0]))
                 {
-                    // Get the section header:
-                    Elf32_Shdr* pCurrentSectionHeader = elf32_getshdr(pCurrentSection);
-
-                    if (nullptr != pCurrentSectionHeader)
-                    {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        //shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
-                    }
+                    o_symbolNames.push_back(pCurrentSymbolName);
                 }
-                else if (isElf64Binary())
-                {
-                    // Get the section header:
-                    Elf64_Shdr* pCurrentSectionHeader = elf64_getshdr(pCurrentSection);
 
-                    if (nullptr != pCurrentSectionHeader)
-                    {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        //shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
-                    }
-                }
-
-                if (supportedBinaryFormat)
-                {
-                    // Get the current section's name:
-                    char* pCurrentSectionName = elf_strptr(pContainerElf, sharedStringSectionIndex, strOffset);
+                // Move the pointer ahead:
+                pCurrentSymbol++;
+            }
+        }
+        else if (isElf64Binary())
+        {
+            int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
+            const Elf64_Sym* pCurrentSymbol = (const Elf64_Sym*)symTabSection.m_pBinaryData;
 
-                    if (nullptr != pCurrentSectionName)
-                    {
-                        // If it's not empty, add it to the vector:
-                        std::string currentSectionName;
-                        currentSectionName = pCurrentSectionName;
+            for (int i = 0; i < numberOfSymbols; i++)
+            {
+                // Get the symbol name as a string:
+                const char* pCurrentSymbolName = GetElfString(strTabSection, pCurrentSymbol->st_name);
 
-                        if (!currentSectionName.empty())
-                        {
-                            o_sectionNames.push_back(currentSectionName);
-                        }
-                    }
+                // If it's not empty, add it to the vector:
+                if ((nullptr != pCurrentSymbolName) && (0 != pCurrentSymbolName[0]))
+                {
+                    o_symbolNames.push_back(pCurrentSymbolName);
                 }
 
-                // Get the next section:
-                pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
+                // Move the pointer ahead:
+                pCurrentSymbol++;
             }
         }
     }
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// listELFSymbolNames
-/// \param[out]         ov_symbolNames
-/// \brief Description: Lists all the ELF symbol names
-/// \return void
+/// CopyElfSections
+/// \brief Description: Builds an ELF image from the ELF header, the kept sections' data and the
+///                     section headers of a binary. The other sections keep their headers, so the
+///                     section indices do not change, but become SHT_NOBITS and take no space.
+/// \param[in]          pBinary - the ELF binary
+/// \param[in]          binarySize - its size
+/// \param[in,out]      io_keepSection - the sections to keep, by section index. The section name
+///                     table, symbol tables and their string tables are added to it
+/// \param[out]         o_image - the new ELF image
+/// \return bool success
 /// -----------------------------------------------------------------------------------------------
-void KernelBinary::listELFSymbolNames(std::vector<std::string>& o_symbolNames) const
+template <typename ElfEhdr, typename ElfShdr>
+static bool CopyElfSections(const unsigned char* pBinary, size_t binarySize, std::vector<bool>& io_keepSection, std::vector<unsigned char>& o_image)
 {
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
+    bool retVal = false;
 
-    if (nullptr != pContainerElf)
+    if (sizeof(ElfEhdr) <= binarySize)
     {
-        // First get the symbol table section:
-        KernelBinary symTabSection(nullptr, 0);
-        int symbolStringTableIndex = -1;
-        bool rcST = getElfSectionAsBinary(".symtab", symTabSection, &symbolStringTableIndex);
+        ElfEhdr elfHeader;
+        ::memcpy(&elfHeader, pBinary, sizeof(ElfEhdr));
+        size_t sectionCount = (size_t)elfHeader.e_shnum;
+        size_t headersOffset = (size_t)elfHeader.e_shoff;
+
+        // Extended section numbering is not supported:
+        retVal = (0 < sectionCount) && (io_keepSection.size() == sectionCount) &&
+                 (sizeof(ElfShdr) == elfHeader.e_shentsize) && ((size_t)elfHeader.e_shstrndx < sectionCount) &&
+                 (headersOffset <= binarySize) && (sectionCount <= (binarySize - headersOffset) / sizeof(ElfShdr));
 
-        if (rcST && (0 < symbolStringTableIndex))
+        if (retVal)
         {
-            // Get the symbol data:
-            if (isElf32Binary())
-            {
-                int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
-                Elf32_Sym* pCurrentSymbol = (Elf32_Sym*)symTabSection.m_pBinaryData;
+            std::vector<ElfShdr> sectionHeaders(sectionCount);
+            ::memcpy(&sectionHeaders[0], pBinary + headersOffset, sectionCount * sizeof(ElfShdr));
 
-                for (int i = 0; i < numberOfSymbols; i++)
+            // libelf needs the section names, and libdwarf the symbols to relocate the DWARF sections with:
+            io_keepSection[elfHeader.e_shstrndx] = true;
+
+            for (size_t i = 1; i < sectionCount; ++i)
+            {
+                if (SHT_SYMTAB == sectionHeaders[i].sh_type)
                 {
-                    // Get the symbol name as a string:
-                    char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
+                    io_keepSection[i] = true;
 
-                    if (nullptr != pCurrentSymbolName)
+                    if ((size_t)sectionHeaders[i].sh_link < sectionCount)
                     {
-                        // If it's not empty, add it to the vector:
-                        std::string currentSymbolName = pCurrentSymbolName;
-
-                        if (!currentSymbolName.empty())
-                        {
-                            o_symbolNames.push_back(currentSymbolName);
-                        }
+                        io_keepSection[sectionHeaders[i].sh_link] = true;
                     }
-
-                    // Move the pointer ahead:
-                    pCurrentSymbol++;
                 }
             }
-            else if (isElf64Binary())
+
+            // Lay out the kept sections after the ELF header, then the section headers:
+            size_t imageSize = sizeof(ElfEhdr);
+            std::vector<size_t> sourceOffsets(sectionCount, 0);
+
+            for (size_t i = 1; retVal && (i < sectionCount); ++i)
             {
-                int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
-                Elf64_Sym* pCurrentSymbol = (Elf64_Sym*)symTabSection.m_pBinaryData;
+                ElfShdr& sectionHeader = sectionHeaders[i];
 
-                for (int i = 0; i < numberOfSymbols; i++)
+                if (!io_keepSection[i])
                 {
-                    // Get the symbol name as a string:
-                    char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
+                    sectionHeader.sh_type = SHT_NOBITS;
+                    sectionHeader.sh_offset = 0;
+                }
+                else if (SHT_NOBITS != sectionHeader.sh_type)
+                {
+                    size_t sectionOffset = (size_t)sectionHeader.sh_offset;
+                    size_t sectionSize = (size_t)sectionHeader.sh_size;
+                    size_t sectionAlignment = (1 < sectionHeader.sh_addralign) ? (size_t)sectionHeader.sh_addralign : 1;
+                    retVal = (sectionOffset <= binarySize) && (sectionSize <= binarySize - sectionOffset);
+
+                    sourceOffsets[i] = sectionOffset;
+                    imageSize = (imageSize + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+                    sectionHeader.sh_offset = imageSize;
+                    imageSize += sectionSize;
+                }
+            }
 
-                    if (nullptr != pCurrentSymbolName)
-                    {
-                        // If it's not empty, add it to the vector:
-                        std::string currentSymbolName = pCurrentSymbolName;
+            if (retVal)
+            {
+                // Both ELF classes' section headers are at most 8-aligned:
+                imageSize = (imageSize + 7) / 8 * 8;
+                elfHeader.e_shoff = imageSize;
+                elfHeader.e_phoff = 0;
+                elfHeader.e_phnum = 0;
 
-                        if (!currentSymbolName.empty())
-                        {
-                            o_symbolNames.push_back(currentSymbolName);
-                        }
-                    }
+                o_image.assign(imageSize + sectionCount * sizeof(ElfShdr), 0);
+                ::memcpy(&o_image[0], &elfHeader, sizeof(ElfEhdr));
 
-                    // Move the pointer ahead:
-                    pCurrentSymbol++;
+                for (size_t i = 1; i < sectionCount; ++i)
+                {
+                    if (io_keepSection[i] && (SHT_NOBITS != sectionHeaders[i].sh_type))
+                    {
+                        ::memcpy(&o_image[sectionHeaders[i].sh_offset], pBinary + sourceOffsets[i], (size_t)sectionHeaders[i].sh_size);
+                    }
                 }
+
+                ::memcpy(&o_image[imageSize], &sectionHeaders[0], sectionCount * sizeof(ElfShdr));
             }
         }
     }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// getElfDebugSectionsAsBinary
+/// \param[out]         o_debugSectionsAsBinary
+/// \brief Description: Copies the DWARF sections, their relocations and what libelf and libdwarf
+///                     need to open them into a new ELF binary. Unlike the section and symbol
+///                     getters, the output owns its buffer. Section indices and offsets inside the
+///                     DWARF sections are the same as in this binary.
+/// \return bool success
+/// -----------------------------------------------------------------------------------------------
+bool KernelBinary::getElfDebugSectionsAsBinary(KernelBinary& o_debugSectionsAsBinary) const
+{
+    bool retVal = false;
+
+    const std::vector<ElfSectionInfo>& sections = getElfSectionIndex();
+    size_t sectionCount = sections.size();
+    std::vector<bool> keepSection(sectionCount, false);
+
+    for (size_t i = 0; i < sectionCount; ++i)
+    {
+        const std::string& sectionName = sections[i].m_name;
+        keepSection[i] = (0 == sectionName.compare(0, 7, ".debug_")) ||
+                         (0 == sectionName.compare(0, 11, ".rel.debug_")) ||
+                         (0 == sectionName.compare(0, 12, ".rela.debug_"));
+    }
+
+    std::vector<unsigned char> image;
+
+    if (isElf32Binary())
+    {
+        retVal = CopyElfSections<Elf32_Ehdr, Elf32_Shdr>((const unsigned char*)m_pBinaryData, m_binarySize, keepSection, image);
+    }
+    else if (isElf64Binary())
+    {
+        retVal = CopyElfSections<Elf64_Ehdr, Elf64_Shdr>((const unsigned char*)m_pBinaryData, m_binarySize, keepSection, image);
+    }
+
+    if (retVal)
+    {
+        o_debugSectionsAsBinary.setBinary(&image[0], image.size());
+        retVal = (nullptr != o_debugSectionsAsBinary.m_pBinaryData);
+    }
+
+    return retVal;
 }
@@ -41,12 +41,15 @@ typedef HwDbgUInt64 DwarfAddrType;
 
 /// -----------------------------------------------------------------------------------------------
 /// \struct KernelBinary
-/// \brief Description: A simple structure for holding a chunk of memory and its size
+/// \brief Description: A simple structure for holding a chunk of memory and its size.
+///                     A binary either owns a copy of its data, or is a view of memory owned by
+///                     someone else, which must outlive it. Sub-buffers, sections and symbols
+///                     are always returned as views into their parent binary.
 /// -----------------------------------------------------------------------------------------------
 struct DBGINF_API KernelBinary
 {
 public:
-    KernelBinary(const void* pBinaryData, size_t binarySize);
+    KernelBinary(const void* pBinaryData, size_t binarySize, bool copyData = true);
     KernelBinary(const KernelBinary& other);
     ~KernelBinary();
 
@@ -59,6 +62,10 @@ public:
 #endif
 
     void setBinary(const void* pBinaryData, size_t binarySize);
+    /// Point to a buffer without copying it:
+    void setBinaryView(const void* pBinaryData, size_t binarySize);
+    /// Does this binary own its buffer:
+    bool ownsData() const { return m_ownsData; };
 
     /// Check conformance to ELF classes:
     bool isElf32Binary() const;
@@ -75,6 +82,8 @@ public:
     bool getElfSectionAsBinary(const std::string& sectionName, KernelBinary& o_sectionAsBinary, int* o_pSectionLinkIndex = nullptr) const;
     /// Extract an ELF symbol as a binary itself:
     bool getElfSymbolAsBinary(const std::string& symbol, KernelBinary& o_symbolAsBinary) const;
+    /// Copy the DWARF sections into a new ELF binary, which owns its buffer:
+    bool getElfDebugSectionsAsBinary(KernelBinary& o_debugSectionsAsBinary) const;
 
     /// List the section names:
     void listELFSectionNames(std::vector<std::string>& o_sectionNames) const;
@@ -83,6 +92,25 @@ public:
 
     const void* m_pBinaryData; ///< A buffer containing the elf binary data
     size_t m_binarySize; ///< The size of the buffer
+
+private:
+    /// An ELF section header, as needed to find and view the section
+    struct ElfSectionInfo
+    {
+        std::string m_name; ///< The section name
+        size_t m_offset;    ///< The offset of the section data in the binary
+        size_t m_size;      ///< The size of the section data, 0 for sections without data
+        int m_link;         ///< The sh_link of the section
+    };
+
+    void releaseBinary();
+    const std::vector<ElfSectionInfo>& getElfSectionIndex() const;
+    const ElfSectionInfo* findElfSection(const std::string& sectionName) const;
+
+    bool m_ownsData; ///< Is m_pBinaryData allocated by this binary
+    /// The ELF sections, by section index, filled on first use. Offsets are relative, so copies can share it:
+    mutable std::vector<ElfSectionInfo> m_elfSections;
+    mutable bool m_isElfSectionIndexBuilt;
 };
 
 /// -----------------------------------------------------------------------------------------------
@@ -168,6 +196,32 @@ public:
     */
 };
 
+/// -----------------------------------------------------------------------------------------------
+/// \struct DwarfDeferredVariables
+/// \brief Description: Keeps the DWARF of a parsed binary open, so that the variables of each code
+///                     scope can be read the first time they are requested instead of up front
+/// -----------------------------------------------------------------------------------------------
+struct DBGINF_API DwarfDeferredVariables
+{
+public:
+    DwarfDeferredVariables();
+    ~DwarfDeferredVariables();
+
+    /// Close the DWARF and release the binary:
+    void Release();
+
+    KernelBinary m_binary;  ///< A copy of the parsed binary's DWARF sections, which the DWARF reads from
+    Elf* m_pElf;            ///< The ELF opened on m_binary
+    Dwarf_Debug m_pDwarf;   ///< The DWARF opened on m_pElf
+    std::vector<Dwarf_Unsigned> m_cuEndOffsets; ///< The end offset of each compilation unit in m_pDwarf, in offset order
+    size_t m_nextCU;        ///< The unit m_pDwarf's next dwarf_next_cu_header call returns
+
+private:
+    /// Disallow copying, the scopes point to this object:
+    DwarfDeferredVariables(const DwarfDeferredVariables& other);
+    DwarfDeferredVariables& operator=(const DwarfDeferredVariables& other);
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /// \class DbgInfoDwarfParser
 /// \brief Description: Used to convert Dwarf to DbgInfo Structures, all methods are static, this class should only be used to parse the data
@@ -194,11 +248,30 @@ public:
     typedef HwDbgInfo_indirection DwarfVariableIndirectionType;
     //@}
     /// The main function - fills the scope and line mapping from the binary, the filepath, if provided, is the path to the file from which the source was taken
-    static bool InitializeWithBinary(const KernelBinary& kernelBinary, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping, const std::string& firstSourceFileRealPath = "");
+    /// A single compilation unit is the top scope. Several compilation units are parsed concurrently and become the children of a global scope.
+    /// If o_pDeferredVariables is given, the line mapping and scope tree are filled, but each scope's variables are only read when first requested.
+    /// o_pDeferredVariables must then outlive o_scope.
+    static bool InitializeWithBinary(const KernelBinary& kernelBinary, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping, const std::string& firstSourceFileRealPath = "",
+                                     DwarfDeferredVariables* o_pDeferredVariables = nullptr);
     /// Given a scope, return all the locations of the variables whose type is REGISTER in the scope
     static bool ListVariableRegisterLocations(const DwarfCodeScope* pTopScope, std::vector<DwarfAddrType>& variableLocations);
 
 private:
+    /// The work shared by the threads parsing the compilation units of a binary
+    struct CompilationUnitsParseState;
+
+    /// Makes the compilation unit containing a DIE the current one
+    static bool SelectCompilationUnit(Dwarf_Debug pDwarf, const std::vector<Dwarf_Unsigned>& cuEndOffsets, size_t& io_nextCU, Dwarf_Off dieOffset);
+    /// Lists the DIE and end offsets of the compilation units in the DWARF
+    static void ListCompilationUnits(Dwarf_Debug pDwarf, std::vector<Dwarf_Off>& o_cuDIEOffsets, std::vector<Dwarf_Unsigned>& o_cuEndOffsets);
+    /// Fills the scope and line mapping of one compilation unit from DWARF
+    static bool FillCompilationUnitFromDwarf(Dwarf_Off cuDIEOffset, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, const std::vector<Dwarf_Unsigned>& cuEndOffsets, size_t& io_nextCU,
+                                             DwarfDeferredVariables* pDeferredVariables, DwarfCodeScope* pParentScope, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping);
+    /// Fills several compilation units on worker threads, then merges them under a global scope
+    static bool FillCompilationUnitsInParallel(const KernelBinary& kernelBinary, const std::vector<Dwarf_Off>& cuDIEOffsets, const std::vector<Dwarf_Unsigned>& cuEndOffsets, const std::string& firstSourceFileRealPath,
+                                               DwarfDeferredVariables* pDeferredVariables, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping);
+    /// Worker thread function, fills compilation units until none are left
+    static void FillCompilationUnitsWorker(CompilationUnitsParseState* pState);
     /// Fills the variable info from DWARF, also returns a vector of additional location in case of several instances of the variable
     static void FillVariableWithInformationFromDIE(Dwarf_Die variableDIE, Dwarf_Debug pDwarf, bool isMember, DwarfVariableInfo& o_variableData, std::vector<DwarfVariableLocation>& o_variableAdditionalLocations);
     /// Fills various fields of a variable
@@ -206,7 +279,7 @@ private:
     /// Fills the LineNumberMapping from DWARF
     static bool FillLineMappingFromDwarf(Dwarf_Die cuDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfLineMapping& o_lineNumberMapping);
     /// Fills the Scope from DWARF
-    static void FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope* pParentScope, const DwarfCodeScopeType& scopeType, DwarfCodeScope& o_scope);
+    static void FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfDeferredVariables* pDeferredVariables, DwarfCodeScope* pParentScope, const DwarfCodeScopeType& scopeType, DwarfCodeScope& o_scope);
     /// Fills the address ranges from DWARF
     static void FillAddressRanges(Dwarf_Die programDIE, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
     /// Fills the scope name from DWARF
@@ -216,11 +289,17 @@ private:
     /// Fills the FrameBase - which is the base variable location of the scope - from DWARF
     static void FillFrameBase(Dwarf_Die programDIE, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
     /// Fill the scope data from the referenced DIE.
-    static void FillCodeScopeFromDwarfRef(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
+    static void FillCodeScopeFromDwarfRef(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfDeferredVariables* pDeferredVariables, DwarfCodeScope& o_scope);
     /// In case this is an inlined function, fill the Inlined data which is the line in which the function is defined, from DWARF
     static void FillInlinedFunctionData(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
     /// Fills the child scopes recursively
-    static void FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
+    static void FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfDeferredVariables* pDeferredVariables, DwarfCodeScope& o_scope);
+    /// Fills the child variables of a DIE into a scope
+    static void FillChildVariables(Dwarf_Die programDIE, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
+    /// Adds a variable DIE to a scope
+    static void AddChildVariable(Dwarf_Die childDIE, Dwarf_Half childTag, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
+    /// Fills the deferred variables of a scope, used as the scope's variables loader
+    static void LoadDeferredVariables(DwarfCodeScope& io_scope, void* pLoaderData);
     /// Fills the Indirection of a variable from DWARF
     static void FillVarIndirectionDetails(Dwarf_Die variableDIE, DwarfVariableInfo& o_variable);
     /// Fills the Encoding of a variable from DWARF
@@ -232,7 +311,7 @@ private:
     /// Create the name of a variable from type from DWARF
     static void CreateVarNameFromType(Dwarf_Die typeDIE, DwarfVariableInfo& o_variable);
     /// Add a child scope from DWARF
-    static void AddChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope);
+    static void AddChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfDeferredVariables* pDeferredVariables, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope);
     /// Get the variable type from DWARF
     static void GetVariableValueTypeFromTAG(int dwarfTAG, bool& isConst, bool& isParam);
     /// Get the scope type from DWARF tag
@@ -87,6 +87,10 @@ public:
     virtual bool ListVariablesFromAddress(const AddrType& addr, int stackFrameDepth, bool finalMembers, std::vector<std::string>& o_variableNames) const = 0;
     /// Gets the stack depth of a given address, counting containing inlined/non inlined functions scopes
     virtual int GetAddressStackDepth(const AddrType& addr) const = 0;
+    /// Loads everything that is otherwise read on first use. Afterwards the const functions do not modify the consumer or its data, and may be called concurrently from several threads
+    virtual void Freeze() = 0;
+    /// Returns true if \a Freeze was called
+    virtual bool IsFrozen() const = 0;
 
 public:
     /// Variable matching function for the name field:
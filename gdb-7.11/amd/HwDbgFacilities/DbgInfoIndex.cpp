@@ -0,0 +1,781 @@
+//==============================================================================
+// Copyright (c) 2016-2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief Description: Serialized index of parsed debug information
+//==============================================================================
+#include "DbgInfoIndex.h"
+
+using namespace HwDbg;
+
+/// -----------------------------------------------------------------------------------------------
+/// DbgInfoIndexChecksum
+/// \brief Description: Computes a 64-bit FNV-1a hash of a buffer
+/// \param[in]          pData - the buffer
+/// \param[in]          dataSize - the buffer size
+/// \return The hash
+/// -----------------------------------------------------------------------------------------------
+HwDbgUInt64 HwDbg::DbgInfoIndexChecksum(const void* pData, size_t dataSize)
+{
+    const unsigned char* pBytes = (const unsigned char*)pData;
+    HwDbgUInt64 retVal = 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0; i < dataSize; i++)
+    {
+        retVal ^= (HwDbgUInt64)pBytes[i];
+        retVal *= 0x100000001B3ULL;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ListCodeScopesInOrder
+/// \brief Description: Adds a scope and its descendants in the order they are written to the index
+/// \param[in]          scope - the scope
+/// \param[in,out]      io_scopes - the vector to add to
+/// -----------------------------------------------------------------------------------------------
+static void ListCodeScopesInOrder(const DbgInfoDwarfParser::DwarfCodeScope& scope, std::vector<const DbgInfoDwarfParser::DwarfCodeScope*>& io_scopes)
+{
+    io_scopes.push_back(&scope);
+    int numberOfChildScopes = (int)scope.m_children.size();
+
+    for (int i = 0; i < numberOfChildScopes; i++)
+    {
+        if (nullptr != scope.m_children[i])
+        {
+            ListCodeScopesInOrder(*scope.m_children[i], io_scopes);
+        }
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteUInt32
+/// \brief Description: Appends a 32-bit value
+/// \param[in]          value - the value
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteUInt32(unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        m_buffer.push_back((unsigned char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteUInt64
+/// \brief Description: Appends a 64-bit value
+/// \param[in]          value - the value
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteUInt64(HwDbgUInt64 value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        m_buffer.push_back((unsigned char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteBytes
+/// \brief Description: Appends a raw buffer, its size is not written
+/// \param[in]          pData - the buffer
+/// \param[in]          dataSize - the buffer size
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteBytes(const void* pData, size_t dataSize)
+{
+    if ((nullptr != pData) && (0 < dataSize))
+    {
+        const unsigned char* pBytes = (const unsigned char*)pData;
+        m_buffer.insert(m_buffer.end(), pBytes, pBytes + dataSize);
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteString
+/// \brief Description: Appends a string, preceded by its length
+/// \param[in]          str - the string
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteString(const std::string& str)
+{
+    WriteUInt32((unsigned int)str.length());
+    WriteBytes(str.c_str(), str.length());
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteLineMapping
+/// \brief Description: Appends the mappings of a line table. They are written in the order they
+///                     were added, so the reader reproduces the order of the mapped lines as well.
+/// \param[in]          lineMapping - the line table
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteLineMapping(const DbgInfoDwarfParser::DwarfLineMapping& lineMapping)
+{
+    std::vector<DwarfAddrType> addresses;
+    lineMapping.GetMappedAddresses(addresses);
+    int numberOfAddresses = (int)addresses.size();
+
+    WriteUInt32((unsigned int)numberOfAddresses);
+
+    for (int i = 0; i < numberOfAddresses; i++)
+    {
+        FileLocation line;
+        bool rcLn = lineMapping.GetLineFromAddress(addresses[i], line);
+        HWDBG_ASSERT(rcLn);
+
+        WriteUInt64(addresses[i]);
+        WriteFileLocation(line);
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteCodeScope
+/// \brief Description: Appends a scope, its address cache, its variables and, recursively, its
+///                     children. The address index is written separately by \a WriteAddressIndex.
+/// \param[in]          scope - the scope
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteCodeScope(const DbgInfoDwarfParser::DwarfCodeScope& scope)
+{
+    WriteUInt32((unsigned int)scope.m_scopeType);
+    WriteString(scope.m_scopeName);
+
+    WriteUInt32((nullptr != scope.m_pFrameBase) ? 1 : 0);
+
+    if (nullptr != scope.m_pFrameBase)
+    {
+        WriteVariableLocation(*scope.m_pFrameBase);
+    }
+
+    WriteUInt32((nullptr != scope.m_pWorkitemOffset) ? 1 : 0);
+
+    if (nullptr != scope.m_pWorkitemOffset)
+    {
+        WriteVariableLocation(*scope.m_pWorkitemOffset);
+    }
+
+    WriteUInt32(scope.m_isKernel ? 1 : 0);
+    WriteUInt32(scope.m_scopeHasNonTrivialAddressRanges ? 1 : 0);
+
+    int numberOfRanges = (int)scope.m_scopeAddressRanges.size();
+    WriteUInt32((unsigned int)numberOfRanges);
+
+    for (int i = 0; i < numberOfRanges; i++)
+    {
+        WriteUInt64(scope.m_scopeAddressRanges[i].m_minAddr);
+        WriteUInt64(scope.m_scopeAddressRanges[i].m_maxAddr);
+    }
+
+    int numberOfCachedAddrs = (int)scope.m_addressCache.size();
+    WriteUInt32((unsigned int)numberOfCachedAddrs);
+
+    for (int i = 0; i < numberOfCachedAddrs; i++)
+    {
+        WriteUInt64(scope.m_addressCache[i]);
+    }
+
+    WriteFileLocation(scope.m_inlineInfo.m_inlinedAt);
+
+    // The index holds all the variables, so they are read from the DWARF now if they were deferred:
+    const std::vector<DbgInfoDwarfParser::DwarfVariableInfo*>& scopeVars = scope.GetScopeVariables();
+    int numberOfVariables = 0;
+    int numberOfScopeVars = (int)scopeVars.size();
+
+    for (int i = 0; i < numberOfScopeVars; i++)
+    {
+        numberOfVariables += (nullptr != scopeVars[i]) ? 1 : 0;
+    }
+
+    WriteUInt32((unsigned int)numberOfVariables);
+
+    for (int i = 0; i < numberOfScopeVars; i++)
+    {
+        if (nullptr != scopeVars[i])
+        {
+            WriteVariable(*scopeVars[i]);
+        }
+    }
+
+    int numberOfChildren = 0;
+    int numberOfChildScopes = (int)scope.m_children.size();
+
+    for (int i = 0; i < numberOfChildScopes; i++)
+    {
+        numberOfChildren += (nullptr != scope.m_children[i]) ? 1 : 0;
+    }
+
+    WriteUInt32((unsigned int)numberOfChildren);
+
+    for (int i = 0; i < numberOfChildScopes; i++)
+    {
+        if (nullptr != scope.m_children[i])
+        {
+            WriteCodeScope(*scope.m_children[i]);
+        }
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteAddressIndex
+/// \brief Description: Appends the address index of a scope tree. Each interval's scope is written
+///                     as its number in the order \a WriteCodeScope writes the scopes, starting at
+///                     1 for the top scope, or 0 if no scope contains the interval.
+/// \param[in]          topScope - the top scope of the tree, as passed to \a WriteCodeScope
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteAddressIndex(const DbgInfoDwarfParser::DwarfCodeScope& topScope)
+{
+    std::vector<const DbgInfoDwarfParser::DwarfCodeScope*> scopesInOrder(1, nullptr);
+    ListCodeScopesInOrder(topScope, scopesInOrder);
+
+    std::map<const DbgInfoDwarfParser::DwarfCodeScope*, unsigned int> scopeNumbers;
+    unsigned int numberOfScopes = (unsigned int)scopesInOrder.size();
+
+    for (unsigned int i = 0; i < numberOfScopes; i++)
+    {
+        scopeNumbers[scopesInOrder[i]] = i;
+    }
+
+    std::vector<DwarfAddrType> intervalStarts;
+    std::vector<const DbgInfoDwarfParser::DwarfCodeScope*> intervalScopes;
+    bool isIndexBuilt = topScope.GetAddressIndex(intervalStarts, intervalScopes);
+    int numberOfIntervals = isIndexBuilt ? (int)intervalStarts.size() : 0;
+
+    WriteUInt32(isIndexBuilt ? 1 : 0);
+    WriteUInt32((unsigned int)numberOfIntervals);
+
+    for (int i = 0; i < numberOfIntervals; i++)
+    {
+        std::map<const DbgInfoDwarfParser::DwarfCodeScope*, unsigned int>::const_iterator findIter = scopeNumbers.find(intervalScopes[i]);
+        HWDBG_ASSERT(scopeNumbers.end() != findIter);
+
+        WriteUInt64(intervalStarts[i]);
+        WriteUInt32((scopeNumbers.end() != findIter) ? findIter->second : 0);
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteFileLocation
+/// \brief Description: Appends a file location. The path is written in full on its first use,
+///                     and as the index of that first use afterwards.
+/// \param[in]          fileLocation - the file location
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteFileLocation(const FileLocation& fileLocation)
+{
+    std::string fullPath = (nullptr != fileLocation.fullPath()) ? fileLocation.fullPath() : "";
+    std::map<std::string, unsigned int>::const_iterator findIter = m_writtenPaths.find(fullPath);
+
+    if (m_writtenPaths.end() != findIter)
+    {
+        WriteUInt32(findIter->second);
+    }
+    else
+    {
+        // A new path gets the next index, which tells the reader the path follows:
+        unsigned int pathIndex = (unsigned int)m_writtenPaths.size();
+        m_writtenPaths[fullPath] = pathIndex;
+        WriteUInt32(pathIndex);
+        WriteString(fullPath);
+    }
+
+    WriteUInt64(fileLocation.m_lineNum);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteVariableLocation
+/// \brief Description: Appends a variable location
+/// \param[in]          location - the location
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteVariableLocation(const DwarfVariableLocation& location)
+{
+    WriteUInt32((unsigned int)location.m_locationRegister);
+    WriteUInt32(location.m_registerNumber);
+    WriteUInt32(location.m_shouldDerefValue ? 1 : 0);
+    WriteUInt32(location.m_locationOffset);
+    WriteUInt64(location.m_locationResource);
+    WriteUInt32(location.m_isaMemoryRegion);
+    WriteUInt32(location.m_pieceOffset);
+    WriteUInt32(location.m_pieceSize);
+    WriteUInt32((unsigned int)location.m_constAddition);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// WriteVariable
+/// \brief Description: Appends a variable and, recursively, its members
+/// \param[in]          variable - the variable
+/// -----------------------------------------------------------------------------------------------
+void DbgInfoIndexWriter::WriteVariable(const DbgInfoDwarfParser::DwarfVariableInfo& variable)
+{
+    WriteString(variable.m_varName);
+    WriteString(variable.m_typeName);
+    WriteUInt64(variable.m_varSize);
+    WriteUInt32(variable.m_varEncoding);
+    WriteUInt32(variable.IsConst() ? 1 : 0);
+
+    if (variable.IsConst())
+    {
+        // Constant values are m_varSize bytes long, as when variables are copied:
+        WriteBytes(variable.m_varValue.m_varConstantValue, (size_t)variable.m_varSize);
+    }
+    else
+    {
+        WriteVariableLocation(variable.m_varValue.m_varValueLocation);
+    }
+
+    WriteUInt32((unsigned int)variable.m_varIndirection);
+    WriteUInt32(variable.m_varIndirectionDetail);
+    WriteUInt64(variable.m_lowVariablePC);
+    WriteUInt64(variable.m_highVariablePC);
+    WriteUInt32(variable.m_isParam ? 1 : 0);
+    WriteUInt32(variable.m_isOutParam ? 1 : 0);
+    WriteUInt32(variable.m_brigOffset);
+
+    int numberOfMembers = (int)variable.m_varMembers.size();
+    WriteUInt32((unsigned int)numberOfMembers);
+
+    for (int i = 0; i < numberOfMembers; i++)
+    {
+        WriteVariable(variable.m_varMembers[i]);
+    }
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Consume
+/// \brief Description: Advances past the next bytes of the buffer
+/// \param[in]          dataSize - the number of bytes
+/// \return The first byte, nullptr if the buffer is too short or a previous read failed
+/// -----------------------------------------------------------------------------------------------
+const unsigned char* DbgInfoIndexReader::Consume(size_t dataSize)
+{
+    const unsigned char* pRetVal = nullptr;
+
+    if (m_isValid && (dataSize <= (m_dataSize - m_position)))
+    {
+        pRetVal = m_pData + m_position;
+        m_position += dataSize;
+    }
+    else
+    {
+        m_isValid = false;
+    }
+
+    return pRetVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadUInt32
+/// \brief Description: Reads a 32-bit value
+/// \param[out]         o_value - the value
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadUInt32(unsigned int& o_value)
+{
+    const unsigned char* pBytes = Consume(4);
+
+    if (nullptr != pBytes)
+    {
+        o_value = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            o_value |= ((unsigned int)pBytes[i]) << (8 * i);
+        }
+    }
+
+    return (nullptr != pBytes);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadUInt64
+/// \brief Description: Reads a 64-bit value
+/// \param[out]         o_value - the value
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadUInt64(HwDbgUInt64& o_value)
+{
+    const unsigned char* pBytes = Consume(8);
+
+    if (nullptr != pBytes)
+    {
+        o_value = 0;
+
+        for (int i = 0; i < 8; i++)
+        {
+            o_value |= ((HwDbgUInt64)pBytes[i]) << (8 * i);
+        }
+    }
+
+    return (nullptr != pBytes);
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadBool
+/// \brief Description: Reads a boolean, written as a 32-bit 0 or 1
+/// \param[out]         o_value - the value
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadBool(bool& o_value)
+{
+    unsigned int value = 0;
+    bool retVal = ReadUInt32(value) && (1 >= value);
+
+    if (retVal)
+    {
+        o_value = (1 == value);
+    }
+    else
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadString
+/// \brief Description: Reads a string, preceded by its length
+/// \param[out]         o_str - the string
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadString(std::string& o_str)
+{
+    bool retVal = false;
+    unsigned int strLength = 0;
+
+    if (ReadUInt32(strLength))
+    {
+        const unsigned char* pChars = Consume(strLength);
+
+        if (nullptr != pChars)
+        {
+            o_str.assign((const char*)pChars, strLength);
+            retVal = true;
+        }
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadLineMapping
+/// \brief Description: Reads a line table and freezes it
+/// \param[out]         o_lineMapping - the line table, expected to be empty
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadLineMapping(DbgInfoDwarfParser::DwarfLineMapping& o_lineMapping)
+{
+    unsigned int numberOfAddresses = 0;
+    bool retVal = ReadUInt32(numberOfAddresses);
+
+    for (unsigned int i = 0; retVal && (i < numberOfAddresses); i++)
+    {
+        DwarfAddrType addr = 0;
+        FileLocation line;
+        retVal = ReadUInt64(addr) && ReadFileLocation(line) && o_lineMapping.AddLineMapping(line, addr);
+    }
+
+    if (retVal)
+    {
+        o_lineMapping.Freeze();
+    }
+    else
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadCodeScope
+/// \brief Description: Reads a scope, its variables and, recursively, its children
+/// \param[out]         o_scope - the scope, expected to be empty. Its children and variables are
+///                     added as they are read, so the scope owns them even if the read fails.
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadCodeScope(DbgInfoDwarfParser::DwarfCodeScope& o_scope)
+{
+    unsigned int scopeType = 0;
+    bool hasFrameBase = false;
+    bool hasWorkitemOffset = false;
+    bool retVal = ReadUInt32(scopeType) && ((unsigned int)DbgInfoDwarfParser::DwarfCodeScope::DID_SCT_HSA_ARGUMENT_SCOPE >= scopeType) &&
+                  ReadString(o_scope.m_scopeName) && ReadBool(hasFrameBase);
+
+    if (retVal)
+    {
+        o_scope.m_scopeType = (DbgInfoDwarfParser::DwarfCodeScope::ScopeType)scopeType;
+
+        if (hasFrameBase)
+        {
+            o_scope.m_pFrameBase = new DwarfVariableLocation;
+            o_scope.m_pFrameBase->Initialize();
+            retVal = ReadVariableLocation(*o_scope.m_pFrameBase);
+        }
+    }
+
+    retVal = retVal && ReadBool(hasWorkitemOffset);
+
+    if (retVal && hasWorkitemOffset)
+    {
+        o_scope.m_pWorkitemOffset = new DwarfVariableLocation;
+        o_scope.m_pWorkitemOffset->Initialize();
+        retVal = ReadVariableLocation(*o_scope.m_pWorkitemOffset);
+    }
+
+    unsigned int numberOfRanges = 0;
+    retVal = retVal && ReadBool(o_scope.m_isKernel) && ReadBool(o_scope.m_scopeHasNonTrivialAddressRanges) && ReadUInt32(numberOfRanges);
+
+    for (unsigned int i = 0; retVal && (i < numberOfRanges); i++)
+    {
+        DwarfAddrType minAddr = 0;
+        DwarfAddrType maxAddr = 0;
+        retVal = ReadUInt64(minAddr) && ReadUInt64(maxAddr);
+
+        if (retVal)
+        {
+            o_scope.m_scopeAddressRanges.push_back(DbgInfoDwarfParser::DwarfCodeScope::AddressRange(minAddr, maxAddr));
+        }
+    }
+
+    // The cache is sorted, and a count which cannot fit in the rest of the buffer is rejected before allocating:
+    unsigned int numberOfCachedAddrs = 0;
+    retVal = retVal && ReadUInt32(numberOfCachedAddrs) && ((HwDbgUInt64)numberOfCachedAddrs * 8 <= (HwDbgUInt64)(m_dataSize - m_position));
+
+    if (retVal)
+    {
+        o_scope.m_addressCache.reserve(numberOfCachedAddrs);
+    }
+
+    for (unsigned int i = 0; retVal && (i < numberOfCachedAddrs); i++)
+    {
+        DwarfAddrType addr = 0;
+        retVal = ReadUInt64(addr) && (o_scope.m_addressCache.empty() || (o_scope.m_addressCache.back() < addr));
+
+        if (retVal)
+        {
+            o_scope.m_addressCache.push_back(addr);
+        }
+    }
+
+    unsigned int numberOfVariables = 0;
+    retVal = retVal && ReadFileLocation(o_scope.m_inlineInfo.m_inlinedAt) && ReadUInt32(numberOfVariables);
+
+    for (unsigned int i = 0; retVal && (i < numberOfVariables); i++)
+    {
+        DbgInfoDwarfParser::DwarfVariableInfo* pVariable = o_scope.AllocateVariable();
+        retVal = (nullptr != pVariable);
+
+        if (retVal)
+        {
+            o_scope.m_scopeVars.push_back(pVariable);
+            retVal = ReadVariable(*pVariable);
+        }
+    }
+
+    unsigned int numberOfChildren = 0;
+    retVal = retVal && ReadUInt32(numberOfChildren);
+
+    for (unsigned int i = 0; retVal && (i < numberOfChildren); i++)
+    {
+        DbgInfoDwarfParser::DwarfCodeScope* pChild = o_scope.AllocateChildScope();
+        retVal = (nullptr != pChild);
+
+        if (retVal)
+        {
+            pChild->m_pParentScope = &o_scope;
+            o_scope.m_children.push_back(pChild);
+            retVal = ReadCodeScope(*pChild);
+        }
+    }
+
+    if (!retVal)
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadAddressIndex
+/// \brief Description: Reads the address index written by \a WriteAddressIndex into a scope tree
+///                     just read by \a ReadCodeScope. The interval starts must be increasing and
+///                     each scope number must be in the tree.
+/// \param[in,out]      io_topScope - the top scope of the tree
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadAddressIndex(DbgInfoDwarfParser::DwarfCodeScope& io_topScope)
+{
+    std::vector<const DbgInfoDwarfParser::DwarfCodeScope*> scopesInOrder(1, nullptr);
+    ListCodeScopesInOrder(io_topScope, scopesInOrder);
+
+    bool isIndexBuilt = false;
+    unsigned int numberOfIntervals = 0;
+    bool retVal = ReadBool(isIndexBuilt) && ReadUInt32(numberOfIntervals) &&
+                  ((HwDbgUInt64)numberOfIntervals * 12 <= (HwDbgUInt64)(m_dataSize - m_position));
+
+    std::vector<DwarfAddrType> intervalStarts;
+    std::vector<const DbgInfoDwarfParser::DwarfCodeScope*> intervalScopes;
+
+    if (retVal)
+    {
+        intervalStarts.reserve(numberOfIntervals);
+        intervalScopes.reserve(numberOfIntervals);
+    }
+
+    for (unsigned int i = 0; retVal && (i < numberOfIntervals); i++)
+    {
+        DwarfAddrType intervalStart = 0;
+        unsigned int scopeNumber = 0;
+        retVal = ReadUInt64(intervalStart) && (intervalStarts.empty() || (intervalStarts.back() < intervalStart)) &&
+                 ReadUInt32(scopeNumber) && (scopesInOrder.size() > scopeNumber);
+
+        if (retVal)
+        {
+            intervalStarts.push_back(intervalStart);
+            intervalScopes.push_back(scopesInOrder[scopeNumber]);
+        }
+    }
+
+    if (retVal)
+    {
+        if (isIndexBuilt)
+        {
+            io_topScope.SetAddressIndex(intervalStarts, intervalScopes);
+        }
+    }
+    else
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadFileLocation
+/// \brief Description: Reads a file location, and its path if this is the path's first use
+/// \param[out]         o_fileLocation - the file location
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadFileLocation(FileLocation& o_fileLocation)
+{
+    unsigned int pathIndex = 0;
+    bool retVal = ReadUInt32(pathIndex);
+
+    if (retVal && (m_paths.size() == pathIndex))
+    {
+        // First use of the path:
+        std::string fullPath;
+        retVal = ReadString(fullPath);
+
+        if (retVal)
+        {
+            m_paths.push_back(fullPath);
+        }
+    }
+
+    retVal = retVal && (m_paths.size() > pathIndex) && ReadUInt64(o_fileLocation.m_lineNum);
+
+    if (retVal)
+    {
+        o_fileLocation.setFullPath(m_paths[pathIndex]);
+    }
+    else
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadVariableLocation
+/// \brief Description: Reads a variable location
+/// \param[out]         o_location - the location
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadVariableLocation(DwarfVariableLocation& o_location)
+{
+    unsigned int locationRegister = 0;
+    unsigned int constAddition = 0;
+    bool retVal = ReadUInt32(locationRegister) && ((unsigned int)DwarfVariableLocation::LOC_REG_UNINIT >= locationRegister) &&
+                  ReadUInt32(o_location.m_registerNumber) &&
+                  ReadBool(o_location.m_shouldDerefValue) &&
+                  ReadUInt32(o_location.m_locationOffset) &&
+                  ReadUInt64(o_location.m_locationResource) &&
+                  ReadUInt32(o_location.m_isaMemoryRegion) &&
+                  ReadUInt32(o_location.m_pieceOffset) &&
+                  ReadUInt32(o_location.m_pieceSize) &&
+                  ReadUInt32(constAddition);
+
+    if (retVal)
+    {
+        o_location.m_locationRegister = (DwarfVariableLocation::LocationRegister)locationRegister;
+        o_location.m_constAddition = (int)constAddition;
+    }
+    else
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// ReadVariable
+/// \brief Description: Reads a variable and, recursively, its members
+/// \param[out]         o_variable - the variable
+/// \return Success / failure
+/// -----------------------------------------------------------------------------------------------
+bool DbgInfoIndexReader::ReadVariable(DbgInfoDwarfParser::DwarfVariableInfo& o_variable)
+{
+    bool isConst = false;
+    bool retVal = ReadString(o_variable.m_varName) &&
+                  ReadString(o_variable.m_typeName) &&
+                  ReadUInt64(o_variable.m_varSize) &&
+                  ReadUInt32(o_variable.m_varEncoding) &&
+                  ReadBool(isConst);
+
+    if (retVal && isConst)
+    {
+        const unsigned char* pConstValue = (o_variable.m_varSize <= (HwDbgUInt64)(m_dataSize - m_position)) ? Consume((size_t)o_variable.m_varSize) : nullptr;
+        retVal = (nullptr != pConstValue);
+
+        if (retVal)
+        {
+            o_variable.SetConstantValue(o_variable.m_varSize, (unsigned char*)pConstValue);
+        }
+    }
+    else if (retVal)
+    {
+        o_variable.m_varValue.m_varValueLocation.Initialize();
+        retVal = ReadVariableLocation(o_variable.m_varValue.m_varValueLocation);
+    }
+
+    unsigned int varIndirection = 0;
+    unsigned int numberOfMembers = 0;
+    retVal = retVal && ReadUInt32(varIndirection) &&
+             ReadUInt32(o_variable.m_varIndirectionDetail) &&
+             ReadUInt64(o_variable.m_lowVariablePC) &&
+             ReadUInt64(o_variable.m_highVariablePC) &&
+             ReadBool(o_variable.m_isParam) &&
+             ReadBool(o_variable.m_isOutParam) &&
+             ReadUInt32(o_variable.m_brigOffset) &&
+             ReadUInt32(numberOfMembers);
+
+    if (retVal)
+    {
+        o_variable.m_varIndirection = (HwDbgInfo_indirection)varIndirection;
+    }
+
+    for (unsigned int i = 0; retVal && (i < numberOfMembers); i++)
+    {
+        o_variable.m_varMembers.push_back(DbgInfoDwarfParser::DwarfVariableInfo());
+        retVal = ReadVariable(o_variable.m_varMembers.back());
+    }
+
+    if (!retVal)
+    {
+        m_isValid = false;
+    }
+
+    return retVal;
+}
@@ -0,0 +1,107 @@
+//==============================================================================
+// Copyright (c) 2016-2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief Description: Serialized index of parsed debug information
+//==============================================================================
+#ifndef DBGINFOINDEX_H_
+#define DBGINFOINDEX_H_
+
+// STL:
+#include <map>
+#include <string>
+#include <vector>
+
+// Local:
+#include "DbgInfoDefinitions.h"
+#include "DbgInfoDwarfParser.h"
+
+/// Identifies an index buffer ("HDIX", little-endian):
+#define DBGINFO_INDEX_MAGIC 0x58494448
+/// The index layout version, must change whenever the layout or the parser output changes:
+#define DBGINFO_INDEX_VERSION 2
+
+namespace HwDbg
+{
+/// Computes the checksum that ends an index, so a damaged index is rejected (64-bit FNV-1a)
+DBGINF_API HwDbgUInt64 DbgInfoIndexChecksum(const void* pData, size_t dataSize);
+
+/// -----------------------------------------------------------------------------------------------
+/// \class DbgInfoIndexWriter
+/// \brief Description: Serializes the line tables and scope trees produced by the DWARF parser
+/// into a buffer that \a DbgInfoIndexReader can rebuild them from without the DWARF.
+/// All values are stored little-endian. A file path is written in full only the first time it
+/// is used, later uses refer to it by index.
+/// -----------------------------------------------------------------------------------------------
+class DBGINF_API DbgInfoIndexWriter
+{
+public:
+    /// Constructor, the writer appends to o_buffer
+    DbgInfoIndexWriter(std::vector<unsigned char>& o_buffer) : m_buffer(o_buffer) {};
+
+    void WriteUInt32(unsigned int value);
+    void WriteUInt64(HwDbgUInt64 value);
+    void WriteBytes(const void* pData, size_t dataSize);
+    void WriteString(const std::string& str);
+    /// Writes all the mappings of a line table, in the order they were added
+    void WriteLineMapping(const DbgInfoDwarfParser::DwarfLineMapping& lineMapping);
+    /// Writes a scope, its variables and its descendants. Deferred variables are loaded first
+    void WriteCodeScope(const DbgInfoDwarfParser::DwarfCodeScope& scope);
+    /// Writes the address index of a scope tree written by WriteCodeScope
+    void WriteAddressIndex(const DbgInfoDwarfParser::DwarfCodeScope& topScope);
+
+private:
+    /// Disallow use of assignment operator
+    DbgInfoIndexWriter& operator=(const DbgInfoIndexWriter& other);
+
+    void WriteFileLocation(const FileLocation& fileLocation);
+    void WriteVariableLocation(const DwarfVariableLocation& location);
+    void WriteVariable(const DbgInfoDwarfParser::DwarfVariableInfo& variable);
+
+    std::vector<unsigned char>& m_buffer;                   ///< The output buffer
+    std::map<std::string, unsigned int> m_writtenPaths;     ///< The index of each file path already written
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// \class DbgInfoIndexReader
+/// \brief Description: Rebuilds the structures written by \a DbgInfoIndexWriter. Every read is
+/// bounds checked, a read past the end of the buffer or an inconsistent value fails and
+/// leaves the reader failed, so a truncated or corrupt index is rejected rather than trusted.
+/// -----------------------------------------------------------------------------------------------
+class DBGINF_API DbgInfoIndexReader
+{
+public:
+    /// Constructor, the buffer must remain valid while reading
+    DbgInfoIndexReader(const void* pData, size_t dataSize)
+        : m_pData((const unsigned char*)pData), m_dataSize(dataSize), m_position(0), m_isValid(nullptr != pData) {};
+
+    bool ReadUInt32(unsigned int& o_value);
+    bool ReadUInt64(HwDbgUInt64& o_value);
+    bool ReadString(std::string& o_str);
+    /// Reads a line table and freezes it
+    bool ReadLineMapping(DbgInfoDwarfParser::DwarfLineMapping& o_lineMapping);
+    /// Reads a scope, its variables and its descendants, which are allocated with the scope's allocators
+    bool ReadCodeScope(DbgInfoDwarfParser::DwarfCodeScope& o_scope);
+    /// Reads the address index of a scope tree read by ReadCodeScope
+    bool ReadAddressIndex(DbgInfoDwarfParser::DwarfCodeScope& io_topScope);
+    /// Returns true if all the buffer was read successfully
+    bool IsAtEnd() const { return m_isValid && (m_position == m_dataSize); };
+
+private:
+    bool ReadBool(bool& o_value);
+    bool ReadFileLocation(FileLocation& o_fileLocation);
+    bool ReadVariableLocation(DwarfVariableLocation& o_location);
+    bool ReadVariable(DbgInfoDwarfParser::DwarfVariableInfo& o_variable);
+    /// Returns the next dataSize bytes and advances past them, nullptr if they are not all in the buffer
+    const unsigned char* Consume(size_t dataSize);
+
+    const unsigned char* m_pData;       ///< The index buffer
+    size_t m_dataSize;                  ///< The index buffer size
+    size_t m_position;                  ///< The offset of the next read
+    bool m_isValid;                     ///< false once a read failed
+    std::vector<std::string> m_paths;   ///< The file paths read so far, by index
+};
+}
+
+#endif // DBGINFOINDEX_H_
@@ -22,7 +22,7 @@
 #include "DbgInfoDefinitions.h"
 
 /// STL:
-#include <map>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -90,12 +90,16 @@ template <typename AddrType, typename LineType> class LineNumberMapping
 public:
     /// Constructor: Set the number of lines/addresses to read back/forward when searching
     LineNumberMapping(int addrReadAhead = DIL_DEFAULT_ADDR_READAHEAD, int addrReadBack = DIL_DEFAULT_ADDR_READBACK, int lineReadAhead = DIL_DEFAULT_LINE_READAHEAD, int lineReadBack = DIL_DEFAULT_LINE_READBACK)
-        : m_addrReadAhead(addrReadAhead), m_addrReadBack(addrReadBack), m_lineReadAhead(lineReadAhead), m_lineReadBack(lineReadBack) {}
+        : m_isFrozen(false), m_addrReadAhead(addrReadAhead), m_addrReadBack(addrReadBack), m_lineReadAhead(lineReadAhead), m_lineReadBack(lineReadBack) {}
     ~LineNumberMapping() { ClearMap(); };
     /// Given a line and an address, add them to the internal mappings
     bool AddLineMapping(const LineType& line, const AddrType& addr);
     /// Clear internal mappings
     void ClearMap();
+    /// Build the lookup tables once all the mappings were added. Lookups freeze the mapping if this was not called
+    void Freeze();
+    /// Returns true if the lookup tables are built
+    bool IsFrozen() const { return m_isFrozen; };
     /// Gets the line mapped to the specified address and returns it as an out param, return false if not found
     bool GetLineFromAddress(const AddrType& addr, LineType& o_line) const;
     /// Gets the addresses mapped to the specified line and returns them as an out param, return false if not found, append specifies whether to append to the existing addresses or clear the vector
@@ -112,20 +116,41 @@ public:
     bool GetNearestMappedAddress(const AddrType& addr, AddrType& o_mappedAddr) const;
 
 private:
-    /// 1:1 mapping of address to line
-    typedef std::map<AddrType, LineType> atlMap;
-    /// 1:N mapping of line to addresses
-    typedef std::map<LineType, std::vector<AddrType>* > ltaMap;
+    /// Orders address indices by the line they were added with
+    struct PendingLineLess
+    {
+        PendingLineLess(const std::vector<LineType>& lines) : m_lines(lines) {};
+        bool operator()(unsigned int a, unsigned int b) const { return m_lines[a] < m_lines[b]; };
+        const std::vector<LineType>& m_lines;
+    };
+    /// Orders line indices by the first address mapped to them
+    struct FirstAddrIndexLess
+    {
+        FirstAddrIndexLess(const std::vector<unsigned int>& firstAddrs) : m_firstAddrs(firstAddrs) {};
+        bool operator()(unsigned int a, unsigned int b) const { return m_firstAddrs[a] < m_firstAddrs[b]; };
+        const std::vector<unsigned int>& m_firstAddrs;
+    };
     /// Disallow use of assignment operator
     LineNumberMapping& operator=(const LineNumberMapping& other);
     /// Disallow use of copy constructor:
     LineNumberMapping(const LineNumberMapping& other);
-
-    atlMap m_addrToLine;                ///< 1:1 Mapping of AddrType toLineType
-    ltaMap m_lineToAddr;                ///< 1:N Mapping of LineType to AddrType
-    std::vector<AddrType> m_mappedAddrs;        ///< Vector of all mapped addresses
-    std::vector<AddrType> m_mappedFirstAddrs;   ///< Vector of all mapped first addresses
-    std::vector<LineType> m_mappedLines;        ///< Vector of all mapped lines
+    /// Go back to the building state, so more mappings can be added
+    void Thaw();
+    /// Freeze the mapping before the first lookup
+    void EnsureFrozen() const { if (!m_isFrozen) { const_cast<LineNumberMapping*>(this)->Freeze(); } };
+    /// Find the nearest value in a sorted vector, within a read ahead / read back window
+    template <typename ValueType>
+    static bool FindNearestSortedValue(const std::vector<ValueType>& sortedValues, const ValueType& value, int readAhead, int readBack, ValueType& o_foundValue);
+
+    std::vector<AddrType> m_mappedAddrs;            ///< All mapped addresses, in the order they were added
+    std::vector<LineType> m_pendingLines;           ///< Until frozen: The line of each address in m_mappedAddrs
+    std::vector<AddrType> m_sortedAddrs;            ///< All mapped addresses, sorted
+    std::vector<unsigned int> m_sortedAddrLines;    ///< Per sorted address: its index in m_mappedAddrs until frozen, then the index of its line in m_sortedLines
+    std::vector<LineType> m_sortedLines;            ///< Frozen: All mapped lines, sorted
+    std::vector<unsigned int> m_lineAddrOffsets;    ///< Frozen: The addresses of m_sortedLines[i] are m_lineAddrs[m_lineAddrOffsets[i]] to m_lineAddrs[m_lineAddrOffsets[i + 1] - 1]
+    std::vector<AddrType> m_lineAddrs;              ///< Frozen: The addresses of each line, in the order they were added
+    std::vector<unsigned int> m_mappedLineOrder;    ///< Frozen: Indices in m_sortedLines, in the order the lines were first mapped
+    bool m_isFrozen;                    ///< Are the lookup tables built
     const int m_addrReadAhead;          ///< Number of addresses to look ahead - Default is DIL_DEFAULT_ADDR_READAHEAD
     const int m_addrReadBack;           ///< Number of addresses to look back - Default is DIL_DEFAULT_ADDR_READBACK
     const int m_lineReadAhead;          ///< Number of lines to look ahead - Default is DIL_DEFAULT_LINE_READAHEAD
@@ -184,52 +209,34 @@ template<typename AddrType, typename LineType>
 bool LineNumberMapping<AddrType, LineType>::AddLineMapping(const LineType& line, const AddrType& addr)
 {
     bool retVal = false;
-    typename atlMap::iterator firstMapFindIter = m_addrToLine.find(addr);
-    typename atlMap::iterator firstMapEndIter = m_addrToLine.end();
-    bool isNewAddr = (firstMapEndIter == firstMapFindIter);
+
+    if (m_isFrozen)
+    {
+        Thaw();
+    }
+
+    // Line tables are mostly ordered by address, so the sorted insertion usually appends:
+    typename std::vector<AddrType>::iterator findIter = std::lower_bound(m_sortedAddrs.begin(), m_sortedAddrs.end(), addr);
+    size_t sortedIndex = findIter - m_sortedAddrs.begin();
+    bool isNewAddr = (m_sortedAddrs.end() == findIter) || (addr < *findIter);
 
     // An address may only be mapped once!:
     if (isNewAddr)
     {
         retVal = true;
-        // Add address to the vector of mapped addresses:
-        m_mappedAddrs.push_back(addr);
+        m_sortedAddrs.insert(findIter, addr);
+        m_sortedAddrLines.insert(m_sortedAddrLines.begin() + sortedIndex, (unsigned int)m_mappedAddrs.size());
 
-        // Add address to line the mapping:
-        m_addrToLine[addr] = line;
-
-        typename ltaMap::iterator secondMapFindIter = m_lineToAddr.find(line);
-        typename ltaMap::iterator secondMapEndIter = m_lineToAddr.end();
-        bool isNewLine = (secondMapEndIter == secondMapFindIter);
-
-        //If we have a new line, we need to add it to the lines vector and initialize a new address vector for this specific line:
-        if (isNewLine)
-        {
-            // Add Line to vector:
-            m_mappedLines.push_back(line);
-
-            // This is a new "first" address:
-            m_mappedFirstAddrs.push_back(addr);
-
-            // Create & initialize new addresses vector for the new line:
-            std::vector<AddrType>* addressesMappedToLine = new (std::nothrow)std::vector<AddrType>;
-            if (nullptr != addressesMappedToLine)
-            {
-                addressesMappedToLine->push_back(addr);
-                m_lineToAddr[line] = addressesMappedToLine;
-            }
-        }
-        else // If this is not a new line, add the address to the existing line's address vector
-        {
-            secondMapFindIter->second->push_back(addr);
-        }
+        // Add address to the vector of mapped addresses, the lines are grouped when the mapping is frozen:
+        m_mappedAddrs.push_back(addr);
+        m_pendingLines.push_back(line);
     }
     else // !isNewAddr
     {
         // If the address is already mapped, return success if it's simply a duplicate mapping to the same line number.
         // Since we enforce a one-to-many relation of line to addresses, any other value means information is discarded,
         // so we will consider it a failure:
-        if (firstMapFindIter->second == line)
+        if (m_pendingLines[m_sortedAddrLines[sortedIndex]] == line)
         {
             retVal = true;
         }
@@ -245,11 +252,112 @@ bool LineNumberMapping<AddrType, LineType>::AddLineMapping(const LineType& line,
 template<typename AddrType, typename LineType>
 void LineNumberMapping<AddrType, LineType>::ClearMap()
 {
-    m_addrToLine.clear();
-    m_lineToAddr.clear();
     m_mappedAddrs.clear();
-    m_mappedFirstAddrs.clear();
-    m_mappedLines.clear();
+    m_pendingLines.clear();
+    m_sortedAddrs.clear();
+    m_sortedAddrLines.clear();
+    m_sortedLines.clear();
+    m_lineAddrOffsets.clear();
+    m_lineAddrs.clear();
+    m_mappedLineOrder.clear();
+    m_isFrozen = false;
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// Freeze
+/// \brief Description: Groups the added addresses by line into contiguous sorted tables.
+/// Adding a mapping after this is allowed, but rebuilds the tables on the next lookup.
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+void LineNumberMapping<AddrType, LineType>::Freeze()
+{
+    if (m_isFrozen)
+    {
+        return;
+    }
+
+    unsigned int numberOfAddrs = (unsigned int)m_mappedAddrs.size();
+
+    // Sort the addresses by line, a stable sort keeps each line's addresses in the order they were added:
+    std::vector<unsigned int> addrsByLine(numberOfAddrs);
+
+    for (unsigned int i = 0; i < numberOfAddrs; i++)
+    {
+        addrsByLine[i] = i;
+    }
+
+    std::stable_sort(addrsByLine.begin(), addrsByLine.end(), PendingLineLess(m_pendingLines));
+
+    // Build the line to addresses table:
+    std::vector<unsigned int> lineOfAddr(numberOfAddrs);
+    std::vector<unsigned int> firstAddrOfLine;
+    m_sortedLines.clear();
+    m_lineAddrOffsets.clear();
+    m_lineAddrs.clear();
+    m_lineAddrs.reserve(numberOfAddrs);
+
+    for (unsigned int i = 0; i < numberOfAddrs; i++)
+    {
+        unsigned int addrIndex = addrsByLine[i];
+        const LineType& line = m_pendingLines[addrIndex];
+
+        if (m_sortedLines.empty() || (m_sortedLines.back() < line))
+        {
+            m_lineAddrOffsets.push_back(i);
+            m_sortedLines.push_back(line);
+            firstAddrOfLine.push_back(addrIndex);
+        }
+
+        lineOfAddr[addrIndex] = (unsigned int)m_sortedLines.size() - 1;
+        m_lineAddrs.push_back(m_mappedAddrs[addrIndex]);
+    }
+
+    m_lineAddrOffsets.push_back(numberOfAddrs);
+
+    // Keep the order in which lines were first mapped:
+    unsigned int numberOfLines = (unsigned int)m_sortedLines.size();
+    m_mappedLineOrder.resize(numberOfLines);
+
+    for (unsigned int i = 0; i < numberOfLines; i++)
+    {
+        m_mappedLineOrder[i] = i;
+    }
+
+    std::sort(m_mappedLineOrder.begin(), m_mappedLineOrder.end(), FirstAddrIndexLess(firstAddrOfLine));
+
+    // Point each sorted address to its line instead of its insertion index:
+    for (unsigned int i = 0; i < numberOfAddrs; i++)
+    {
+        m_sortedAddrLines[i] = lineOfAddr[m_sortedAddrLines[i]];
+    }
+
+    // The lines are now only held in the line table:
+    std::vector<LineType>().swap(m_pendingLines);
+    m_isFrozen = true;
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// Thaw
+/// \brief Description: Restores the per-address lines from the frozen tables so more mappings can be added
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+void LineNumberMapping<AddrType, LineType>::Thaw()
+{
+    unsigned int numberOfAddrs = (unsigned int)m_mappedAddrs.size();
+    m_pendingLines.resize(numberOfAddrs);
+
+    for (unsigned int i = 0; i < numberOfAddrs; i++)
+    {
+        size_t sortedIndex = std::lower_bound(m_sortedAddrs.begin(), m_sortedAddrs.end(), m_mappedAddrs[i]) - m_sortedAddrs.begin();
+        m_pendingLines[i] = m_sortedLines[m_sortedAddrLines[sortedIndex]];
+        m_sortedAddrLines[sortedIndex] = i;
+    }
+
+    m_sortedLines.clear();
+    m_lineAddrOffsets.clear();
+    m_lineAddrs.clear();
+    m_mappedLineOrder.clear();
+    m_isFrozen = false;
 };
 
 /// -----------------------------------------------------------------------------------------------
@@ -265,13 +373,14 @@ bool LineNumberMapping<AddrType, LineType>::GetLineFromAddress(const AddrType& a
 {
     bool retVal = false;
 
-    typename atlMap::const_iterator findIter = m_addrToLine.find(addr);
-    typename atlMap::const_iterator endIter = m_addrToLine.end();
+    EnsureFrozen();
+    typename std::vector<AddrType>::const_iterator findIter = std::lower_bound(m_sortedAddrs.begin(), m_sortedAddrs.end(), addr);
+    typename std::vector<AddrType>::const_iterator endIter = m_sortedAddrs.end();
 
-    if (endIter != findIter)
+    if ((endIter != findIter) && !(addr < *findIter))
     {
         retVal = true;
-        o_line = findIter->second;
+        o_line = m_sortedLines[m_sortedAddrLines[findIter - m_sortedAddrs.begin()]];
     }
 
     return retVal;
@@ -294,20 +403,16 @@ bool LineNumberMapping<AddrType, LineType>::GetAddressesFromLine(const LineType&
         o_addrs.clear();
     }
 
-    typename ltaMap::const_iterator findIter = m_lineToAddr.find(line);
-    typename ltaMap::const_iterator endIter = m_lineToAddr.end();
+    EnsureFrozen();
+    typename std::vector<LineType>::const_iterator findIter = std::lower_bound(m_sortedLines.begin(), m_sortedLines.end(), line);
+    typename std::vector<LineType>::const_iterator endIter = m_sortedLines.end();
 
     // If this line has valid addresses:
-    if (endIter != findIter)
+    if ((endIter != findIter) && !(line < *findIter))
     {
         // Add the addresses to the output parameter:
-        const std::vector<AddrType>& addrs = *(findIter->second);
-        int numOfAddrs = (int)addrs.size();
-
-        for (int i = 0; i < numOfAddrs; i++)
-        {
-            o_addrs.push_back(addrs[i]);
-        }
+        size_t lineIndex = findIter - m_sortedLines.begin();
+        o_addrs.insert(o_addrs.end(), m_lineAddrs.begin() + m_lineAddrOffsets[lineIndex], m_lineAddrs.begin() + m_lineAddrOffsets[lineIndex + 1]);
     }
 
     // Return true if we have at least one mapped address:
@@ -326,12 +431,14 @@ bool LineNumberMapping<AddrType, LineType>::GetMappedLines(std::vector<LineType>
 {
     o_lines.clear();
 
-    // Get lines from mapped lines vector
-    int numberOfMappedLines = (int)m_mappedLines.size();
+    // Get lines in the order they were mapped:
+    EnsureFrozen();
+    int numberOfMappedLines = (int)m_mappedLineOrder.size();
+    o_lines.reserve(numberOfMappedLines);
 
     for (int i = 0; i < numberOfMappedLines; i++)
     {
-        o_lines.push_back(m_mappedLines[i]);
+        o_lines.push_back(m_sortedLines[m_mappedLineOrder[i]]);
     }
 
     return (0 != o_lines.size());
@@ -347,15 +454,8 @@ bool LineNumberMapping<AddrType, LineType>::GetMappedLines(std::vector<LineType>
 template<typename AddrType, typename LineType>
 bool LineNumberMapping<AddrType, LineType>::GetMappedAddresses(std::vector<AddrType>& o_addrs) const
 {
-    o_addrs.clear();
-
     // Get addresses from mapped addresses vector
-    int numberOfMappedAddrs = (int)m_mappedAddrs.size();
-
-    for (int i = 0; i < numberOfMappedAddrs; i++)
-    {
-        o_addrs.push_back(m_mappedAddrs[i]);
-    }
+    o_addrs = m_mappedAddrs;
 
     return (0 != o_addrs.size());
 };
@@ -372,83 +472,96 @@ bool LineNumberMapping<AddrType, LineType>::GetMappedFirstAddresses(std::vector<
 {
     o_addrs.clear();
 
-    // Get addresses from mapped addresses vector
-    int numberOfMappedAddrs = (int)m_mappedFirstAddrs.size();
+    // Get the first address of each line, in the order the lines were mapped:
+    EnsureFrozen();
+    int numberOfMappedLines = (int)m_mappedLineOrder.size();
+    o_addrs.reserve(numberOfMappedLines);
 
-    for (int i = 0; i < numberOfMappedAddrs; i++)
+    for (int i = 0; i < numberOfMappedLines; i++)
     {
-        o_addrs.push_back(m_mappedFirstAddrs[i]);
+        o_addrs.push_back(m_lineAddrs[m_lineAddrOffsets[m_mappedLineOrder[i]]]);
     }
 
     return (0 != o_addrs.size());
 };
 
 /// -----------------------------------------------------------------------------------------------
-/// GetNearestMappedLine
-/// \brief Description: Get the nearest mapped line to the specified line, search range determined by
-/// the class members \a m_lineReadAhead and \a m_lineReadBack
-/// \param[in]          line - specified line
-/// \param[out]         o_mappedLine - nearest mapped line
-/// \return True : If a mapped line was found withing the specified range
+/// FindNearestSortedValue
+/// \brief Description: Find the first value at or after the specified one, up to readAhead values
+/// ahead (including the value itself). If none is found, find the last value before it, up to
+/// readBack - 1 values back, not going past a zero value.
+/// \param[in]          sortedValues - the values to search, sorted
+/// \param[in]          value - the value to look for
+/// \param[in]          readAhead - size of the window ahead of the value
+/// \param[in]          readBack - size of the window behind the value
+/// \param[out]         o_foundValue - the nearest value found
+/// \return True : If a value was found within the windows
 /// \return False: Otherwise
 /// -----------------------------------------------------------------------------------------------
 template<typename AddrType, typename LineType>
-bool LineNumberMapping<AddrType, LineType>::GetNearestMappedLine(const LineType& line, LineType& o_mappedLine) const
+template<typename ValueType>
+bool LineNumberMapping<AddrType, LineType>::FindNearestSortedValue(const std::vector<ValueType>& sortedValues, const ValueType& value, int readAhead, int readBack, ValueType& o_foundValue)
 {
     bool retVal = false;
 
-    LineType foundLine = line;
-    typename ltaMap::const_iterator endIter = m_lineToAddr.end();
+    typename std::vector<ValueType>::const_iterator findIter = std::lower_bound(sortedValues.begin(), sortedValues.end(), value);
 
-    // First, try to read ahead - including current line:
-    for (int i = 0; i < m_lineReadAhead; i++)
+    // First, try to read ahead - including the current value:
+    if ((0 < readAhead) && (sortedValues.end() != findIter))
     {
-        // Check if the current line has a mapping:
-        typename ltaMap::const_iterator findIter = m_lineToAddr.find(foundLine);
+        ValueType lastValue = value;
 
-        if (endIter != findIter)
+        for (int i = 1; i < readAhead; i++)
         {
-            retVal = true;
-            o_mappedLine = foundLine;
-            break;
+            ++lastValue;
         }
 
-        ++foundLine;
+        if (!(lastValue < *findIter))
+        {
+            retVal = true;
+            o_foundValue = *findIter;
+        }
     }
 
-    // After m_lineReadAhead steps, if we have not found a mapped line, start looking back behind the line:
-    if (!retVal)
+    // If we have not found a mapped value, look back behind it - not including the value itself:
+    if ((!retVal) && (sortedValues.begin() != findIter))
     {
-        // Do not include the original line:
-        foundLine = line;
-        -- foundLine;
+        // The value is supposed to be false at the beginning:
+        ValueType firstValue = value;
+
+        for (int i = 1; (i < readBack) && firstValue; i++)
+        {
+            --firstValue;
+        }
+
+        --findIter;
 
-        for (int i = 1; i < m_lineReadBack; i++)
+        if (!(*findIter < firstValue))
         {
-            // Check if the current line has a mapping:
-            typename ltaMap::const_iterator findIter = m_lineToAddr.find(foundLine);
-
-            if (endIter != findIter)
-            {
-                retVal = true;
-                o_mappedLine = foundLine;
-                break;
-            }
-
-            // If we have reached the beginning - Line is supposed to be false at the beginning:
-            if (!foundLine)
-            {
-                break;
-            }
-
-            // decrement line:
-            --foundLine;
+            retVal = true;
+            o_foundValue = *findIter;
         }
     }
 
     return retVal;
 };
 
+/// -----------------------------------------------------------------------------------------------
+/// GetNearestMappedLine
+/// \brief Description: Get the nearest mapped line to the specified line, search range determined by
+/// the class members \a m_lineReadAhead and \a m_lineReadBack
+/// \param[in]          line - specified line
+/// \param[out]         o_mappedLine - nearest mapped line
+/// \return True : If a mapped line was found withing the specified range
+/// \return False: Otherwise
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+bool LineNumberMapping<AddrType, LineType>::GetNearestMappedLine(const LineType& line, LineType& o_mappedLine) const
+{
+    EnsureFrozen();
+    return FindNearestSortedValue(m_sortedLines, line, m_lineReadAhead, m_lineReadBack, o_mappedLine);
+};
+
 /// -----------------------------------------------------------------------------------------------
 /// GetNearestMappedAddress
 /// \brief Description: Get the nearest mapped address and put it into o_mappedAddr.
@@ -461,60 +574,7 @@ bool LineNumberMapping<AddrType, LineType>::GetNearestMappedLine(const LineType&
 template<typename AddrType, typename LineType>
 bool LineNumberMapping<AddrType, LineType>::GetNearestMappedAddress(const AddrType& addr, AddrType& o_mappedAddr) const
 {
-    bool retVal = false;
-
-    AddrType foundAddr = addr;
-    typename atlMap::const_iterator endIter = m_addrToLine.end();
-
-    // Look ahead for the address:
-    for (int i = 0; i < m_addrReadAhead; i++)
-    {
-        typename atlMap::const_iterator findIter = m_addrToLine.find(foundAddr);
-
-        // If we have found the address:
-        if (endIter != findIter)
-        {
-            // Return true and output the address:
-            retVal = true;
-            o_mappedAddr = foundAddr;
-            break;
-        }
-
-        ++foundAddr;
-    }
-
-    // If the address is not ahead, look behind:
-    if (!retVal)
-    {
-        // Do not include the original address:
-        foundAddr = addr;
-        --foundAddr;
-
-        for (int i = 1; i < m_addrReadBack; i++)
-        {
-            typename atlMap::const_iterator findIter = m_addrToLine.find(foundAddr);
-
-            // If we have found the address:
-            if (endIter != findIter)
-            {
-                // Return true and output the address:
-                retVal = true;
-                o_mappedAddr = foundAddr;
-                break;
-            }
-
-            // If we have reached the beginning break- Address is supposed to be false at the beginning:
-            if (!foundAddr)
-            {
-                break;
-            }
-
-            // decrement Address:
-            --foundAddr;
-        }
-    }
-
-    return retVal;
+    return FindNearestSortedValue(m_sortedAddrs, addr, m_addrReadAhead, m_addrReadBack, o_mappedAddr);
 };
 
 }
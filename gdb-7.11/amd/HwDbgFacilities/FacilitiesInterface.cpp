@@ -9,7 +9,13 @@
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
 
 // Brig:
 #include "BrigSectionHeader.h"
@@ -17,6 +23,7 @@
 // HwDbgFacilities:
 #include "DbgInfoUtils.h"
 #include "DbgInfoDwarfParser.h"
+#include "DbgInfoIndex.h"
 #include "DbgInfoConsumerImpl.h"
 #include "DbgInfoCompoundConsumer.h"
 #include "DbgInfoLogging.h"
@@ -25,6 +32,9 @@
 
 #define HWDBGFAC_INTERFACE_DUMMY_FILE_PATH "src1.hsail"
 
+// The most virtual call stacks memoized per debug info object, the oldest is dropped first:
+#define HWDBGFAC_INTERFACE_CALL_STACK_CACHE_SIZE 4096
+
 // Shorthand to handle the optional pointer-to-output parameter:
 #define HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, errcode) \
     { \
@@ -87,6 +97,11 @@ typedef DbgInfoConsumerImpl<HwDbgUInt64, FileLocation, DwarfVariableLocation> Db
 typedef DbgInfoCompoundConsumer<HwDbgUInt64, FileLocation, DwarfVariableLocation, HwDbgUInt64, DwarfVariableLocation, FileLocation> DbgInfoTwoLevelConsumer;
 typedef VariableInfo<HwDbgUInt64, DwarfVariableLocation> DbgInfoVariable;
 
+// A memoized virtual call stack, and whether the consumer found one. Stacks are shared, so a stack
+// being copied out stays valid when another thread drops it from the memo table:
+typedef std::pair<bool, std::vector<DbgInfoTwoLevelConsumer::TwoLvlCallStackFrame> > HwDbgInfo_FacInt_CallStack;
+typedef std::shared_ptr<const HwDbgInfo_FacInt_CallStack> HwDbgInfo_FacInt_SharedCallStack;
+
 // Helper structs:
 struct HwDbgInfo_FacInt_Debug
 {
@@ -111,6 +126,8 @@ struct HwDbgInfo_FacInt_Debug
     // Adds a variable to the allocated variables list
     void AddVariable(DbgInfoVariable* pVar)
     {
+        std::lock_guard<std::mutex> lock(m_lock);
+
         // Try and place it in an empty spot:
         size_t allocVarCount = m_allocatedVariableObjects.size();
 
@@ -131,6 +148,7 @@ struct HwDbgInfo_FacInt_Debug
     // DOES NOT DELETE THE VARIABLE OBJECT!
     bool RemoveVariable(DbgInfoVariable* pVar)
     {
+        std::lock_guard<std::mutex> lock(m_lock);
         bool retVal = false;
         size_t allocVarCount = m_allocatedVariableObjects.size();
 
@@ -146,18 +164,103 @@ struct HwDbgInfo_FacInt_Debug
         return retVal;
     }
 
+    // Returns the ID of a file path, adding the path on its first use.
+    // Empty paths get HWDBGINFO_FILEID_NONE:
+    HwDbgInfo_fileid InternFileName(const char* pFullPath)
+    {
+        HwDbgInfo_fileid retVal = HWDBGINFO_FILEID_NONE;
+
+        if (nullptr != pFullPath && '\0' != pFullPath[0])
+        {
+            std::string fullPath = pFullPath;
+            std::lock_guard<std::mutex> lock(m_lock);
+            std::map<std::string, HwDbgInfo_fileid>::const_iterator findIter = m_internedFileIds.find(fullPath);
+
+            if (m_internedFileIds.end() != findIter)
+            {
+                retVal = findIter->second;
+            }
+            else
+            {
+                // IDs start after HWDBGINFO_FILEID_NONE:
+                m_internedFileNames.push_back(fullPath);
+                retVal = (HwDbgInfo_fileid)m_internedFileNames.size();
+                m_internedFileIds[fullPath] = retVal;
+            }
+        }
+
+        return retVal;
+    }
+
+    // Returns the path of an interned file path ID, nullptr for an unknown ID:
+    const char* GetInternedFileName(HwDbgInfo_fileid fileId)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return (HWDBGINFO_FILEID_NONE != fileId && m_internedFileNames.size() >= fileId) ? m_internedFileNames[fileId - 1].c_str() : nullptr;
+    }
+
+    // Returns the virtual call stack of an address, and whether it has one. The stacks are memoized by
+    // address, as many waves are usually stopped at the same few addresses:
+    HwDbgInfo_FacInt_SharedCallStack GetAddressCallStack(HwDbgUInt64 startAddr)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            std::map<HwDbgUInt64, HwDbgInfo_FacInt_SharedCallStack>::const_iterator findIter = m_callStacks.find(startAddr);
+
+            if (m_callStacks.end() != findIter)
+            {
+                return findIter->second;
+            }
+        }
+
+        // Build the stack without holding the lock. Addresses without a call stack are memoized as well:
+        std::shared_ptr<HwDbgInfo_FacInt_CallStack> pStack = std::make_shared<HwDbgInfo_FacInt_CallStack>();
+        pStack->first = m_cn->GetAddressVirtualCallStack(startAddr, pStack->second);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        HwDbgInfo_FacInt_SharedCallStack& memoizedStack = m_callStacks[startAddr];
+
+        // Another thread may have added the same stack meanwhile:
+        if (nullptr == memoizedStack)
+        {
+            if (HWDBGFAC_INTERFACE_CALL_STACK_CACHE_SIZE <= m_callStackOrder.size())
+            {
+                m_callStacks.erase(m_callStackOrder.front());
+                m_callStackOrder.pop_front();
+            }
+
+            memoizedStack = pStack;
+            m_callStackOrder.push_back(startAddr);
+        }
+
+        return memoizedStack;
+    }
+
     // The debug info type
     const HwDbgInfo_FacInt_Debug_Type m_tp;
 
     // The "default" file name - or main CU file name. It is the first file mapped in the HL line table:
     std::string m_firstMappedFileName;
 
+    // The interned file paths, ID n is at index n - 1.
+    // A deque does not move its elements when it grows, so the C strings handed out stay valid:
+    std::deque<std::string> m_internedFileNames;
+    std::map<std::string, HwDbgInfo_fileid> m_internedFileIds;
+
     // A vector of the variable objects allocated by the C API:
     std::vector<DbgInfoVariable*> m_allocatedVariableObjects;
 
     // The HSAIL source found inside the binary, if any:
     std::string m_hsailSource;
 
+    // The memoized virtual call stacks, by start address, and the addresses in the order they were added:
+    std::map<HwDbgUInt64, HwDbgInfo_FacInt_SharedCallStack> m_callStacks;
+    std::deque<HwDbgUInt64> m_callStackOrder;
+
+    // Guards the members that queries modify - the interned file paths, the allocated variables and
+    // the memoized call stacks - so that a frozen debug info can be queried from several threads:
+    std::mutex m_lock;
+
     // The consumer interface. Note that this class is not the owner of the consumer,
     // and memory management should be handled by derived classes:
     DbgInfoConsumerInterface* m_cn;
@@ -167,7 +270,7 @@ struct HwDbgInfo_FacInt_OneLevelDebug : public HwDbgInfo_FacInt_Debug
 {
 public:
     // Ctor
-    HwDbgInfo_FacInt_OneLevelDebug() : HwDbgInfo_FacInt_Debug(HWDBGFAC_INTERFACE_ONE_LEVEL_DEBUG_INFO), ol_cn(nullptr) {};
+    HwDbgInfo_FacInt_OneLevelDebug() : HwDbgInfo_FacInt_Debug(HWDBGFAC_INTERFACE_ONE_LEVEL_DEBUG_INFO), ol_cn(nullptr) { ol_sc.SetArena(&ol_ar); };
 
     // Dtor
     virtual ~HwDbgInfo_FacInt_OneLevelDebug()
@@ -177,6 +280,8 @@ public:
     };
 
     // One-level debug information
+    DbgInfoArena ol_ar;                         // One-level scopes and variables storage, must be declared before ol_sc
+    DwarfDeferredVariables ol_dv;               // One-level DWARF, for reading variables when first needed
     DbgInfoDwarfParser::DwarfCodeScope ol_sc;   // One-level variable debug info
     DbgInfoDwarfParser::DwarfLineMapping ol_lm; // One-level line debug info
     DbgInfoOneLevelConsumer* ol_cn;             // One-level debug info consumer
@@ -188,7 +293,12 @@ public:
     // Ctor
     HwDbgInfo_FacInt_TwoLevelDebug() :
         HwDbgInfo_FacInt_Debug(HWDBGFAC_INTERFACE_TWO_LEVEL_DEBUG_INFO),
-        hl_cn(nullptr), ll_cn(nullptr), ol_cn_owned(false), tl_cn(nullptr), llFileName(HWDBGFAC_INTERFACE_DUMMY_FILE_PATH), brig_code(nullptr, 0), brig_strtab(nullptr, 0) {};
+        hl_cn(nullptr), ll_cn(nullptr), ol_cn_owned(false), tl_cn(nullptr), llFileName(HWDBGFAC_INTERFACE_DUMMY_FILE_PATH)
+    {
+        // The levels are parsed concurrently, so each one has its own arena:
+        hl_sc.SetArena(&hl_ar);
+        ll_sc.SetArena(&ll_ar);
+    };
 
     // Dtor
     virtual ~HwDbgInfo_FacInt_TwoLevelDebug()
@@ -204,11 +314,15 @@ public:
     };
 
     // High-level debug information
+    DbgInfoArena hl_ar;                         // High-level scopes and variables storage, must be declared before hl_sc
+    DwarfDeferredVariables hl_dv;               // High-level DWARF, for reading variables when first needed
     DbgInfoDwarfParser::DwarfCodeScope hl_sc;   // High-level variable debug info
     DbgInfoDwarfParser::DwarfLineMapping hl_lm; // High-level line debug info
     DbgInfoOneLevelConsumer* hl_cn;             // High-level debug info consumer
 
     // Low-level debug information
+    DbgInfoArena ll_ar;                         // Low-level scopes and variables storage, must be declared before ll_sc
+    DwarfDeferredVariables ll_dv;               // Low-level DWARF, for reading variables when first needed
     DbgInfoDwarfParser::DwarfCodeScope ll_sc;   // Low-level variable debug info
     DbgInfoDwarfParser::DwarfLineMapping ll_lm; // Low-level line debug info
     DbgInfoOneLevelConsumer* ll_cn;             // Low-level debug info consumer
@@ -221,14 +335,16 @@ public:
 
     // The file name used for the "source locations" in the low-level debug information
     const std::string llFileName;
-
-    // Pointers to the BRIG code and string table sections
-    KernelBinary brig_code;
-    KernelBinary brig_strtab;
 };
 
 // Helper functions:
 
+// Parses the high-level binary of a two-level debug information, run on its own thread:
+void HwDbgInfoParseHighLevelBinary(const KernelBinary* pHLBin, HwDbgInfo_FacInt_TwoLevelDebug* pDbg, bool* pSucceeded)
+{
+    *pSucceeded = DbgInfoDwarfParser::InitializeWithBinary(*pHLBin, pDbg->hl_sc, pDbg->hl_lm, "", &pDbg->hl_dv);
+}
+
 // HL address to LL line resolver for the two-level debug information consumer:
 FileLocation HwDbgInfoAddressResolver(const HwDbgUInt64& hlAddr, void* dbg)
 {
@@ -327,6 +443,68 @@ bool HwDbgInfoLocationResolver(const HwDbg::DwarfVariableLocation& hVarLoc, cons
     return true;
 }
 
+// Creates the consumers of a two-level debug information, whose levels were parsed or read from an index:
+bool HwDbgInfoCreateTwoLevelConsumers(HwDbgInfo_FacInt_TwoLevelDebug* pDbg)
+{
+    pDbg->hl_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
+    pDbg->ll_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
+    pDbg->ol_cn_owned = true;
+
+    if (nullptr == pDbg->hl_cn || nullptr == pDbg->ll_cn)
+    {
+        return false;
+    }
+
+    pDbg->hl_cn->SetCodeScope(&pDbg->hl_sc);
+    pDbg->hl_cn->SetLineNumberMap(&pDbg->hl_lm);
+    pDbg->ll_cn->SetCodeScope(&pDbg->ll_sc);
+    pDbg->ll_cn->SetLineNumberMap(&pDbg->ll_lm);
+
+    pDbg->tl_cn = new(std::nothrow) DbgInfoTwoLevelConsumer(pDbg->hl_cn, pDbg->ll_cn, HwDbgInfoLocationResolver, HwDbgInfoAddressResolver, HwDbgInfoLineResolver, (void*)pDbg);
+
+    if (nullptr == pDbg->tl_cn)
+    {
+        return false;
+    }
+
+    // Set the parent struct's value:
+    pDbg->m_cn = pDbg->tl_cn;
+
+    // Transfer ownership of the one-level consumers to the two-level consumer:
+    pDbg->ol_cn_owned = false;
+
+    return true;
+}
+
+// Sets the "default" file name, the first file mapped in a line table:
+void HwDbgInfoSetFirstMappedFileName(HwDbgInfo_FacInt_Debug* pDbg, const DbgInfoDwarfParser::DwarfLineMapping& lineMapping)
+{
+    std::vector<FileLocation> fileLocs;
+    bool rcLM = lineMapping.GetMappedLines(fileLocs);
+
+    if (rcLM)
+    {
+        size_t fileLocCount = fileLocs.size();
+
+        for (size_t i = 0; i < fileLocCount; i++)
+        {
+            std::string currentFileName = fileLocs[i].fullPath();
+
+            if (!currentFileName.empty())
+            {
+                pDbg->m_firstMappedFileName = currentFileName;
+                break;
+            }
+        }
+    }
+}
+
+// Reads one level of debug information from an index. The address caches and index are restored as saved, not rebuilt:
+bool HwDbgInfoReadLevelFromIndex(DbgInfoIndexReader& reader, DbgInfoDwarfParser::DwarfCodeScope& o_scope, DbgInfoDwarfParser::DwarfLineMapping& o_lineMapping)
+{
+    return reader.ReadLineMapping(o_lineMapping) && reader.ReadCodeScope(o_scope) && reader.ReadAddressIndex(o_scope);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // C API functions                                                      //
 //////////////////////////////////////////////////////////////////////////
@@ -368,8 +546,8 @@ HwDbgInfo_debug hwdbginfo_init_with_single_level_binary(const void* bin, size_t
     {
         hwdbginfo_enable_logging();
     }
-    // Create the binary object:
-    KernelBinary olBin(bin, bin_size);
+    // View the binary in place, it only needs to be valid while parsing:
+    KernelBinary olBin(bin, bin_size, false);
 
     // Create the output struct:
     HwDbgInfo_FacInt_OneLevelDebug* dbg = new(std::nothrow) HwDbgInfo_FacInt_OneLevelDebug;
@@ -380,10 +558,11 @@ HwDbgInfo_debug hwdbginfo_init_with_single_level_binary(const void* bin, size_t
     }
 
     // Parse:
-    bool retVal = DbgInfoDwarfParser::InitializeWithBinary(olBin, dbg->ol_sc, dbg->ol_lm);
+    // Only the line table and scopes are read now, variables are read when first requested:
+    bool retVal = DbgInfoDwarfParser::InitializeWithBinary(olBin, dbg->ol_sc, dbg->ol_lm, "", &dbg->ol_dv);
 
-    // for each scope
-    for(size_t i=0; i < dbg->ol_sc.m_children.size(); i++)
+    // for each scope (logging reads all the variables, so skip it unless needed)
+    for (size_t i = 0; (nullptr != loggingOption) && (i < dbg->ol_sc.m_children.size()); i++)
     {
         DBGINFO_LOG( "===========Scope # " << i << "============\n");
         // For each address range within the scope
@@ -399,21 +578,23 @@ HwDbgInfo_debug hwdbginfo_init_with_single_level_binary(const void* bin, size_t
         }
 
         // for all vars in that scope
-        for (size_t j=0;j< dbg->ol_sc.m_children[i]->m_scopeVars.size(); j++)
+        const std::vector<DbgInfoDwarfParser::DwarfVariableInfo*>& scopeVars = dbg->ol_sc.m_children[i]->GetScopeVariables();
+
+        for (size_t j=0;j< scopeVars.size(); j++)
         {
-            if (dbg->ol_sc.m_children[i]->m_scopeVars[j]->m_varName.empty())
+            if (scopeVars[j]->m_varName.empty())
             {
                 DBGINFO_LOG("EMPTY Name: \t");
             }
             else
             {
-                DBGINFO_LOG("Var Name: \"" << dbg->ol_sc.m_children[i]->m_scopeVars[j]->m_varName << "\"\t");
+                DBGINFO_LOG("Var Name: \"" << scopeVars[j]->m_varName << "\"\t");
             }
 
-            DBGINFO_LOG( "Type Name: \"" << dbg->ol_sc.m_children[i]->m_scopeVars[j]->m_typeName << "\"\t"
+            DBGINFO_LOG( "Type Name: \"" << scopeVars[j]->m_typeName << "\"\t"
                         << std::hex
-                        << "LowPC: 0x" << dbg->ol_sc.m_children[i]->m_scopeVars[j]->m_lowVariablePC << "\t"
-                        << "HighPC: 0x" << dbg->ol_sc.m_children[i]->m_scopeVars[j]->m_highVariablePC << "\n"
+                        << "LowPC: 0x" << scopeVars[j]->m_lowVariablePC << "\t"
+                        << "HighPC: 0x" << scopeVars[j]->m_highVariablePC << "\n"
                         << std::dec);
         }
     }
@@ -486,8 +667,8 @@ HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(const void* bin, size_t bin_s
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOBINARY);
     }
 
-    // Create the binary object:
-    KernelBinary hsa10Bin(bin, bin_size);
+    // View the binary in place, the sections below are views into it as well:
+    KernelBinary hsa10Bin(bin, bin_size, false);
 
     // The HL DWARF is inside the BRIG Code object, which is section .hsa.brig:
     static const std::string brigCodeObjectSectionNamePrefix = ".hsahldebug_";
@@ -589,7 +770,7 @@ HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(const void* bin, size_t bin_s
         // If both debug sections are present (no need to pass them on, just check they are there:
         if (foundSection1 && foundSection2)
         {
-            // Copy the entire buffer, since it is the debug info container:
+            // Use the entire buffer, since it is the debug info container:
             hsa10Bin.getSubBufferAsBinary(0, hsa10Bin.m_binarySize, llBin);
         }
         else
@@ -643,8 +824,8 @@ HwDbgInfo_debug hwdbginfo_init_with_two_binaries(const void* hl_bin, size_t hl_b
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOLLBINARY);
     }
 
-    KernelBinary hlBin(hl_bin, hl_bin_size);
-    KernelBinary llBin(ll_bin, ll_bin_size);
+    KernelBinary hlBin(hl_bin, hl_bin_size, false);
+    KernelBinary llBin(ll_bin, ll_bin_size, false);
 
     // Create the output struct:
     HwDbgInfo_FacInt_TwoLevelDebug* dbg = new(std::nothrow) HwDbgInfo_FacInt_TwoLevelDebug;
@@ -654,8 +835,26 @@ HwDbgInfo_debug hwdbginfo_init_with_two_binaries(const void* hl_bin, size_t hl_b
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
     }
 
-    // Parse:
-    bool retVal = DbgInfoDwarfParser::InitializeWithBinary(hlBin, dbg->hl_sc, dbg->hl_lm);
+    // Parse, reading the variables only when first requested.
+    // The two levels do not depend on each other, so the high level is parsed on another thread:
+    bool retVal = false;
+    std::thread hlThread;
+
+    try
+    {
+        hlThread = std::thread(HwDbgInfoParseHighLevelBinary, &hlBin, dbg, &retVal);
+    }
+    catch (const std::system_error&)
+    {
+        HwDbgInfoParseHighLevelBinary(&hlBin, dbg, &retVal);
+    }
+
+    bool rcLL = DbgInfoDwarfParser::InitializeWithBinary(llBin, dbg->ll_sc, dbg->ll_lm, dbg->llFileName, &dbg->ll_dv);
+
+    if (hlThread.joinable())
+    {
+        hlThread.join();
+    }
 
     if (!retVal)
     {
@@ -663,63 +862,139 @@ HwDbgInfo_debug hwdbginfo_init_with_two_binaries(const void* hl_bin, size_t hl_b
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_HLINFO);
     }
 
-    retVal = DbgInfoDwarfParser::InitializeWithBinary(llBin, dbg->ll_sc, dbg->ll_lm, dbg->llFileName);
-
-    if (!retVal)
+    if (!rcLL)
     {
         delete dbg;
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_LLINFO);
     }
 
     // Initialize consumers:
-    dbg->hl_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
-    dbg->ll_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
-    dbg->ol_cn_owned = true;
-
-    if (nullptr == dbg->hl_cn || nullptr == dbg->ll_cn)
+    if (!HwDbgInfoCreateTwoLevelConsumers(dbg))
     {
         delete dbg;
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
     }
 
-    dbg->hl_cn->SetCodeScope(&dbg->hl_sc);
-    dbg->hl_cn->SetLineNumberMap(&dbg->hl_lm);
-    dbg->ll_cn->SetCodeScope(&dbg->ll_sc);
-    dbg->ll_cn->SetLineNumberMap(&dbg->ll_lm);
+    // Set the default file name:
+    HwDbgInfoSetFirstMappedFileName(dbg, dbg->hl_lm);
+
+    // Report success:
+    if (nullptr != err)
+    {
+        *err = HWDBGINFO_E_SUCCESS;
+    }
+
+    HwDbgInfo_FacInt_Debug* pBaseDbg = static_cast<HwDbgInfo_FacInt_Debug*>(dbg);
 
-    dbg->tl_cn = new(std::nothrow) DbgInfoTwoLevelConsumer(dbg->hl_cn, dbg->ll_cn, HwDbgInfoLocationResolver, HwDbgInfoAddressResolver, HwDbgInfoLineResolver, (void*)dbg);
+    return (HwDbgInfo_debug)pBaseDbg;
+}
 
-    if (nullptr == dbg->tl_cn)
+// Initialize a HwDbgInfo_debug from an index made by hwdbginfo_serialize_index, without parsing DWARF:
+HwDbgInfo_debug hwdbginfo_init_with_index(const void* index, size_t index_size, HwDbgInfo_err* err)
+{
+    // Validate input:
+    if (nullptr == index || 0 == index_size)
     {
-        delete dbg;
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOBINARY);
     }
 
-    // Set the parent struct's value:
-    dbg->m_cn = dbg->tl_cn;
+    // The index ends with a checksum of everything before it:
+    if (sizeof(HwDbgUInt64) > index_size)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_BINARY);
+    }
 
-    // Transfer ownership of the one-level consumers to the two-level consumer:
-    dbg->ol_cn_owned = false;
+    size_t indexDataSize = index_size - sizeof(HwDbgUInt64);
+    DbgInfoIndexReader checksumReader((const unsigned char*)index + indexDataSize, sizeof(HwDbgUInt64));
+    HwDbgUInt64 indexChecksum = 0;
 
-    // Set the default file name:
-    std::vector<FileLocation> hl_fileLocs;
-    bool rcHLLM = dbg->hl_lm.GetMappedLines(hl_fileLocs);
+    if (!checksumReader.ReadUInt64(indexChecksum) || (DbgInfoIndexChecksum(index, indexDataSize) != indexChecksum))
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_BINARY);
+    }
 
-    if (rcHLLM)
+    // Validate the header, an index from another version of the library is rejected:
+    DbgInfoIndexReader reader(index, indexDataSize);
+    unsigned int indexMagic = 0;
+    unsigned int indexVersion = 0;
+    unsigned int debugType = 0;
+    bool retVal = reader.ReadUInt32(indexMagic) && (DBGINFO_INDEX_MAGIC == indexMagic) &&
+                  reader.ReadUInt32(indexVersion) && (DBGINFO_INDEX_VERSION == indexVersion) &&
+                  reader.ReadUInt32(debugType);
+
+    if (!retVal)
     {
-        size_t fileLocCount = hl_fileLocs.size();
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_BINARY);
+    }
 
-        for (size_t i = 0; i < fileLocCount; i++)
+    // Create the output struct and its consumers:
+    HwDbgInfo_FacInt_Debug* pDbg = nullptr;
+
+    if ((unsigned int)HwDbgInfo_FacInt_Debug::HWDBGFAC_INTERFACE_ONE_LEVEL_DEBUG_INFO == debugType)
+    {
+        HwDbgInfo_FacInt_OneLevelDebug* pOLDbg = new(std::nothrow) HwDbgInfo_FacInt_OneLevelDebug;
+
+        if (nullptr == pOLDbg)
         {
-            std::string currentFileName = hl_fileLocs[i].fullPath();
+            HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+        }
 
-            if (!currentFileName.empty())
+        pDbg = pOLDbg;
+        retVal = HwDbgInfoReadLevelFromIndex(reader, pOLDbg->ol_sc, pOLDbg->ol_lm);
+
+        if (retVal)
+        {
+            pOLDbg->ol_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
+
+            if (nullptr == pOLDbg->ol_cn)
             {
-                dbg->m_firstMappedFileName = currentFileName;
-                break;
+                delete pDbg;
+                HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
             }
+
+            pOLDbg->ol_cn->SetCodeScope(&pOLDbg->ol_sc);
+            pOLDbg->ol_cn->SetLineNumberMap(&pOLDbg->ol_lm);
+            pOLDbg->m_cn = pOLDbg->ol_cn;
+            HwDbgInfoSetFirstMappedFileName(pOLDbg, pOLDbg->ol_lm);
         }
     }
+    else if ((unsigned int)HwDbgInfo_FacInt_Debug::HWDBGFAC_INTERFACE_TWO_LEVEL_DEBUG_INFO == debugType)
+    {
+        HwDbgInfo_FacInt_TwoLevelDebug* pTLDbg = new(std::nothrow) HwDbgInfo_FacInt_TwoLevelDebug;
+
+        if (nullptr == pTLDbg)
+        {
+            HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+        }
+
+        pDbg = pTLDbg;
+        retVal = HwDbgInfoReadLevelFromIndex(reader, pTLDbg->hl_sc, pTLDbg->hl_lm) &&
+                 HwDbgInfoReadLevelFromIndex(reader, pTLDbg->ll_sc, pTLDbg->ll_lm);
+
+        if (retVal)
+        {
+            if (!HwDbgInfoCreateTwoLevelConsumers(pTLDbg))
+            {
+                delete pDbg;
+                HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+            }
+
+            HwDbgInfoSetFirstMappedFileName(pTLDbg, pTLDbg->hl_lm);
+        }
+    }
+    else
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_BINARY);
+    }
+
+    // The HSAIL source is last, and nothing may follow it:
+    retVal = retVal && reader.ReadString(pDbg->m_hsailSource) && reader.IsAtEnd();
+
+    if (!retVal)
+    {
+        delete pDbg;
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_BINARY);
+    }
 
     // Report success:
     if (nullptr != err)
@@ -727,9 +1002,95 @@ HwDbgInfo_debug hwdbginfo_init_with_two_binaries(const void* hl_bin, size_t hl_b
         *err = HWDBGINFO_E_SUCCESS;
     }
 
-    HwDbgInfo_FacInt_Debug* pBaseDbg = static_cast<HwDbgInfo_FacInt_Debug*>(dbg);
+    return (HwDbgInfo_debug)pDbg;
+}
 
-    return (HwDbgInfo_debug)pBaseDbg;
+// Load everything a HwDbgInfo_debug reads on first use, making it safe for concurrent queries:
+HwDbgInfo_err hwdbginfo_freeze(HwDbgInfo_debug dbg)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg || nullptr == pDbg->m_cn)
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    if (pDbg->m_cn->IsFrozen())
+    {
+        return HWDBGINFO_E_SUCCESS;
+    }
+
+    pDbg->m_cn->Freeze();
+
+    // All the variables are loaded, so the DWARF kept open to read them is no longer needed:
+    if (HwDbgInfo_FacInt_Debug::HWDBGFAC_INTERFACE_TWO_LEVEL_DEBUG_INFO == pDbg->m_tp)
+    {
+        HwDbgInfo_FacInt_TwoLevelDebug* pTLDbg = static_cast<HwDbgInfo_FacInt_TwoLevelDebug*>(pDbg);
+        pTLDbg->hl_dv.Release();
+        pTLDbg->ll_dv.Release();
+    }
+    else // HWDBGFAC_INTERFACE_ONE_LEVEL_DEBUG_INFO == pDbg->m_tp
+    {
+        HwDbgInfo_FacInt_OneLevelDebug* pOLDbg = static_cast<HwDbgInfo_FacInt_OneLevelDebug*>(pDbg);
+        pOLDbg->ol_dv.Release();
+    }
+
+    return HWDBGINFO_E_SUCCESS;
+}
+
+// Serialize a HwDbgInfo_debug into an index:
+HwDbgInfo_err hwdbginfo_serialize_index(HwDbgInfo_debug dbg, size_t buf_len, void* index, size_t* index_size)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg || (0 == buf_len && nullptr == index && nullptr == index_size))
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_BUFFER(buf_len, index);
+
+    // Write the header and the levels. Writing the scopes reads any variables that were deferred:
+    std::vector<unsigned char> indexData;
+    DbgInfoIndexWriter writer(indexData);
+    writer.WriteUInt32(DBGINFO_INDEX_MAGIC);
+    writer.WriteUInt32(DBGINFO_INDEX_VERSION);
+    writer.WriteUInt32((unsigned int)pDbg->m_tp);
+
+    if (HwDbgInfo_FacInt_Debug::HWDBGFAC_INTERFACE_ONE_LEVEL_DEBUG_INFO == pDbg->m_tp)
+    {
+        HwDbgInfo_FacInt_OneLevelDebug* pOLDbg = static_cast<HwDbgInfo_FacInt_OneLevelDebug*>(pDbg);
+        writer.WriteLineMapping(pOLDbg->ol_lm);
+        writer.WriteCodeScope(pOLDbg->ol_sc);
+        writer.WriteAddressIndex(pOLDbg->ol_sc);
+    }
+    else
+    {
+        HwDbgInfo_FacInt_TwoLevelDebug* pTLDbg = static_cast<HwDbgInfo_FacInt_TwoLevelDebug*>(pDbg);
+        writer.WriteLineMapping(pTLDbg->hl_lm);
+        writer.WriteCodeScope(pTLDbg->hl_sc);
+        writer.WriteAddressIndex(pTLDbg->hl_sc);
+        writer.WriteLineMapping(pTLDbg->ll_lm);
+        writer.WriteCodeScope(pTLDbg->ll_sc);
+        writer.WriteAddressIndex(pTLDbg->ll_sc);
+    }
+
+    writer.WriteString(pDbg->m_hsailSource);
+    writer.WriteUInt64(DbgInfoIndexChecksum(&(indexData[0]), indexData.size()));
+
+    // Output the index:
+    size_t indexDataSize = indexData.size();
+
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_ARRAY(indexDataSize, index, buf_len, err);
+    HWDBGFAC_INTERFACE_CHECKRETURN(err);
+
+    void* indexDataBuf = (void*)(&(indexData[0]));
+    HWDBGFAC_INTERFACE_OUTPUT_ARRAY(indexDataBuf, unsigned char, indexDataSize, index, buf_len, index_size);
+
+    return HWDBGINFO_E_SUCCESS;
 }
 
 // Get the HSAIL source from the binary:
@@ -812,6 +1173,60 @@ HwDbgInfo_err hwdbginfo_code_location_details(HwDbgInfo_code_location loc, HwDbg
     return HWDBGINFO_E_SUCCESS;
 }
 
+// Query a HwDbgInfo_code_location for its interned file path:
+HwDbgInfo_err hwdbginfo_code_location_file(HwDbgInfo_debug dbg, HwDbgInfo_code_location loc, HwDbgInfo_linenum* line_num, HwDbgInfo_fileid* file_id)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+    FileLocation* pLoc = (FileLocation*)loc;
+
+    if (nullptr == pDbg || nullptr == pLoc || (nullptr == line_num && nullptr == file_id))
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    // Output the file path ID and line number:
+    if (nullptr != file_id)
+    {
+        *file_id = pDbg->InternFileName(pLoc->fullPath());
+    }
+
+    if (nullptr != line_num)
+    {
+        *line_num = pLoc->m_lineNum;
+    }
+
+    return HWDBGINFO_E_SUCCESS;
+}
+
+// Get the file path of an interned file path ID:
+HwDbgInfo_err hwdbginfo_file_name(HwDbgInfo_debug dbg, HwDbgInfo_fileid file_id, const char** file_name)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg || nullptr == file_name)
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    if (HWDBGINFO_FILEID_NONE == file_id)
+    {
+        *file_name = nullptr;
+        return HWDBGINFO_E_NOTFOUND;
+    }
+
+    // Output the path, owned by the debug info:
+    *file_name = pDbg->GetInternedFileName(file_id);
+
+    if (nullptr == *file_name)
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    return HWDBGINFO_E_SUCCESS;
+}
+
 // Query a HwDbgInfo_frame_context
 HwDbgInfo_err hwdbginfo_frame_context_details(HwDbgInfo_frame_context frm, HwDbgInfo_addr* pc, HwDbgInfo_addr* fp, HwDbgInfo_addr* mp, HwDbgInfo_code_location* loc, size_t buf_len, char* func_name, size_t* func_name_len)
 {
@@ -1061,6 +1476,94 @@ HwDbgInfo_err hwdbginfo_nearest_mapped_addr(HwDbgInfo_debug dbg, HwDbgInfo_addr
     return HWDBGINFO_E_SUCCESS;
 }
 
+// Matches the line numbers and file IDs of several addresses:
+HwDbgInfo_err hwdbginfo_addrs_to_lines(HwDbgInfo_debug dbg, size_t addr_count, const HwDbgInfo_addr* addrs, HwDbgInfo_linenum* line_nums, HwDbgInfo_fileid* file_ids)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg || 0 == addr_count || nullptr == addrs || (nullptr == line_nums && nullptr == file_ids))
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    // Query the debug info. Unmapped addresses do not stop the other queries:
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    FileLocation matchedLine;
+    HwDbgInfo_fileid matchedFileId = HWDBGINFO_FILEID_NONE;
+    bool rc = false;
+
+    for (size_t i = 0; i < addr_count; i++)
+    {
+        // Callers often pass runs of the same address (e.g. the PCs of waves), so only query (and intern the file path) when the address changes:
+        if (0 == i || addrs[i] != addrs[i - 1])
+        {
+            rc = pDbg->m_cn->GetLineFromAddress(addrs[i], matchedLine);
+
+            if (nullptr != file_ids)
+            {
+                matchedFileId = rc ? pDbg->InternFileName(matchedLine.fullPath()) : HWDBGINFO_FILEID_NONE;
+            }
+        }
+
+        if (!rc)
+        {
+            err = HWDBGINFO_E_NOTFOUND;
+        }
+
+        // Output the location:
+        if (nullptr != line_nums)
+        {
+            line_nums[i] = rc ? matchedLine.m_lineNum : 0;
+        }
+
+        if (nullptr != file_ids)
+        {
+            file_ids[i] = matchedFileId;
+        }
+    }
+
+    return err;
+}
+
+// Finds the closest valid addresses to several input addresses:
+HwDbgInfo_err hwdbginfo_nearest_mapped_addrs(HwDbgInfo_debug dbg, size_t addr_count, const HwDbgInfo_addr* base_addrs, HwDbgInfo_addr* addrs)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg || 0 == addr_count || nullptr == base_addrs || nullptr == addrs)
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    // Query the debug info. Addresses without a mapped address do not stop the other queries.
+    // The previous base address is kept aside since addrs may be the same buffer as base_addrs:
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    HwDbgInfo_addr queriedAddr = 0;
+    HwDbgUInt64 matchedAddr = 0;
+    bool rc = false;
+
+    for (size_t i = 0; i < addr_count; i++)
+    {
+        if (0 == i || base_addrs[i] != queriedAddr)
+        {
+            queriedAddr = base_addrs[i];
+            rc = pDbg->m_cn->GetNearestMappedAddress(queriedAddr, matchedAddr);
+        }
+
+        if (!rc)
+        {
+            err = HWDBGINFO_E_NOTFOUND;
+        }
+
+        // Output the address:
+        addrs[i] = rc ? (HwDbgInfo_addr)matchedAddr : 0;
+    }
+
+    return err;
+}
+
 // Gets first legal (mapped) HL filepath
 HwDbgInfo_err hwdbginfo_first_file_name(HwDbgInfo_debug dbg, size_t buf_len, char* file_name, size_t* file_name_len)
 {
@@ -1148,8 +1651,9 @@ HwDbgInfo_err hwdbginfo_addr_call_stack(HwDbgInfo_debug dbg, HwDbgInfo_addr star
     HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_BUFFER(buf_len, stack_frames);
 
     // Query the debug info:
-    std::vector<DbgInfoTwoLevelConsumer::TwoLvlCallStackFrame> cs;
-    bool rc = pDbg->m_cn->GetAddressVirtualCallStack(start_addr, cs);
+    HwDbgInfo_FacInt_SharedCallStack pMemoizedStack = pDbg->GetAddressCallStack(start_addr);
+    const std::vector<DbgInfoTwoLevelConsumer::TwoLvlCallStackFrame>& cs = pMemoizedStack->second;
+    bool rc = pMemoizedStack->first;
 
     if (!rc)
     {
@@ -37,6 +37,8 @@ typedef unsigned int HwDbgInfo_indirection;
 typedef unsigned int HwDbgInfo_indirectiondetail;
 /* Variable location register (HWDBGINFO_VLOC_REG_*         */
 typedef unsigned int HwDbgInfo_locreg;
+/* An interned file path, valid as long as its debug info  */
+typedef unsigned int HwDbgInfo_fileid;
 
 /***************/
 /* Error codes */
@@ -136,9 +138,16 @@ typedef unsigned int HwDbgInfo_locreg;
 /* Undefined / uninitialized            */
 #define HWDBGINFO_VLOC_REG_UNINIT 3
 
+/*****************/
+/* File path ID: */
+/*****************/
+/* No file path / unmapped location */
+#define HWDBGINFO_FILEID_NONE 0
+
 /*******************/
 /* Initialization: */
 /*******************/
+/* The binaries are not referenced after these return, so the caller may release them */
 /* Create a HwDbgInfo_debug from a single- or two- level binary */
 HwDbgInfo_debug hwdbginfo_init_and_identify_binary(const void* bin, size_t bin_size, HwDbgInfo_err* err);
 /* Create a HwDbgInfo_debug from a single level ELF/DWARF binary */
@@ -147,12 +156,22 @@ HwDbgInfo_debug hwdbginfo_init_with_single_level_binary(const void* bin, size_t
 HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(const void* bin, size_t bin_size, HwDbgInfo_err* err);
 /* Create a HwDbgInfo_debug directly from the BRIG DWARF container and ISA DWARF container */
 HwDbgInfo_debug hwdbginfo_init_with_two_binaries(const void* hl_bin, size_t hl_bin_size, const void* const ll_bin, size_t ll_bin_size, HwDbgInfo_err* err);
+/* Create a HwDbgInfo_debug from an index made by hwdbginfo_serialize_index, without parsing DWARF.
+   An index made by another version of this library is rejected with HWDBGINFO_E_BINARY */
+HwDbgInfo_debug hwdbginfo_init_with_index(const void* index, size_t index_size, HwDbgInfo_err* err);
+/* Load everything that is otherwise read on first use (e.g. variables). Afterwards, the query
+   functions below may be called concurrently on the same HwDbgInfo_debug from several threads.
+   Before this returns, the HwDbgInfo_debug must only be used by one thread at a time */
+HwDbgInfo_err hwdbginfo_freeze(HwDbgInfo_debug dbg);
 
 /***********************/
 /* Binary data access: */
 /***********************/
 /* Get the HSAIL text source, if it was available */
 HwDbgInfo_err hwdbginfo_get_hsail_text(HwDbgInfo_debug dbg, const char** hsail_source, size_t* hsail_source_len);
+/* Serialize the debug information into an index, e.g. to cache it between sessions. The index is
+   host-independent (little-endian). Pass a NULL index to get the required size only */
+HwDbgInfo_err hwdbginfo_serialize_index(HwDbgInfo_debug dbg, size_t buf_len, void* index, size_t* index_size);
 
 /*******************/
 /* Debug lines API */
@@ -161,6 +180,10 @@ HwDbgInfo_err hwdbginfo_get_hsail_text(HwDbgInfo_debug dbg, const char** hsail_s
 HwDbgInfo_code_location hwdbginfo_make_code_location(const char* file_name, HwDbgInfo_linenum line_num);
 /* Query a code location for its details */
 HwDbgInfo_err hwdbginfo_code_location_details(HwDbgInfo_code_location loc, HwDbgInfo_linenum* line_num, size_t buf_len, char* file_name, size_t* file_name_len);
+/* Query a code location for its line and interned file path */
+HwDbgInfo_err hwdbginfo_code_location_file(HwDbgInfo_debug dbg, HwDbgInfo_code_location loc, HwDbgInfo_linenum* line_num, HwDbgInfo_fileid* file_id);
+/* Get the file path of an interned file path ID. The string is owned by dbg and stays valid until it is released */
+HwDbgInfo_err hwdbginfo_file_name(HwDbgInfo_debug dbg, HwDbgInfo_fileid file_id, const char** file_name);
 /* Query a frame context for its details */
 HwDbgInfo_err hwdbginfo_frame_context_details(HwDbgInfo_frame_context frm, HwDbgInfo_addr* pc, HwDbgInfo_addr* fp, HwDbgInfo_addr* mp, HwDbgInfo_code_location* loc, size_t buf_len, char* func_name, size_t* func_name_len);
 
@@ -176,7 +199,11 @@ HwDbgInfo_err hwdbginfo_nearest_mapped_addr(HwDbgInfo_debug dbg, HwDbgInfo_addr
 HwDbgInfo_err hwdbginfo_first_file_name(HwDbgInfo_debug dbg, size_t buf_len, char* file_name, size_t* file_name_len);
 /* Get all legal (mapped) LL addresses */
 HwDbgInfo_err hwdbginfo_all_mapped_addrs(HwDbgInfo_debug dbg, size_t buf_len, HwDbgInfo_addr* addrs, size_t* addr_count);
-/* Get a LL address's virtual (inlined) call stack */
+/* Translate LL addresses to HL lines. Unmapped addresses get line 0 and HWDBGINFO_FILEID_NONE */
+HwDbgInfo_err hwdbginfo_addrs_to_lines(HwDbgInfo_debug dbg, size_t addr_count, const HwDbgInfo_addr* addrs, HwDbgInfo_linenum* line_nums, HwDbgInfo_fileid* file_ids);
+/* Get the nearest legal (mapped) LL addresses. Addresses without one get 0 */
+HwDbgInfo_err hwdbginfo_nearest_mapped_addrs(HwDbgInfo_debug dbg, size_t addr_count, const HwDbgInfo_addr* base_addrs, HwDbgInfo_addr* addrs);
+/* Get a LL address's virtual (inlined) call stack. The stacks are memoized by address, up to a bounded count */
 HwDbgInfo_err hwdbginfo_addr_call_stack(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, size_t buf_len, HwDbgInfo_frame_context* stack_frames, size_t* frame_count);
 /* Get all the addresses that can be the target of a step operation from a LL address */
 HwDbgInfo_err hwdbginfo_step_addresses(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, bool step_out, size_t buf_len, HwDbgInfo_addr* addrs, size_t* addr_count);
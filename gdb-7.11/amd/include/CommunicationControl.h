@@ -31,7 +31,8 @@ typedef enum
     HSAIL_COMMAND_MOMENTARY_BREAKPOINT, // Set an HSAIL momentary breakpoint (which is automatically deleted)
     HSAIL_COMMAND_CONTINUE,             // Continue the inferior process
     HSAIL_COMMAND_SET_LOGGING,          // Configure the logging in the Agent
-    HSAIL_COMMAND_SET_ISA_DUMP          // Configure dumping of ISA
+    HSAIL_COMMAND_SET_ISA_DUMP,         // Configure dumping of ISA
+    HSAIL_COMMAND_RING_DOORBELL         // Drain the shared memory command ring (sent on the fifo only)
 } HsailCommand;
 
 typedef enum
@@ -77,6 +78,7 @@ typedef enum
     HSAIL_DEBUG_CONFIG_LOADMAP_BUFFER_SHM,
     HSAIL_DEBUG_CONFIG_FIFO_GDB_TO_AGENT,
     HSAIL_DEBUG_CONFIG_FIFO_AGENT_TO_GDB,
+    HSAIL_DEBUG_CONFIG_COMMAND_RING_SHM,
 } HsailDebugConfigParam;
 
 typedef enum
@@ -370,6 +372,51 @@ typedef struct _HsailNotificationPayload
 } HsailNotificationPayload;
 
 
+// Framed notification format
+//
+// A framed notification is a HsailNotificationHeader followed by
+// m_payloadSize bytes. Frames are sent by the agent only if GDB advertised
+// support for them (see gs_NotificationFormatEnvVar), the agent then stamps
+// the version it picked in each header. Without the advertisement the agent
+// writes full HsailNotificationPayload structures.
+//
+// The first 4 bytes of a frame can never be a valid HsailNotification,
+// so GDB can tell both formats apart on every notification.
+#define HSAIL_NOTIFICATION_FRAME_MAGIC   0x4e48    // "HN"
+#define HSAIL_NOTIFICATION_FRAME_VERSION 1
+
+typedef struct _HsailNotificationHeader
+{
+    uint16_t m_magic;           // HSAIL_NOTIFICATION_FRAME_MAGIC
+    uint16_t m_version;         // Version of the frame layout
+    uint32_t m_notification;    // HsailNotification
+    uint32_t m_payloadSize;     // Number of bytes following the header
+} HsailNotificationHeader;
+
+// Payload of a HSAIL_NOTIFY_BREAKPOINT_HIT frame,
+// followed by m_numBreakpoints HsailBreakpointHitRecord
+typedef struct _HsailBreakpointHitFrame
+{
+    int32_t m_numActiveWaves;   // The number of waves written to shared mem
+    int32_t m_numBreakpoints;   // The number of records following
+} HsailBreakpointHitFrame;
+
+typedef struct _HsailBreakpointHitRecord
+{
+    int32_t m_breakpointId;     // The GDB breakpoint ID
+    int32_t m_hitCount;         // Number of times the breakpoint was hit
+} HsailBreakpointHitRecord;
+
+// Payload of a HSAIL_NOTIFY_DEVICES frame,
+// followed by m_devicesNum RocmDeviceDesc
+typedef struct _HsailDevicesFrame
+{
+    int32_t m_devicesNum;
+} HsailDevicesFrame;
+
+// For all the other notifications the payload of a frame is the
+// notification's member of the HsailNotificationPayload union
+
 typedef struct _HsailMomentaryBP
 {
     uint64_t m_pc;      // The PC for this momentary breakpoint
@@ -408,6 +455,104 @@ typedef struct
     char m_kernelName[AGENT_MAX_FUNC_NAME_LEN];     // The kernel name for kernel function breakpoints
 } HsailCommandPacket;
 
+// The number of slots in the GDB --> agent command ring, must be a power of 2
+#define HSAIL_COMMAND_RING_CAPACITY 1024
+
+// Single producer (GDB) / single consumer (agent) ring of command packets
+// placed in the HSAIL_DEBUG_CONFIG_COMMAND_RING_SHM shared memory.
+//
+// The ring is created and zeroed by the agent. An agent that does not create
+// it only reads commands from the fifo, GDB then uses the fifo for everything.
+//
+// Producer (GDB):
+//   1) If m_fifoPacketsConsumed is behind m_fifoPacketsWritten (acquire load),
+//      a packet that overflowed to the fifo is still pending: write the packet
+//      to the fifo too, so it cannot overtake the pending one
+//   2) Otherwise, if the ring is full, increment m_fifoPacketsWritten and write
+//      the packet to the fifo
+//   3) Otherwise copy the packet to m_packets[m_head % m_capacity], publish
+//      m_head + 1 with a release store, and if m_consumerWaiting is set, clear
+//      it and write a HSAIL_COMMAND_RING_DOORBELL packet to the fifo
+//
+// Consumer (agent):
+//   1) Drain the packets up to m_head (acquire load) and
+//      publish m_tail with a release store
+//   2) Before blocking on the fifo, set m_consumerWaiting and re-check m_head
+//   3) Drain the ring before acting on any packet read from the fifo,
+//      so that the ring packets written before the overflow keep their order
+//   4) After acting on a fifo packet other than a doorbell, increment
+//      m_fifoPacketsConsumed with a release store
+//
+// m_head and m_tail are free running counters, the ring is empty when they are
+// equal and full when they differ by m_capacity. An agent which does not update
+// m_fifoPacketsConsumed gets every packet after the first overflow on the fifo.
+typedef struct _HsailCommandRing
+{
+    uint32_t m_capacity;            // Number of slots, set by the agent
+    uint32_t m_consumerWaiting;     // Set by the agent when it sleeps on the fifo
+    uint64_t m_head;                // Next slot to write, only written by GDB
+    uint64_t m_fifoPacketsWritten;  // Command packets written to the fifo (not doorbells), only written by GDB
+    uint8_t  m_padding[40];         // Keep m_tail in its own cache line
+    uint64_t m_tail;                // Next slot to read, only written by the agent
+    uint64_t m_fifoPacketsConsumed; // Fifo command packets acted on, only written by the agent
+    uint8_t  m_padding2[48];
+    HsailCommandPacket m_packets[HSAIL_COMMAND_RING_CAPACITY];
+} HsailCommandRing;
+
+// The number of parsed code objects GDB keeps, this is also the size of
+// the table of cached code objects in HsailCodeObjectHeader
+#define HSAIL_CODE_OBJECT_CACHE_SIZE 16
+
+// 64 bit so that it cannot be mistaken for the size of the legacy layout
+#define HSAIL_CODE_OBJECT_MAGIC 0x434f444542494e31ULL
+// GDB ignores a code object buffer whose header has another version
+#define HSAIL_CODE_OBJECT_VERSION 1
+
+// Code object buffer layout with the cache handshake.
+//
+// If GDB sets gs_CodeObjectCacheEnvVar, the agent starts the
+// HSAIL_DEBUG_CONFIG_CODE_OBJ_SHM buffer with a HsailCodeObjectHeader
+// followed by the code object, instead of a size_t size.
+//
+// GDB keeps the parsed debug information of the last code objects, keyed by
+// HsailHashCodeObject and size, and lists them in m_cachedHashes. Before sending HSAIL_NOTIFY_NEW_BINARY the agent:
+//   1) Hashes the code object and fills m_hash and m_size
+//   2) Reads m_numCachedHashes (acquire) and the listed hashes
+//   3) If m_hash is listed, sets m_isCopied to 0 and does not copy the code object,
+//      else copies it after the header and sets m_isCopied to 1
+//
+// GDB rewrites the table while processing HSAIL_NOTIFY_NEW_BINARY, it sets
+// m_numCachedHashes to 0 first and publishes the new count with a release store.
+// The code object GDB would evict next is not listed, so a listed code object
+// is still cached when the next HSAIL_NOTIFY_NEW_BINARY is processed.
+typedef struct _HsailCodeObjectHeader
+{
+    uint64_t m_magic;               // HSAIL_CODE_OBJECT_MAGIC, written by the agent
+    uint32_t m_version;             // HSAIL_CODE_OBJECT_VERSION, written by the agent
+    uint32_t m_isCopied;            // 0 if the code object was not copied, written by the agent
+    uint64_t m_hash;                // Hash of the code object, written by the agent
+    uint64_t m_size;                // Size of the code object, written by the agent
+    uint32_t m_numCachedHashes;     // Entries in m_cachedHashes, written by GDB
+    uint32_t m_padding;
+    uint64_t m_cachedHashes[HSAIL_CODE_OBJECT_CACHE_SIZE]; // written by GDB
+} HsailCodeObjectHeader;
+
+// The hash GDB and the agent use to identify a code object (64 bit FNV-1a)
+static inline uint64_t HsailHashCodeObject(const void* pCodeObject, const size_t size)
+{
+    const unsigned char* pByte = (const unsigned char*)pCodeObject;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+
+    for (i = 0; i < size; i++)
+    {
+        hash ^= pByte[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
 // the hardware wave address
 typedef uint32_t HsailWaveAddress;
 
@@ -425,6 +570,44 @@ typedef struct _HsailAgentWaveInfo
 
 } HsailAgentWaveInfo;
 
+#define HSAIL_WAVE_BUFFER_MAGIC 0x57415645
+#define HSAIL_WAVE_BUFFER_VERSION 1
+
+// The size of the dirty list in the wave buffer header
+#define HSAIL_WAVE_BUFFER_MAX_DIRTY_WAVES 1024
+
+// m_numDirtyWaves value when the dirty list does not cover the update
+#define HSAIL_WAVE_BUFFER_ALL_DIRTY (-1)
+
+// Incremental wave buffer layout.
+//
+// If GDB sets gs_WaveBufferFormatEnvVar, the agent starts the wave buffer with a
+// HsailWaveBufferHeader. The HsailAgentWaveInfo array is at m_wavesOffset and
+// one uint64_t generation stamp per wave at m_stampsOffset, both in bytes
+// from the start of the buffer.
+//
+// Each time the agent updates the buffer (once per stop) it:
+//   1) Sets m_baseGeneration to the previous m_generation and increments m_generation
+//   2) Rewrites only the waves that changed, setting their stamp to m_generation
+//   3) Lists the index of each of those waves in m_dirtyWaves
+// If the dirty list overflows, or waves were added, removed or reordered,
+// m_numDirtyWaves is set to HSAIL_WAVE_BUFFER_ALL_DIRTY and every stamp is updated.
+//
+// A reader that applied generation G only needs the waves listed in m_dirtyWaves
+// if G == m_baseGeneration, else the waves whose stamp is larger than G.
+typedef struct _HsailWaveBufferHeader
+{
+    uint32_t m_magic;                       // HSAIL_WAVE_BUFFER_MAGIC
+    uint32_t m_version;                     // HSAIL_WAVE_BUFFER_VERSION
+    uint64_t m_generation;                  // Generation of the present content
+    uint64_t m_baseGeneration;              // Generation the dirty list is relative to
+    uint32_t m_wavesOffset;                 // Offset of the HsailAgentWaveInfo array
+    uint32_t m_stampsOffset;                // Offset of the uint64_t per wave stamps
+    int32_t  m_numWaves;                    // Number of waves in the buffer
+    int32_t  m_numDirtyWaves;               // Entries in m_dirtyWaves or HSAIL_WAVE_BUFFER_ALL_DIRTY
+    int32_t  m_dirtyWaves[HSAIL_WAVE_BUFFER_MAX_DIRTY_WAVES];
+} HsailWaveBufferHeader;
+
 
 // A constant value to use when we send a packet that doesnt use the m_pc field
 static const uint64_t HSAIL_ISA_PC_UNKOWN = (uint64_t)(-1);
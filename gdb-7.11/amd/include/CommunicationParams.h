@@ -22,6 +22,8 @@ const int g_ISASTREAM_SHMKEY = 4567;
 
 const int g_LOADMAP_SHMKEY =7890;
 
+const int g_COMMAND_RING_SHMKEY = 3333;
+
 const size_t g_MOMENTARY_BP_BUFFER_MAXSIZE = 1024 * 1024 * 20;
 
 const size_t g_BINARY_BUFFER_MAXSIZE = 1024 * 1024 * 10;
@@ -32,6 +34,9 @@ const size_t g_ISASTREAM_MAXSIZE = 1024 * 1024 * 20;
 
 const size_t g_LOADMAP_MAXSIZE = 1024 * 1024 * 10;
 
+// Has to be large enough for a HsailCommandRing
+const size_t g_COMMAND_RING_MAXSIZE = 1024 * 1024 * 1;
+
 // The names of the Fifos - opened in GDB and the agent
 
 // The FIFO written to by the agent and read by GDB (For things like bp statistics)
@@ -42,4 +47,36 @@ const char gs_GdbToAgentFifoName[]  = "fifo-gdb-w-agent-r";
 
 const char gs_ISAFileNamePath[]  = "/tmp/debugger_isa_dump";
 
+// Environment variable that carries the debug session ID from GDB to the agent.
+// The shared memory keys, fifo names and ISA dump path of a session are derived
+// from it, so that several GDB sessions can run on the same host at once.
+// An agent that does not read it keeps the fixed names and keys. GDB sees that its
+// fifo has the fixed name when the agent first signals it, and uses the fixed names too.
+const char gs_SessionIdEnvVar[] = "ROCM_GDB_IPC_SESSION_ID";
+
+// Set in all the derived keys so they cannot clash with the fixed keys above
+const int g_SESSION_SHMKEY_TAG = 0x40000000;
+
+// Derive the shared memory key of a buffer for a session.
+// paramType is the HsailDebugConfigParam of the buffer
+static inline int HsailGetSessionShmKey(const int sessionId, const int paramType)
+{
+    return g_SESSION_SHMKEY_TAG | ((sessionId & 0x3ffffff) << 4) | ((paramType + 1) & 0xf);
+}
+
+// The session fifo names and ISA dump path are the names above with "-<sessionId>" appended
+#define HSAIL_SESSION_NAME_SUFFIX_FORMAT "-%d"
+
+// Environment variable set by GDB to the highest notification frame version it reads.
+// The agent sends framed notifications only if this is set
+const char gs_NotificationFormatEnvVar[] = "ROCM_GDB_NOTIFICATION_FORMAT";
+
+// Environment variable set by GDB to the highest wave buffer version it reads.
+// The agent writes the incremental wave buffer layout only if this is set
+const char gs_WaveBufferFormatEnvVar[] = "ROCM_GDB_WAVE_BUFFER_FORMAT";
+
+// Environment variable set by GDB to the HSAIL_CODE_OBJECT_VERSION it reads.
+// The agent writes a HsailCodeObjectHeader before the code object only if this is set
+const char gs_CodeObjectCacheEnvVar[] = "ROCM_GDB_CODE_OBJECT_CACHE";
+
 #endif // COMMUNICATIONPARMS_H
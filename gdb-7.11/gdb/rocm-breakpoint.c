@@ -50,6 +50,7 @@
 #include "rocm-thread.h"
 #include "rocm-tdep.h"
 #include "rocm-utils.h"
+#include "rocm-wave.h"
 #include "CommunicationControl.h"
 
 /* Include HwDbgFacilities C interface*/
@@ -1359,8 +1360,7 @@ static void hsail_breakpoint_print_stopped_reason_kernel_function(void)
 
 void hsail_breakpoint_print_stopped_reason(void)
 {
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* active_waves = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
+  const struct hsail_wave_snapshot* snapshot = hsail_wave_get_snapshot();
   int i=0;
   bool is_breakpoint_found = false;
   HsailWaveDim3 focus_wg, focus_wi;
@@ -1369,7 +1369,7 @@ void hsail_breakpoint_print_stopped_reason(void)
 
   /* Handle the function breakpoint case first, it should only happen when
    * no waves are active*/
-  if (active_waves  == NULL || num_waves == 0)
+  if (snapshot == NULL)
     {
       if (hsail_is_focus_predispatch())
         {
@@ -1380,24 +1380,33 @@ void hsail_breakpoint_print_stopped_reason(void)
     }
 
   hsail_thread_get_current_focus(&focus_wg, &focus_wi);
-  /* If unknown, choose something */
+  /* If unknown, choose something, the first active lane of the first wave */
   if (hsail_utils_compare_wavedim3(&focus_wg, &gs_unknown_wave_dim) &&
       hsail_utils_compare_wavedim3(&focus_wi, &gs_unknown_wave_dim))
     {
-      hsail_thread_set_focus(active_waves[0].workGroupId,
-                             active_waves[0].workItemId[0]);
+      HsailWaveDim3 first_work_item;
+      int first_lane = 0;
+
+      if (snapshot->exec_masks[0] != 0)
+        {
+          first_lane = hsail_wave_first_lane(snapshot->exec_masks[0]);
+        }
+      hsail_wave_get_work_item(snapshot, 0, first_lane, &first_work_item);
+
+      hsail_thread_set_focus(snapshot->waves[0].workGroupId,
+                             first_work_item);
     }
 
 
-  for (i=0; i< num_waves; i++)
+  for (i=0; i< snapshot->num_waves; i++)
     {
       struct breakpoint* b = NULL;
       /* check if we have a breakpoint to print messages from */
-      if (hsail_breakpoint_lookup_pc(active_waves[i].pc, &b))
+      if (hsail_breakpoint_lookup_pc(snapshot->pcs[i], &b))
         {
           gdb_assert (b != NULL);
           if (hsail_breakpoint_check_bp_condition(&b->hsail_bp_request->condition,
-                                                  &active_waves[i]))
+                                                  &snapshot->waves[i]))
             {
               HsailConditionCode bp_condition_code = b->hsail_bp_request->condition.condition_code;
               if (bp_condition_code != HSAIL_BREAKPOINT_CONDITION_ANY &&
@@ -1432,12 +1441,12 @@ void hsail_breakpoint_print_stopped_reason(void)
       HwDbgInfo_debug dbg = hsail_init_hwdbginfo(NULL);
       if (dbg != NULL)
         {
-          for (i=0; i< num_waves; i++)
+          for (i=0; i< snapshot->num_waves; i++)
             {
-              HwDbgInfo_addr wave_pc = (HwDbgInfo_addr) (active_waves[i].pc);
+              HwDbgInfo_addr wave_pc = (HwDbgInfo_addr) (snapshot->pcs[i]);
               HwDbgInfo_linenum line_num = 0;
               HwDbgInfo_addr elf_va_pc = 0;
-              char* src_file_name = NULL;
+              const char* src_file_name = NULL;
 
               gdb_assert(hsail_segment_resolve_memva(wave_pc, (uint64_t*)(&elf_va_pc) ) == true);
 
@@ -1451,7 +1460,7 @@ void hsail_breakpoint_print_stopped_reason(void)
                       printf_filtered("[ROCm-gdb]: PC:0x%04lx \t %s %s@line %lld\n",
                                       (HsailProgramCounter)wave_pc,
                                       src_line,
-                                      basename(src_file_name),
+                                      lbasename(src_file_name),
                                       line_num);
                       xfree(src_line);
                       break;
@@ -1462,11 +1471,8 @@ void hsail_breakpoint_print_stopped_reason(void)
                                       (HsailProgramCounter)elf_va_pc);
                     }
                 }/* query dbginfo */
-              xfree(src_file_name);
             }/* for (i = 0 -> num_waves */
 
         } /* if (dbg !=  NULL*/
     }   /* if (!is_breakpoint_found) */
-
-  hsail_tdep_unmap_shm_buffer((void*)active_waves );
 }
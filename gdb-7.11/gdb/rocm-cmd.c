@@ -38,6 +38,7 @@
 
 /* rocm-gdb headers */
 #include "rocm-cmd.h"
+#include "rocm-dbginfo.h"
 #include "rocm-device.h"
 #include "rocm-fifo-control.h"
 #include "rocm-help.h"
@@ -71,6 +72,12 @@ static const int gs_hsail_argument_buff_len = 256;
 /* Bool option to "set rocm show-isa"*/
 static bool gs_isa_show_isa_enabled = false;
 
+/* Bool option to "set rocm save-source"*/
+static bool gs_save_source_enabled = false;
+
+/* Bool option to "set rocm index-cache"*/
+static bool gs_index_cache_enabled = true;
+
 /* Bool option to "set rocm logging"*/
 static bool gs_internal_logging_enabled = false;
 
@@ -452,6 +459,73 @@ static void hsail_cmd_set_isa_dump(const char* ip_option)
 
 }
 
+bool hsail_cmd_get_save_source_option(void)
+{
+  return gs_save_source_enabled;
+}
+
+static void hsail_cmd_set_save_source(const char* ip_option)
+{
+  if (ip_option == NULL)
+    {
+      printf_filtered("Save source options\n");
+      printf_filtered("set rocm save-source [on|off] \n");
+      return;
+    }
+  if(strcmp(ip_option,"on") == 0)
+    {
+      printf_filtered("The GPU kernel source will be saved to %s when a kernel is loaded\n",
+                      hsail_dbginfo_get_active_file_name());
+      gs_save_source_enabled = true;
+
+      /* Save the source of the kernel that is already loaded */
+      if (hsail_is_debug_facilities_loaded() == HSAIL_AGENT_BINARY_AVAILABLE)
+        {
+          hsail_dbginfo_save_source_to_file();
+        }
+    }
+  else if(strcmp(ip_option,"off") == 0)
+    {
+      printf_filtered("GPU kernel source saving has been disabled\n");
+      gs_save_source_enabled = false;
+    }
+  else
+    {
+      printf_filtered("Save source options\n");
+      printf_filtered("set rocm save-source [on|off] \n");
+    }
+}
+
+bool hsail_cmd_get_index_cache_option(void)
+{
+  return gs_index_cache_enabled;
+}
+
+static void hsail_cmd_set_index_cache(const char* ip_option)
+{
+  if (ip_option == NULL)
+    {
+      printf_filtered("Index cache options\n");
+      printf_filtered("set rocm index-cache [on|off] \n");
+      return;
+    }
+  if(strcmp(ip_option,"on") == 0)
+    {
+      printf_filtered("GPU kernel debug information will be cached on disk\n");
+      gs_index_cache_enabled = true;
+    }
+  else if(strcmp(ip_option,"off") == 0)
+    {
+      printf_filtered("GPU kernel debug information will not be cached on disk\n");
+      gs_index_cache_enabled = false;
+    }
+  else
+    {
+      printf_filtered("Index cache options\n");
+      printf_filtered("set rocm index-cache [on|off] \n");
+    }
+}
+
 static void hsail_cmd_parse_set_config_command (char *args, int from_tty, struct cmd_list_element *c)
 {
   /* Note that args is NULL always, the real args that we care for
@@ -491,6 +565,16 @@ static void hsail_cmd_parse_set_config_command (char *args, int from_tty, struct
           pch = strtok(NULL, " ");
           hsail_cmd_set_isa_dump(pch);
         }
+      else if (strcmp(pch, "save-source") == 0)
+        {
+          pch = strtok(NULL, " ");
+          hsail_cmd_set_save_source(pch);
+        }
+      else if (strcmp(pch, "index-cache") == 0)
+        {
+          pch = strtok(NULL, " ");
+          hsail_cmd_set_index_cache(pch);
+        }
       else
         {
           ui_out_text(uiout,"Invalid parameter\n");
@@ -516,6 +600,17 @@ static void hsail_cmd_show_config_command (struct ui_file *file, int from_tty,
   else
     printf_filtered("rocm show-isa: \t off\n");
 
+  if (hsail_cmd_get_save_source_option() == true)
+    printf_filtered("rocm save-source: \t on \t GPU kernel source will be saved to %s\n",
+                    hsail_dbginfo_get_active_file_name());
+  else
+    printf_filtered("rocm save-source: \t off\n");
+
+  if (hsail_cmd_get_index_cache_option() == true)
+    printf_filtered("rocm index-cache: \t on \t GPU kernel debug information is cached on disk\n");
+  else
+    printf_filtered("rocm index-cache: \t off\n");
+
   if (gs_internal_logging_enabled == true)
     printf_filtered("rocm logging: \t on \t Internal logging has been enabled\n");
   else
@@ -37,6 +37,10 @@ bool hsail_command_get_argument(const char* cmdInfo, const char* argName, unsign
 
 bool hsail_cmd_get_show_isa_option(void);
 
+bool hsail_cmd_get_save_source_option(void);
+
+bool hsail_cmd_get_index_cache_option(void);
+
 void hsail_cmd_reset_internal_logging(void);
 
 #endif
@@ -29,8 +29,10 @@
 #include "format.h"
 #include "gdb_assert.h"
 #include "breakpoint.h"
+#include "filestuff.h"
 #include "utils.h"
 
+#include "rocm-cmd.h"
 #include "rocm-dbginfo.h"
 #include "rocm-segment-loader.h"
 #include "rocm-tdep.h"
@@ -45,6 +47,13 @@
 #include <stdlib.h>
 #include <ctype.h>
 
+/* The on-disk index cache */
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 /* Include HwDbgFacilities C interface*/
 #include "FacilitiesInterface.h"
 
@@ -52,8 +61,27 @@
 static HwDbgInfo_debug gs_DbgInfo = NULL;
 static char* gs_hsail_source = NULL;
 
+/* Line offsets in gs_hsail_source, line N is at
+ * [gs_hsail_source_line_offsets[N-1], gs_hsail_source_line_offsets[N]) */
+static size_t* gs_hsail_source_line_offsets = NULL;
+static size_t gs_hsail_source_num_lines = 0;
+
 static AgentBinaryNotification g_binary_notification = HSAIL_AGENT_BINARY_UNKNOWN;
 
+/* The parsed debug information of the last code objects, so that dispatching
+ * the same kernel again does not parse its DWARF again.
+ * The entries own their HwDbgInfo_debug, gs_DbgInfo is one of them */
+typedef struct _HsailDbgInfoCacheEntry
+{
+  uint64_t hash;
+  uint64_t size;
+  HwDbgInfo_debug dbg;
+  unsigned long last_use;
+} HsailDbgInfoCacheEntry;
+
+static HsailDbgInfoCacheEntry gs_dbginfo_cache[HSAIL_CODE_OBJECT_CACHE_SIZE];
+static unsigned long gs_dbginfo_cache_use_count = 0;
+
 /* A placeholder for when the filename is not present */
 static const char default_file_name[] = "temp_source";
 
@@ -77,7 +105,49 @@ void hsail_dbginfo_set_facilities_status(const AgentBinaryNotification notificat
     }
 }
 
-static bool hsail_dbginfo_save_source_to_file(void)
+/* Build the line offsets of the kernel source, this is done once per binary
+ * so that lines can be looked up without reading the source again */
+static void hsail_dbginfo_index_source_buffer(size_t source_len)
+{
+  const char* line_end = NULL;
+  size_t num_lines = 0;
+  size_t offset = 0;
+
+  xfree(gs_hsail_source_line_offsets);
+  gs_hsail_source_line_offsets = NULL;
+  gs_hsail_source_num_lines = 0;
+
+  if (gs_hsail_source == NULL)
+    {
+      return;
+    }
+
+  /* The last line does not need to end with a newline */
+  offset = 0;
+  while (offset < source_len)
+    {
+      line_end = (const char*)memchr(gs_hsail_source + offset, '\n', source_len - offset);
+      offset = (line_end == NULL) ? source_len : (size_t)(line_end - gs_hsail_source) + 1;
+      num_lines++;
+    }
+
+  gs_hsail_source_line_offsets = (size_t*)xmalloc(sizeof(size_t)*(num_lines + 1));
+
+  offset = 0;
+  for (gs_hsail_source_num_lines = 0;
+       gs_hsail_source_num_lines < num_lines;
+       gs_hsail_source_num_lines++)
+    {
+      gs_hsail_source_line_offsets[gs_hsail_source_num_lines] = offset;
+      line_end = (const char*)memchr(gs_hsail_source + offset, '\n', source_len - offset);
+      offset = (line_end == NULL) ? source_len : (size_t)(line_end - gs_hsail_source) + 1;
+    }
+  gs_hsail_source_line_offsets[num_lines] = source_len;
+}
+
+/* Save the kernel source to the active file, only done if the user asked for it
+ * with "set rocm save-source on" since the lines are read from memory */
+bool hsail_dbginfo_save_source_to_file(void)
 {
   FILE* temp_file_handle = NULL;
   bool ret_code = false;
@@ -150,14 +220,20 @@ static bool hsail_dbginfo_init_source_buffer(HwDbgInfo_debug dbg_op)
       memset(gs_hsail_source, '\0', (hsail_source_len+1)*sizeof(char));
       memcpy(gs_hsail_source, temp_hsail_src, hsail_source_len*sizeof(char));
 
-      ret_code = hsail_dbginfo_save_source_to_file();
-      if (ret_code == true)
-        {
-          rocm_printf_filtered("Kernel saved to %s\n", active_kernel_src_file_path);
-        }
-      else
+      hsail_dbginfo_index_source_buffer(hsail_source_len);
+
+      ret_code = true;
+      if (hsail_cmd_get_save_source_option())
         {
-          rocm_printf_filtered("Error saving kernel\n");
+          ret_code = hsail_dbginfo_save_source_to_file();
+          if (ret_code == true)
+            {
+              rocm_printf_filtered("Kernel saved to %s\n", active_kernel_src_file_path);
+            }
+          else
+            {
+              rocm_printf_filtered("Error saving kernel\n");
+            }
         }
 
     }
@@ -189,6 +265,10 @@ static bool hsail_dbginfo_init_source_buffer(HwDbgInfo_debug dbg_op)
             {
               rocm_printf_filtered("Could not read %s\n", active_kernel_src_file_path);
             }
+          else
+            {
+              hsail_dbginfo_index_source_buffer(source_len);
+            }
 
           xfree(file_name);
         }
@@ -219,65 +299,58 @@ const char* hsail_dbginfo_get_active_file_name(void)
 }
 
 
+/* Return the file name of an interned file path ID, or "" if there is none.
+ * The kernel's own binary is shown as the active kernel source file.
+ * The file name is owned by dbg (or is the active file name) and must not be freed
+ * */
+const char* hsail_dbginfo_get_file_name(HwDbgInfo_debug dbg, HwDbgInfo_fileid file_id)
+{
+  const char* file_name = NULL;
+
+  hwdbginfo_file_name(dbg, file_id, &file_name);
+
+  if (file_name == NULL)
+    {
+      file_name = "";
+    }
+  else if (strstr(file_name, "hsa::self().elf") != NULL)
+    {
+      file_name = hsail_dbginfo_get_active_file_name();
+    }
+
+  return file_name;
+}
+
 /* Return line number and filename for an input PC
  * Note: The input pc has to be in the elf va form. The segment loader API should
  * resolve this before calling this function
  * */
-bool hsail_dbginfo_get_pc_info(HwDbgInfo_addr pc,  HwDbgInfo_linenum* op_line_num, char** op_file_name)
+bool hsail_dbginfo_get_pc_info(HwDbgInfo_addr pc,  HwDbgInfo_linenum* op_line_num, const char** op_file_name)
 {
   bool ret_code = false;
-  HwDbgInfo_code_location loc = NULL;
   HwDbgInfo_debug dbg = hsail_init_hwdbginfo(NULL);
   HwDbgInfo_err err = HWDBGINFO_E_PARAMETER;
 
   HwDbgInfo_linenum line_num = 0;
-  char* src_line = NULL;
+  HwDbgInfo_fileid file_id = HWDBGINFO_FILEID_NONE;
 
   if (op_line_num == NULL || op_file_name == NULL)
     {
       return ret_code;
     }
 
-  /* Go from PC to line by making a code_location object */
+  /* Go from PC to line and interned file name, nothing is allocated */
   if (dbg != NULL)
     {
-      size_t out_filename_len =0;
-      size_t in_filename_len =1024;
-      char* out_filename = (char*)malloc(sizeof(char)*in_filename_len);
-      gdb_assert(out_filename != NULL);
-      memset(out_filename, '\0', sizeof(char)*in_filename_len );
-
-      // for saxpy
-      //pc += 4096;
-      err = hwdbginfo_addr_to_line(dbg, pc, &loc);
+      err = hwdbginfo_addrs_to_lines(dbg, 1, &pc, &line_num, &file_id);
       if (err != HWDBGINFO_E_SUCCESS)
         {
           printf("Debug facilities error %d", err);
         }
-      err = hwdbginfo_code_location_details(loc,
-                                            &line_num,
-                                            in_filename_len, out_filename, &out_filename_len);
-      if (err != HWDBGINFO_E_SUCCESS)
-        {
-          printf("Debug facilities in code location error %d", err);
-        }
 
-      if (out_filename != NULL)
-        {
-          if (strstr(out_filename, "hsa::self().elf") != NULL)
-            {
-              hsail_utils_copy_string(op_file_name,
-                                      hsail_dbginfo_get_active_file_name());
-            }
-          else
-            {
-              *op_file_name = out_filename;
-            }
-        }
+      *op_file_name = hsail_dbginfo_get_file_name(dbg, file_id);
       *op_line_num = line_num;
 
-      hwdbginfo_release_code_locations(&loc, 1);
-
       ret_code = true;
     }
   return ret_code;
@@ -378,19 +451,22 @@ char* hsail_dbginfo_get_srcline_from_code_loc(const HwDbgInfo_debug dbg,
                                               const HwDbgInfo_code_location code_loc)
 {
   HwDbgInfo_linenum line_num = 0;
+  HwDbgInfo_fileid file_id = HWDBGINFO_FILEID_NONE;
+  const char* file_name = NULL;
   char* op_ptr = NULL;
-  size_t buffer_len = 1024;
-  size_t op_buffer_len = 1024;
 
   HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
-  char* file_name = xmalloc(sizeof(char)*buffer_len);
-  gdb_assert(file_name != NULL);
-  memset(file_name, '\0', buffer_len);
 
-  err = hwdbginfo_code_location_details(code_loc, &line_num, buffer_len ,file_name, &op_buffer_len);
+  if (dbg == NULL)
+    {
+      return op_ptr;
+    }
+
+  err = hwdbginfo_code_location_file(dbg, code_loc, &line_num, &file_id);
   gdb_assert(err == HWDBGINFO_E_SUCCESS);
 
-  if ((file_name == NULL) || (dbg == NULL))
+  /* The file name is owned by dbg */
+  if (hwdbginfo_file_name(dbg, file_id, &file_name) != HWDBGINFO_E_SUCCESS)
     {
       return op_ptr;
     }
@@ -406,7 +482,6 @@ char* hsail_dbginfo_get_srcline_from_code_loc(const HwDbgInfo_debug dbg,
       op_ptr = hsail_utils_read_line_from_file(file_name, line_num);
     }
 
-  xfree(file_name);
   return op_ptr;
 }
 
@@ -507,41 +582,305 @@ bool hsail_dbginfo_search_linemapping(const char* ip_arg)
 
 /* This function takes in the debuginfo handle so that it can
  * get the source buffer for gdb.
+ * The line is looked up in the line offsets of the source buffer,
+ * NULL is returned if the source has no such line.
  */
 char* hsail_dbginfo_get_srcline_from_buffer(const HwDbgInfo_debug dbg,
                                             const HwDbgInfo_linenum line_num)
 {
+  size_t line_start = 0;
+  size_t line_end = 0;
 
-  int temp_file_desc = -1;
-  char temp_file_name[] = "/tmp/rocm_dbg_XXXXXX";
+  gdb_assert(dbg != NULL);
 
-  FILE* temp_file_handle = NULL;
-  char* op_line = NULL;
-  int status = 0;
+  if (gs_hsail_source == NULL || gs_hsail_source_line_offsets == NULL ||
+      line_num < 1 || (size_t)line_num > gs_hsail_source_num_lines)
+    {
+      return NULL;
+    }
+
+  line_start = gs_hsail_source_line_offsets[line_num - 1];
+  line_end = gs_hsail_source_line_offsets[line_num];
+
+  /*op_line will be free'd by the breakpoint request that for the source line */
+  return hsail_utils_format_source_line(gs_hsail_source + line_start,
+                                        line_end - line_start);
+}
+
+
+/* Return the cached debug information of a code object or NULL */
+static HwDbgInfo_debug hsail_dbginfo_cache_lookup(uint64_t hash, uint64_t size)
+{
+  int i = 0;
+
+  for (i = 0; i < HSAIL_CODE_OBJECT_CACHE_SIZE; i++)
+    {
+      if (gs_dbginfo_cache[i].dbg != NULL &&
+          gs_dbginfo_cache[i].hash == hash &&
+          gs_dbginfo_cache[i].size == size)
+        {
+          gs_dbginfo_cache[i].last_use = ++gs_dbginfo_cache_use_count;
+          return gs_dbginfo_cache[i].dbg;
+        }
+    }
+
+  return NULL;
+}
+
+/* The entry to fill next, a free one or else the least recently used */
+static int hsail_dbginfo_cache_victim(void)
+{
+  int i = 0;
+  int victim = 0;
+
+  for (i = 0; i < HSAIL_CODE_OBJECT_CACHE_SIZE; i++)
+    {
+      if (gs_dbginfo_cache[i].dbg == NULL)
+        {
+          return i;
+        }
+      if (gs_dbginfo_cache[i].last_use < gs_dbginfo_cache[victim].last_use)
+        {
+          victim = i;
+        }
+    }
+
+  return victim;
+}
+
+static void hsail_dbginfo_cache_insert(uint64_t hash, uint64_t size, HwDbgInfo_debug dbg)
+{
+  int victim = hsail_dbginfo_cache_victim();
 
   gdb_assert(dbg != NULL);
 
-  /* Get a temp file name, mkstemp will populate the XXXXXX in temp_file_name
-   *  we dont use the desc, we will open the file using fopen*/
-  temp_file_desc = mkstemp(temp_file_name);
-  gdb_assert(temp_file_desc  != -1);
+  if (gs_dbginfo_cache[victim].dbg != NULL)
+    {
+      gdb_assert(gs_dbginfo_cache[victim].dbg != gs_DbgInfo);
+      hwdbginfo_release_debug_info(&gs_dbginfo_cache[victim].dbg);
+    }
 
-  temp_file_handle = fopen(temp_file_name,"wb");
-  gdb_assert(temp_file_handle != NULL);
+  gs_dbginfo_cache[victim].hash = hash;
+  gs_dbginfo_cache[victim].size = size;
+  gs_dbginfo_cache[victim].dbg = dbg;
+  gs_dbginfo_cache[victim].last_use = ++gs_dbginfo_cache_use_count;
+}
 
-  fprintf(temp_file_handle, "%s",gs_hsail_source);
+/* List the cached code objects for the agent, except the one that would be evicted next */
+static void hsail_dbginfo_cache_publish(HsailCodeObjectHeader* header)
+{
+  int victim = hsail_dbginfo_cache_victim();
+  uint32_t num_hashes = 0;
+  int i = 0;
 
-  fclose(temp_file_handle);
-  op_line = hsail_utils_read_line_from_file(temp_file_name, line_num);
+  __atomic_store_n(&header->m_numCachedHashes, 0, __ATOMIC_RELEASE);
+
+  for (i = 0; i < HSAIL_CODE_OBJECT_CACHE_SIZE; i++)
+    {
+      if (gs_dbginfo_cache[i].dbg != NULL && i != victim)
+        {
+          header->m_cachedHashes[num_hashes++] = gs_dbginfo_cache[i].hash;
+        }
+    }
+
+  __atomic_store_n(&header->m_numCachedHashes, num_hashes, __ATOMIC_RELEASE);
+}
+
+/* Release all the cached debug information, called when gdb is shut down */
+void hsail_dbginfo_clear_cache(void)
+{
+  int i = 0;
 
-  /* Delete tmp file */
-  status = remove(temp_file_name);
-  gdb_assert(status == 0);
+  hsail_free_hwdbginfo();
 
-  /*op_line will be free'd by the breakpoint request that for the source line */
-  return op_line;
+  for (i = 0; i < HSAIL_CODE_OBJECT_CACHE_SIZE; i++)
+    {
+      if (gs_dbginfo_cache[i].dbg != NULL)
+        {
+          hwdbginfo_release_debug_info(&gs_dbginfo_cache[i].dbg);
+          gs_dbginfo_cache[i].dbg = NULL;
+        }
+    }
+}
+
+/* The parsed debug information of every code object is also saved as an index in
+ * the user cache directory, keyed by the code object hash and size. Later gdb
+ * sessions load the index instead of parsing the DWARF again */
+#define HSAIL_DBGINFO_INDEX_DIR "rocm-gdb"
+
+/* Create a directory and its missing parents, return false on failure */
+static bool hsail_dbginfo_index_make_dirs(char* dir_path)
+{
+  char* sep = NULL;
+
+  for (sep = strchr(dir_path + 1, '/'); ; sep = strchr(sep + 1, '/'))
+    {
+      if (sep != NULL)
+        {
+          *sep = '\0';
+        }
+
+      if (mkdir(dir_path, 0700) != 0 && errno != EEXIST)
+        {
+          if (sep != NULL)
+            {
+              *sep = '/';
+            }
+          return false;
+        }
+
+      if (sep == NULL)
+        {
+          return true;
+        }
+
+      *sep = '/';
+    }
+}
+
+/* Return the index path of a code object, or NULL if there is no cache directory.
+ * The directory is created if create_dir is set. The caller frees the path */
+static char* hsail_dbginfo_index_path(uint64_t hash, uint64_t size, bool create_dir)
+{
+  const char* cache_home = getenv("XDG_CACHE_HOME");
+  const char* home = getenv("HOME");
+  char* cache_dir = NULL;
+  char* path = NULL;
+
+  /* Relative XDG paths are invalid and are ignored */
+  if (cache_home != NULL && cache_home[0] == '/')
+    {
+      cache_dir = concat(cache_home, "/" HSAIL_DBGINFO_INDEX_DIR, (char*)NULL);
+    }
+  else if (home != NULL && home[0] == '/')
+    {
+      cache_dir = concat(home, "/.cache/" HSAIL_DBGINFO_INDEX_DIR, (char*)NULL);
+    }
+  else
+    {
+      return NULL;
+    }
+
+  if (!create_dir || hsail_dbginfo_index_make_dirs(cache_dir))
+    {
+      path = xstrprintf("%s/%016llx-%llu.idx", cache_dir,
+                        (unsigned long long)hash, (unsigned long long)size);
+    }
+
+  xfree(cache_dir);
+  return path;
+}
+
+/* Load the debug information of a code object from its index, NULL if it has none.
+ * An index that is damaged or was made by another HwDbgFacilities version is
+ * rejected by the library, and is replaced once the code object is parsed */
+static HwDbgInfo_debug hsail_dbginfo_index_load(uint64_t hash, uint64_t size)
+{
+  HwDbgInfo_debug dbg = NULL;
+  HwDbgInfo_err err = HWDBGINFO_E_UNEXPECTED;
+  char* path = hsail_dbginfo_index_path(hash, size, false);
+  void* data = NULL;
+  struct stat st;
+  int desc = -1;
+
+  if (path == NULL)
+    {
+      return NULL;
+    }
+
+  desc = gdb_open_cloexec(path, O_RDONLY, 0);
+  xfree(path);
+
+  if (desc < 0)
+    {
+      return NULL;
+    }
+
+  if (fstat(desc, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+      /* The library does not reference the index once initialized */
+      data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, desc, 0);
+      if (data != MAP_FAILED)
+        {
+          dbg = hwdbginfo_init_with_index(data, st.st_size, &err);
+          munmap(data, st.st_size);
+        }
+    }
+
+  close(desc);
+
+  return (err == HWDBGINFO_E_SUCCESS) ? dbg : NULL;
+}
+
+/* Save the index of a parsed code object, failures are ignored since the
+ * code object can always be parsed again */
+static void hsail_dbginfo_index_save(uint64_t hash, uint64_t size, HwDbgInfo_debug dbg)
+{
+  char* path = hsail_dbginfo_index_path(hash, size, true);
+  char* temp_path = NULL;
+  void* index = NULL;
+  size_t index_size = 0;
+  FILE* temp_file_handle = NULL;
+  bool saved = false;
+
+  if (path == NULL)
+    {
+      return;
+    }
+
+  if (hwdbginfo_serialize_index(dbg, 0, NULL, &index_size) == HWDBGINFO_E_SUCCESS &&
+      index_size > 0)
+    {
+      index = xmalloc(index_size);
+
+      if (hwdbginfo_serialize_index(dbg, index_size, index, &index_size) == HWDBGINFO_E_SUCCESS)
+        {
+          /* Write a temporary file and rename it, so other gdb sessions never
+           * read a partially written index */
+          temp_path = xstrprintf("%s.%ld.tmp", path, (long)getpid());
+          temp_file_handle = fopen(temp_path, "wb");
+
+          if (temp_file_handle != NULL)
+            {
+              saved = (fwrite(index, 1, index_size, temp_file_handle) == index_size);
+              saved = (fclose(temp_file_handle) == 0) && saved;
+              saved = saved && (rename(temp_path, path) == 0);
+
+              if (!saved)
+                {
+                  unlink(temp_path);
+                }
+            }
+
+          xfree(temp_path);
+        }
+
+      xfree(index);
+    }
+
+  xfree(path);
 }
 
+/* Does the code object buffer start with a HsailCodeObjectHeader, of any version */
+static bool hsail_dbginfo_is_code_object_framed(const void* pShm)
+{
+  return ((const HsailCodeObjectHeader*)pShm)->m_magic == HSAIL_CODE_OBJECT_MAGIC;
+}
+
+/* The header of the code object buffer, NULL if the agent wrote the legacy layout
+ * or a header version we do not know */
+static HsailCodeObjectHeader* hsail_dbginfo_code_object_header(void* pShm)
+{
+  HsailCodeObjectHeader* header = (HsailCodeObjectHeader*)pShm;
+
+  if (!hsail_dbginfo_is_code_object_framed(pShm)
+      || header->m_version != HSAIL_CODE_OBJECT_VERSION)
+    {
+      return NULL;
+    }
+
+  return header;
+}
 
 AgentBinaryNotification hsail_is_debug_facilities_loaded(void)
 {
@@ -576,9 +915,12 @@ HwDbgInfo_debug hsail_init_hwdbginfo(HsailNotificationPayload* payload)
   dbg_op = NULL;
   if(hsail_is_debug_facilities_loaded())
     {
-      /* A copy of the shared memory segment )*/
-      void* dbe_binary = NULL;
       size_t dbe_binary_size = 0;
+      const void* code_object = NULL;
+      uint64_t code_object_hash = 0;
+      bool is_code_object_copied = true;
+      HsailCodeObjectHeader* header = NULL;
+      const char* malformed_reason = NULL;
       int shmid = -1;
 
       hsail_segment_update_loadmap();
@@ -603,81 +945,150 @@ HwDbgInfo_debug hsail_init_hwdbginfo(HsailNotificationPayload* payload)
 
       gdb_assert(pShm != NULL);
 
-      dbe_binary_size = ((size_t*)pShm)[0];
+      header = hsail_dbginfo_code_object_header(pShm);
+      if (header != NULL)
+        {
+          dbe_binary_size = header->m_size;
+          code_object = header + 1;
+          code_object_hash = header->m_hash;
+          is_code_object_copied = (header->m_isCopied != 0);
+        }
+      else if (hsail_dbginfo_is_code_object_framed(pShm))
+        {
+          /* A newer agent layout cannot be read as the legacy one either */
+          malformed_reason = "unsupported header version";
+        }
+      else
+        {
+          dbe_binary_size = ((size_t*)pShm)[0];
+          code_object = (size_t*)pShm + 1;
+        }
 
-      gdb_assert(dbe_binary_size > 0 && dbe_binary_size < max_shared_mem_size);
+      /* The size is written by the agent, the code object must end inside the segment */
+      if (malformed_reason == NULL
+          && (dbe_binary_size == 0
+              || dbe_binary_size > (size_t)max_shared_mem_size - (size_t)((const char*)code_object - (char*)pShm)))
+        {
+          malformed_reason = "code object size outside the buffer";
+        }
 
-      dbe_binary = xmalloc(dbe_binary_size);
+      if (malformed_reason == NULL)
+        {
+          /* The agent does not hash the code object in the legacy layout */
+          if (header == NULL)
+            {
+              code_object_hash = HsailHashCodeObject(code_object, dbe_binary_size);
+            }
 
-      gdb_assert(dbe_binary != NULL);
+          /* The same code object is often dispatched many times in a row */
+          dbg_op = hsail_dbginfo_cache_lookup(code_object_hash, dbe_binary_size);
 
-      memcpy(dbe_binary,(size_t*)pShm+1,dbe_binary_size);
+          /* An earlier gdb session may have saved the code object's index */
+          if (dbg_op == NULL && hsail_cmd_get_index_cache_option())
+            {
+              dbg_op = hsail_dbginfo_index_load(code_object_hash, dbe_binary_size);
+              if (dbg_op != NULL)
+                {
+                  hsail_dbginfo_cache_insert(code_object_hash, dbe_binary_size, dbg_op);
+                }
+            }
+        }
 
+      if (dbg_op != NULL)
+        {
+          errout_twolevel = HWDBGINFO_E_SUCCESS;
+        }
+      else if (malformed_reason != NULL)
+        {
+          warning("[ROCm-gdb]: Ignoring the agent code object buffer, %s", malformed_reason);
+          errout_twolevel = HWDBGINFO_E_UNEXPECTED;
+        }
+      else if (!is_code_object_copied)
+        {
+          /* The agent skipped the copy for a code object that is no longer cached */
+          ui_out_text(uiout, "[ROCm-gdb]: The code object for the current dispatch is not available\n");
+          errout_twolevel = HWDBGINFO_E_UNEXPECTED;
+        }
+      else
+        {
+          /* Uncomment this call if you need to save the binary to the file
+          hsail_breakpoint_save_binary_to_file(dbe_binary_size, code_object);
+          */
 
-      /* Uncomment this call if you need to save the binary to the file
-      hsail_breakpoint_save_binary_to_file(dbe_binary_size, dbe_binary);
-      */
+          /* Attempt to initialize as a HSAIL backend binary.
+           * HwDbgFacilities parses the code object in place, and does not
+           * reference it once initialized, so no copy of the segment is needed.
+           * The agent does not touch the segment till we resume it */
+          dbg_op = hwdbginfo_init_with_hsa_1_0_binary(code_object,
+                                                      dbe_binary_size,
+                                                      &errout_twolevel);
 
-      /* Attempt to initialize as a HSAIL backend binary*/
-      dbg_op = hwdbginfo_init_with_hsa_1_0_binary(dbe_binary,
-                                                  dbe_binary_size,
-                                                  &errout_twolevel);
+          /* Keep this printf here as a reminder for a
+           * quick way to check that the IPC happened correctly*/
+          /*
+          int i = 0;
+          for(i = 0; i<10;i++)
+            {
+              printf("%d \t %d\n",i,*((const int*)code_object + i));
+            } */
 
-      /* Keep this printf here as a reminder for a
-       * quick way to check that the IPC happened correctly*/
-      /*
-      int i = 0;
-      for(i = 0; i<10;i++)
-        {
-          printf("%d \t %d\n",i,*((int*)dbe_binary + i));
-        } */
+          /* If we get a no HL binary, return code, we try to initialize as a single level binary */
+          if (errout_twolevel == HWDBGINFO_E_NOHLBINARY)
+            {
+              /*
+              dbg_op = hwdbginfo_init_with_single_level_binary(code_object,
+                                                               dbe_binary_size,
+                                                               &errout_onelevel);
+              */
+              dbg_op = NULL;
+            }
 
-      /* If we get a no HL binary, return code, we try to initialize as a single level binary */
-      if (errout_twolevel == HWDBGINFO_E_NOHLBINARY)
-        {
           /*
-          dbg_op = hwdbginfo_init_with_single_level_binary(dbe_binary,
-                                                           dbe_binary_size,
-                                                           &errout_onelevel);
-          */
-          dbg_op = NULL;
-        }
+           * In the near future, debug facilities needs to be able to tell the difference
+           * between an incomplete 2 level code object and a complete 1 level code object.
+           * Since we dont support debugging LC for 1.3, this is not a big issue.
+           *  */
+
+          /* If we have a single level binary, thats good, we dont need to check the
+           * two level return code */
+          if (errout_twolevel == HWDBGINFO_E_NOHLBINARY && errout_onelevel == HWDBGINFO_E_SUCCESS)
+            {
+              fflush(stdout);
+            }
+          else if (errout_twolevel != HWDBGINFO_E_SUCCESS )
+            {
+              /* HwDbgFacilities init: Called DebugFacilities Incorrectly.
+               * We can add more detailed messages such as low-level dwarf or high level dwarf missing in the future
+               * */
+              ui_out_text(uiout, "[ROCm-gdb]: The code object for the current dispatch does not contain debug information\n");
+              fflush(stdout);
 
-      /*
-       * In the near future, debug facilities needs to be able to tell the difference
-       * between an incomplete 2 level code object and a complete 1 level code object.
-       * Since we dont support debugging LC for 1.3, this is not a big issue.
-       *  */
+              dbg_op = NULL;
 
-      /* If we have a single level binary, thats good, we dont need to check the
-       * two level return code */
-      if (errout_twolevel == HWDBGINFO_E_NOHLBINARY && errout_onelevel == HWDBGINFO_E_SUCCESS)
-        {
-          fflush(stdout);
-        }
-      else if (errout_twolevel != HWDBGINFO_E_SUCCESS )
-        {
-          /* HwDbgFacilities init: Called DebugFacilities Incorrectly.
-           * We can add more detailed messages such as low-level dwarf or high level dwarf missing in the future
-           * */
-          ui_out_text(uiout, "[ROCm-gdb]: The code object for the current dispatch does not contain debug information\n");
-          fflush(stdout);
+            }
 
-          dbg_op = NULL;
 
-        }
+          /* Test function to print all the mapped addresses and line numbers */
+          /* hsail_dbginfo_test_all_mapped_addrs(dbg_op); */
 
+          /* Only debug information that could be used is cached */
+          if (errout_twolevel == HWDBGINFO_E_SUCCESS && dbg_op != NULL)
+            {
+              hsail_dbginfo_cache_insert(code_object_hash, dbe_binary_size, dbg_op);
 
-      /* Test function to print all the mapped addresses and line numbers */
-      /* hsail_dbginfo_test_all_mapped_addrs(dbg_op); */
+              if (hsail_cmd_get_index_cache_option())
+                {
+                  hsail_dbginfo_index_save(code_object_hash, dbe_binary_size, dbg_op);
+                }
+            }
+        }
 
-      /* We can clear the dbe_binary buffer once we have initialized HWDbgFacilities */
-      if (dbe_binary != NULL)
+      /* Let the agent know which code objects it does not need to copy */
+      if (header != NULL)
         {
-          free_current_contents(&dbe_binary);
+          hsail_dbginfo_cache_publish(header);
         }
 
-
       /* Get the kernel source, only if the 2 level initialization was good*/
       if (errout_twolevel == HWDBGINFO_E_SUCCESS)
         {
@@ -704,6 +1115,8 @@ HwDbgInfo_debug hsail_init_hwdbginfo(HsailNotificationPayload* payload)
    * Debug Facilities API */
 }
 
+/* Drop the debug information of the active code object,
+ * it stays in the cache for the next dispatches of the same code object */
 void hsail_free_hwdbginfo(void)
 {
   if (gs_DbgInfo == NULL)
@@ -714,9 +1127,6 @@ void hsail_free_hwdbginfo(void)
     {
       gdb_assert(gs_DbgInfo!= NULL);
 
-      /* Release the debug info handle: */
-      hwdbginfo_release_debug_info(&gs_DbgInfo);
-
       gs_DbgInfo = NULL;
 
       if (active_kernel_src_file_path != NULL)
@@ -42,12 +42,19 @@ char* hsail_dbginfo_get_srcline_from_buffer(const HwDbgInfo_debug dbg,
                                             const HwDbgInfo_linenum line_num);
 
 /* Note: The input pc has to be in the elf va form. The segment loader API should
- * resolve this before calling this function */
+ * resolve this before calling this function.
+ * The file name is owned by the debug info and must not be freed */
 bool hsail_dbginfo_get_pc_info(HwDbgInfo_addr pc,
-                               HwDbgInfo_linenum* op_line_num,  char** op_file_name);
+                               HwDbgInfo_linenum* op_line_num,  const char** op_file_name);
+
+/* The file name of an interned file path ID, "" if there is none.
+ * The file name is owned by the debug info and must not be freed */
+const char* hsail_dbginfo_get_file_name(HwDbgInfo_debug dbg, HwDbgInfo_fileid file_id);
 
 char* hsail_dbginfo_get_source_buffer(void);
 
+bool hsail_dbginfo_save_source_to_file(void);
+
 const char* hsail_dbginfo_get_active_file_name(void);
 
 bool hsail_dbginfo_search_linemapping(const char* ip_hsail_bp_str);
@@ -63,4 +70,6 @@ HwDbgInfo_debug hsail_init_hwdbginfo(HsailNotificationPayload* payload);
 
 void hsail_free_hwdbginfo(void);
 
+void hsail_dbginfo_clear_cache(void);
+
 #endif
@@ -292,15 +292,91 @@ void hsail_flush_breakpoint_command_buffer(void)
 //  gs_hsail_command_buffer_len = 0;
 }
 
-static void hsail_push_command(HsailCommandPacket packet)
+/* Write a single packet to the gdb --> agent fifo */
+static void hsail_write_command_to_fifo(const HsailCommandPacket* packet)
 {
   int bytes_written = 0;
   int push_errno = 0;
 
   int file_desc = hsail_get_fifo_handler();
 
-  gdb_assert (file_desc > 0);
+  gdb_assert(file_desc > 0);
+  gdb_assert(packet != NULL);
+
+  bytes_written = write(file_desc, packet, sizeof(HsailCommandPacket));
+  push_errno = errno;
+
+  /* We only let the EPIPE case slide here
+  if (bytes_written != sizeof(HsailCommandPacket) && push_errno == EPIPE)
+    {
+      printf_filtered("[ROCm-gdb]: HSA may have been shutdown already\n");
+    }
+  else
+    {
+      gdb_assert(bytes_written == sizeof(HsailCommandPacket));
+    }
+  */
+}
+
+/* Put a packet in the shared memory command ring.
+ *
+ * GDB is the only producer so m_head is only read back by us, the acquire on
+ * m_tail makes sure the agent is done with the slot before we overwrite it.
+ * The doorbell is only written to the fifo if the agent has said that it is
+ * going to sleep on the fifo, which is only done once the ring is empty.
+ *
+ * Returns false if the ring is not available or full, or if a packet that
+ * overflowed to the fifo has not been consumed by the agent yet. The caller
+ * should then use the fifo. The agent drains the ring before acting on a fifo
+ * packet, so the ring packets written before an overflow keep their order, and
+ * later packets stay on the fifo until the agent has caught up with it.
+ * */
+static bool hsail_push_command_to_ring(const HsailCommandPacket* packet)
+{
+  HsailCommandRing* ring = hsail_tdep_get_command_ring();
+  HsailCommandPacket doorbell_packet;
+  uint64_t head = 0;
+  uint64_t tail = 0;
+
+  if (ring == NULL)
+    {
+      return false;
+    }
+
+  /* A ring packet could be acted on before a pending fifo packet */
+  if (__atomic_load_n(&ring->m_fifoPacketsConsumed, __ATOMIC_ACQUIRE) != ring->m_fifoPacketsWritten)
+    {
+      return false;
+    }
 
+  head = ring->m_head;
+  tail = __atomic_load_n(&ring->m_tail, __ATOMIC_ACQUIRE);
+
+  if (head - tail >= HSAIL_COMMAND_RING_CAPACITY)
+    {
+      return false;
+    }
+
+  memcpy(&ring->m_packets[head & (HSAIL_COMMAND_RING_CAPACITY - 1)],
+         packet, sizeof(HsailCommandPacket));
+
+  /* The sequentially consistent store and exchange pair with the agent setting
+   * m_consumerWaiting and then re-reading m_head, so either the agent sees the
+   * new packet or we see that it is waiting */
+  __atomic_store_n(&ring->m_head, head + 1, __ATOMIC_SEQ_CST);
+
+  if (__atomic_exchange_n(&ring->m_consumerWaiting, 0, __ATOMIC_SEQ_CST) != 0)
+    {
+      hsail_fifo_initialize_packet(&doorbell_packet);
+      doorbell_packet.m_command = HSAIL_COMMAND_RING_DOORBELL;
+      hsail_write_command_to_fifo(&doorbell_packet);
+    }
+
+  return true;
+}
+
+static void hsail_push_command(HsailCommandPacket packet)
+{
   /* It may be tempting to add the call to flush the command buffer here too
    * hsail_flush_command_buffer();
    * However that is logically wrong since the flush is triggered from linux_nat_wait
@@ -313,22 +389,19 @@ static void hsail_push_command(HsailCommandPacket packet)
 
   hsail_validate_command_packet(packet);
 
-  gdb_assert(file_desc > 0);
-  bytes_written = 0;
+  /* The fifo is kept as the fallback transport */
+  if (!hsail_push_command_to_ring(&packet))
+    {
+      HsailCommandRing* ring = hsail_tdep_get_command_ring();
 
-  bytes_written = write(file_desc, &packet ,sizeof(HsailCommandPacket));
-  push_errno = errno;
+      /* Count the packet before the agent can consume it */
+      if (ring != NULL)
+        {
+          __atomic_store_n(&ring->m_fifoPacketsWritten, ring->m_fifoPacketsWritten + 1, __ATOMIC_RELEASE);
+        }
 
-  /* We only let the EPIPE case slide here
-  if (bytes_written != sizeof(HsailCommandPacket) && push_errno == EPIPE)
-    {
-      printf_filtered("[ROCm-gdb]: HSA may have been shutdown already\n");
-    }
-  else
-    {
-      gdb_assert(bytes_written == sizeof(HsailCommandPacket));
+      hsail_write_command_to_fifo(&packet);
     }
-  */
 }
 
 /*
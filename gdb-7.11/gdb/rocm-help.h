@@ -44,7 +44,9 @@ HSAIL_PRINT_HELP_ARGS()
 "set rocm trace [on|off] \t   Enable/Disable tracing of GPU dispatches\n"\
 "set rocm trace <filename> \t   Save GPU dispatch trace to <filename>\n"\
 "set rocm logging [on|off] \t   Enable/Disable internal logging\n"\
-"set rocm show-isa [on|off] \t   Enable/Disable saving ISA to a temp_isa file when in GPU dispatches\n"
+"set rocm show-isa [on|off] \t   Enable/Disable saving ISA to a temp_isa file when in GPU dispatches\n"\
+"set rocm save-source [on|off] \t   Enable/Disable saving the GPU kernel source to a temp_source file\n"\
+"set rocm index-cache [on|off] \t   Enable/Disable caching the GPU kernel debug information in ~/.cache/rocm-gdb\n"
 
 #define HSAIL_SHOW_CMD_HELP()\
 "Show the current ROCm specific configuration options: \n"\
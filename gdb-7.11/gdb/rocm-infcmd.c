@@ -105,6 +105,7 @@ static void hsail_step_write_momentary_breakpoints(HwDbgInfo_debug dbg,
 {
   int i = 0;
   HsailMomentaryBP* momentary_bp = NULL;
+  HwDbgInfo_linenum* line_nums = NULL;
 
   int momentary_bp_data_size = 0;
   int momentary_bp_shmem_size = 0;
@@ -131,22 +132,22 @@ static void hsail_step_write_momentary_breakpoints(HwDbgInfo_debug dbg,
 
   memset(momentary_bp, 0, momentary_bp_shmem_size);
 
+  /* Resolve the lines of all the addresses in one query,
+   * unmapped addresses are left at line 0 */
+  line_nums = XCNEWVEC(HwDbgInfo_linenum, step_addr_count);
+  hwdbginfo_addrs_to_lines(dbg, step_addr_count, step_addrs, line_nums, NULL);
+
   for(i=0; i < step_addr_count; i++)
     {
-      HwDbgInfo_code_location loc = NULL;
-      HwDbgInfo_linenum line_num = 0;
-      uint64_t mem_va_addr = 0;
       bool ret_code = false;
 
-      hwdbginfo_addr_to_line(dbg, step_addrs[i], &loc);
-      hwdbginfo_code_location_details(loc, &line_num, 0, NULL, NULL);
-
       ret_code = hsail_segment_resolve_elfva(step_addrs[i], &(momentary_bp[i].m_pc));
       gdb_assert(ret_code == true);
 
-      momentary_bp[i].m_lineNum = line_num;
+      momentary_bp[i].m_lineNum = line_nums[i];
     }
 
+  xfree(line_nums);
   hsail_tdep_unmap_shm_buffer((void*)momentary_bp);
 }
 
@@ -30,6 +30,11 @@
 
 /* GDB headers */
 #include "defs.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
 #include "expression.h"
 #include "format.h"
 #include "gdb_assert.h"
@@ -44,6 +49,7 @@
 #include "rocm-segment-loader.h"
 #include "rocm-tdep.h"
 #include "rocm-utils.h"
+#include "rocm-wave.h"
 
 #include "CommunicationControl.h"
 
@@ -572,71 +578,19 @@ void hsail_print_wave_info (struct ui_out* uiout, int from_tty)
   printf_filtered("Number of Active Waves: %d\n",num_waves);
 }
 
-/* build a vector of work groups, this is used when printing the work-groups, but also when printing a specific work group so it will related to the same
-   position since in the wave buffer two elements can have the same work group so a vector is created where each work group appears only once and the
-   index refer to the work group and from this vector the work group info can be retrieved */
-static HsailWaveDim3* gs_workgroup_vector = NULL;
-static int gs_num_workgroups_in_vector = 0;
-
-static void hsail_build_workgroups_vector(void)
-{
-  int nWave = 0;
-  int checked_group = 0;
-  bool workgroup_found = false;
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-
-  gdb_assert(NULL != wave_info_buffer);
-
-  /* allocated memory for a buffer to hold the work group we already found. worst case is every wave belongs to a different group */
-  free_current_contents(&gs_workgroup_vector);
-  gs_workgroup_vector= (HsailWaveDim3*)malloc(sizeof(HsailWaveDim3)*num_waves);
-  gdb_assert(NULL != gs_workgroup_vector);
-
-  gs_num_workgroups_in_vector = 0;
-
-  for (nWave = 0 ; nWave < num_waves ; nWave++)
-  {
-    workgroup_found = false;
-    /* check if the work group was not already found */
-    for (checked_group = 0 ; checked_group < gs_num_workgroups_in_vector ; checked_group++)
-    {
-      if (gs_workgroup_vector[checked_group].x == wave_info_buffer[nWave].workGroupId.x &&
-          gs_workgroup_vector[checked_group].y == wave_info_buffer[nWave].workGroupId.y &&
-          gs_workgroup_vector[checked_group].z == wave_info_buffer[nWave].workGroupId.z)
-          {
-            workgroup_found = true;
-            break;
-          }
-    }
-
-    /* if new group in the wave add it */
-    if (!workgroup_found)
-    {
-      gs_workgroup_vector[gs_num_workgroups_in_vector].x = wave_info_buffer[nWave].workGroupId.x;
-      gs_workgroup_vector[gs_num_workgroups_in_vector].y = wave_info_buffer[nWave].workGroupId.y;
-      gs_workgroup_vector[gs_num_workgroups_in_vector].z = wave_info_buffer[nWave].workGroupId.z;
-      gs_num_workgroups_in_vector++;
-    }
-  }
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_shm_buffer((void*)wave_info_buffer);
-}
-
+/* The work-group index shown by "info rocm work-groups" is the position of the work-group in the
+   wave snapshot, so that it refers to the same group when printing a specific work group */
 void hsail_print_workgroups_info (HsailWaveDim3 active_work_group, struct ui_out* uiout, int from_tty)
 {
   int nWorkgroup = 0;
   /* get the waves info */
+  const struct hsail_wave_snapshot* snapshot = hsail_wave_get_snapshot();
 
-  int num_waves = hsail_tdep_get_active_wave_count();
   int flattened_id = 0;
   int workgroupsizex = 0;
   int workgroupsizey = 0;
   struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
 
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-
   char index_buffer[10] = "";
   char wg_id_buffer[30] = "";
   char flat_id_buffer[10] = "";
@@ -646,15 +600,12 @@ void hsail_print_workgroups_info (HsailWaveDim3 active_work_group, struct ui_out
   gdb_assert(NULL != uiout);
   gdb_assert(NULL != active_dispatch);
 
-  if (0 == num_waves || NULL == wave_info_buffer)
+  if (NULL == snapshot)
   {
     hsail_print_no_wave_msg(uiout, "work-groups");
     return;
   }
 
-  /* build the vector list */
-  hsail_build_workgroups_vector();
-
   /* print header */
   ui_out_text(uiout,"Active Work-groups Information\n");
   printf_filtered("%5s%15s%27s\n","Index","Work-group ID","Flattened Work-group ID");
@@ -666,45 +617,198 @@ void hsail_print_workgroups_info (HsailWaveDim3 active_work_group, struct ui_out
     workgroupsizey = (active_dispatch->work_items.y == 0 ? 1 : active_dispatch->work_items.y) / (active_dispatch->work_groups_size.y == 0 ? 1 : active_dispatch->work_groups_size.y);
   }
 
-  for (nWorkgroup = 0 ; nWorkgroup < gs_num_workgroups_in_vector ; nWorkgroup++)
+  for (nWorkgroup = 0 ; nWorkgroup < snapshot->num_work_groups ; nWorkgroup++)
   {
-    found_workgroup = false;
+    const HsailWaveDim3* work_group = &snapshot->work_groups[nWorkgroup];
+
     /* based on the equation in HSA programmer Ref page 22 sec 2.2.2 */
     if (NULL != active_dispatch)
     {
-      flattened_id = gs_workgroup_vector[nWorkgroup].x +
-                     gs_workgroup_vector[nWorkgroup].y * workgroupsizex +
-                     gs_workgroup_vector[nWorkgroup].z * workgroupsizex * workgroupsizey;
+      flattened_id = work_group->x +
+                     work_group->y * workgroupsizex +
+                     work_group->z * workgroupsizex * workgroupsizey;
     }
 
-    if (gs_workgroup_vector[nWorkgroup].x == active_work_group.x &&
-        gs_workgroup_vector[nWorkgroup].y == active_work_group.y &&
-        gs_workgroup_vector[nWorkgroup].z == active_work_group.z)
-        {
-          found_workgroup = true;
-        }
+    found_workgroup = hsail_utils_compare_wavedim3(work_group, &active_work_group);
 
     sprintf(index_buffer,"%s%d", found_workgroup ? "*" : "", nWorkgroup);
-    sprintf(wg_id_buffer,"%d,%d,%d",gs_workgroup_vector[nWorkgroup].x,
-                                    gs_workgroup_vector[nWorkgroup].y,
-                                    gs_workgroup_vector[nWorkgroup].z);
+    sprintf(wg_id_buffer,"%d,%d,%d",work_group->x,
+                                    work_group->y,
+                                    work_group->z);
     sprintf(flat_id_buffer,"%d",flattened_id);
 
     printf_filtered("%5s%15s%27s\n", index_buffer, wg_id_buffer, flat_id_buffer);
   }
+}
 
-  /* release the vector data */
-  free_current_contents(&gs_workgroup_vector);
-  gs_num_workgroups_in_vector = 0;
+/* The source lines of the distinct PCs of a wave listing, resolved before the waves are printed.
+   All the arrays have count elements, in the order of the sorted PCs */
+struct hsail_print_pc_sources
+{
+  size_t count;
+  uint64_t* pcs;
+  HwDbgInfo_addr* elfva_addrs;
+  HwDbgInfo_addr* mapped_addrs;
+  HwDbgInfo_linenum* line_nums;
+  HwDbgInfo_fileid* file_ids;
+};
+
+/* A run of the distinct PCs resolved by one worker thread */
+struct hsail_print_pc_source_work
+{
+  HwDbgInfo_debug dbg;
+  struct hsail_print_pc_sources* sources;
+  size_t first;
+  size_t count;
+};
+
+/* The most threads used to resolve the PCs of a wave listing, and the fewest distinct PCs
+   given to a thread. A listing with fewer distinct PCs is resolved by the calling thread */
+#define HSAIL_PRINT_RESOLVE_MAX_THREADS 8
+#define HSAIL_PRINT_RESOLVE_MIN_PCS_PER_THREAD 64
+
+static int hsail_print_compare_pcs(const void* a, const void* b)
+{
+  uint64_t pc_a = *(const uint64_t*)a;
+  uint64_t pc_b = *(const uint64_t*)b;
 
-  /* release the wave buffer */
-  hsail_tdep_unmap_shm_buffer((void*)wave_info_buffer);
+  return (pc_a < pc_b) ? -1 : ((pc_a > pc_b) ? 1 : 0);
+}
 
+/* Resolve a run of PCs to their source lines, with one batched query per step. Only the debug
+   facilities are used, so this may run on a worker thread once the debug info is frozen */
+static void* hsail_print_resolve_pc_sources_worker(void* data)
+{
+  struct hsail_print_pc_source_work* work = (struct hsail_print_pc_source_work*)data;
+  struct hsail_print_pc_sources* sources = work->sources;
+  HwDbgInfo_addr* mapped_addrs = &sources->mapped_addrs[work->first];
+  HwDbgInfo_err dbgErr = HWDBGINFO_E_SUCCESS;
+  size_t i = 0;
+
+  if (0 == work->count)
+    {
+      return NULL;
+    }
+
+  dbgErr = hwdbginfo_nearest_mapped_addrs(work->dbg, work->count,
+                                          (const HwDbgInfo_addr*)(&sources->pcs[work->first]),
+                                          mapped_addrs);
+
+  /* A PC without a nearest mapped address (given as 0) uses the segment's elf va as is */
+  if (HWDBGINFO_E_SUCCESS != dbgErr)
+    {
+      for (i = 0; i < work->count; i++)
+        {
+          if (0 == mapped_addrs[i])
+            {
+              mapped_addrs[i] = sources->elfva_addrs[work->first + i];
+            }
+        }
+    }
+
+  hwdbginfo_addrs_to_lines(work->dbg, work->count, mapped_addrs,
+                           &sources->line_nums[work->first], &sources->file_ids[work->first]);
+
+  return NULL;
 }
 
-static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo,
-                                  HsailAgentWaveInfo* wave_info_buffer,
-                                  int wave_index, int index_to_show, HsailWaveDim3 work_item, bool use_work_item, bool mark_active_item)
+/* Resolve the source lines of the distinct PCs of a wave listing. Many waves usually share
+   a handful of PCs, so each PC is resolved once, and a large set is split across threads */
+static void hsail_print_resolve_pc_sources(HwDbgInfo_debug dbgInfo,
+                                           struct hsail_print_pc_sources* sources)
+{
+  struct hsail_print_pc_source_work works[HSAIL_PRINT_RESOLVE_MAX_THREADS];
+  pthread_t threads[HSAIL_PRINT_RESOLVE_MAX_THREADS];
+  bool is_thread_started[HSAIL_PRINT_RESOLVE_MAX_THREADS];
+  sigset_t all_signals_mask;
+  sigset_t orig_mask;
+  size_t thread_count = sources->count / HSAIL_PRINT_RESOLVE_MIN_PCS_PER_THREAD;
+  long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t next_source = 0;
+  size_t i = 0;
+
+  /* The segment loader is not thread safe, so all the PCs are moved to elf va here */
+  for (i = 0; i < sources->count; i++)
+    {
+      uint64_t elfva_addr = 0;
+
+      gdb_assert(hsail_segment_resolve_memva(sources->pcs[i], &elfva_addr) == true);
+      sources->elfva_addrs[i] = (HwDbgInfo_addr)elfva_addr;
+      sources->line_nums[i] = 0;
+      sources->file_ids[i] = HWDBGINFO_FILEID_NONE;
+    }
+
+  if (cpu_count > 0 && thread_count > (size_t)cpu_count)
+    {
+      thread_count = (size_t)cpu_count;
+    }
+  if (thread_count > HSAIL_PRINT_RESOLVE_MAX_THREADS)
+    {
+      thread_count = HSAIL_PRINT_RESOLVE_MAX_THREADS;
+    }
+
+  /* The debug info may only be queried from several threads once it is frozen */
+  if (thread_count > 1 && hwdbginfo_freeze(dbgInfo) != HWDBGINFO_E_SUCCESS)
+    {
+      thread_count = 1;
+    }
+  if (thread_count == 0)
+    {
+      thread_count = 1;
+    }
+
+  /* gdb's signal handlers must run on the main thread, so the workers inherit an
+     all-signals-blocked mask. Without it the PCs are all resolved by this thread */
+  sigfillset(&all_signals_mask);
+  if (thread_count > 1 && pthread_sigmask(SIG_SETMASK, &all_signals_mask, &orig_mask) != 0)
+    {
+      thread_count = 1;
+    }
+
+  for (i = 0; i < thread_count; i++)
+    {
+      size_t run_length = (sources->count - next_source) / (thread_count - i);
+
+      works[i].dbg = dbgInfo;
+      works[i].sources = sources;
+      works[i].first = next_source;
+      works[i].count = run_length;
+      next_source += run_length;
+
+      /* The last run is resolved by this thread, as is any run whose thread cannot start */
+      is_thread_started[i] = (i + 1 < thread_count) &&
+                             (pthread_create(&threads[i], NULL,
+                                             hsail_print_resolve_pc_sources_worker, &works[i]) == 0);
+    }
+
+  if (thread_count > 1)
+    {
+      pthread_sigmask(SIG_SETMASK, &orig_mask, NULL);
+    }
+
+  for (i = 0; i < thread_count; i++)
+    {
+      if (!is_thread_started[i])
+        {
+          hsail_print_resolve_pc_sources_worker(&works[i]);
+        }
+    }
+
+  for (i = 0; i < thread_count; i++)
+    {
+      if (is_thread_started[i])
+        {
+          pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+/* Print the table row of a wave, source_line is the text of the wave's PC */
+static void hsail_print_wave_row(struct ui_out* uiout,
+                                 const struct hsail_wave_snapshot* snapshot,
+                                 int wave_index, int index_to_show, uint64_t lane_mask,
+                                 bool use_work_item, bool mark_active_item,
+                                 const char* source_line)
 {
 
   /* layout structure of the hardware slot ids for the wavefront id*/
@@ -724,164 +828,208 @@ static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo,
   };
   union WavefrontSlots waveSlots = {{0}};
 
-  /* vars used to pass through the exec mask */
-  int nExec = 0;
-  bool firstExec = true;
+  /* the first and last lanes printed, either of all the active lanes or of the ones running the filter work item */
   int last_bit_num = 0;
   int first_bit_num = 0;
-  /* current_bit_mask used with the exec mask */
-  uint64_t current_bit_mask = 1;
+  HsailWaveDim3 first_work_item;
+  HsailWaveDim3 last_work_item;
+  const HsailAgentWaveInfo* wave_info = &snapshot->waves[wave_index];
   struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
-  bool found_work_item = false;
+  struct cleanup* row_chain = NULL;
 
+  if (0 != lane_mask)
+    {
+      first_bit_num = hsail_wave_first_lane(lane_mask);
+      last_bit_num = hsail_wave_last_lane(lane_mask);
+    }
+  hsail_wave_get_work_item(snapshot, wave_index, first_bit_num, &first_work_item);
+  hsail_wave_get_work_item(snapshot, wave_index, last_bit_num, &last_work_item);
 
-  char index_buffer[10] = "";
-  char wave_addr_buffer[60] = "";
-  char wi_id1_buffer[30] = "";
-  char wi_id2_buffer[30] = "";
-  char wi_id_buffer[60] = "";
-  char abs_wi_id1_buffer[30] = "";
-  char abs_wi_id2_buffer[30] = "";
-  char abs_wi_id_buffer[60] = "";
-  char source_line_buffer[256] = "";
-  char pc_buffer[30] = "";
-
-  gdb_assert(NULL != wave_info_buffer);
+  row_chain = make_cleanup_ui_out_tuple_begin_end(uiout, "wave");
 
   /* print the index and the wave front id */
+  ui_out_field_fmt(uiout, "index", "%s%d", mark_active_item ? "*": "", index_to_show);
+
+  waveSlots.u32All = wave_info->waveAddress;
+  ui_out_field_fmt(uiout, "wave-id", "0x%x {%2d,%2d,%2d,%4d,%4d}",
+                   wave_info->waveAddress,
+                   waveSlots.bits.se_id,
+                   waveSlots.bits.sh_id,
+                   waveSlots.bits.cu_id,
+                   waveSlots.bits.simd_id,
+                   waveSlots.bits.wave_id);
+
+  if (!use_work_item)
+    {
+      ui_out_field_fmt(uiout, "work-item-id", "[%2d,%2d,%2d - %2d,%2d,%2d]",
+                       first_work_item.x, first_work_item.y, first_work_item.z,
+                       last_work_item.x, last_work_item.y, last_work_item.z);
+    }
+  else
+    {
+      ui_out_field_fmt(uiout, "work-item-id", "[%2d,%2d,%2d]",
+                       first_work_item.x, first_work_item.y, first_work_item.z);
+    }
+
+  /* print absolute work-item id */
+  if (NULL != active_dispatch)
+    {
+      uint32_t baseX = wave_info->workGroupId.x * active_dispatch->work_groups_size.x;
+      uint32_t baseY = wave_info->workGroupId.y * active_dispatch->work_groups_size.y;
+      uint32_t baseZ = wave_info->workGroupId.z * active_dispatch->work_groups_size.z;
+      if (!use_work_item)
+        {
+          ui_out_field_fmt(uiout, "absolute-work-item-id", "[%3d,%3d,%3d - %3d,%3d,%3d]",
+                           baseX + first_work_item.x,
+                           baseY + first_work_item.y,
+                           baseZ + first_work_item.z,
+                           baseX + last_work_item.x,
+                           baseY + last_work_item.y,
+                           baseZ + last_work_item.z);
+        }
+      else
+        {
+          ui_out_field_fmt(uiout, "absolute-work-item-id", "[%3d,%3d,%3d]",
+                           baseX + first_work_item.x,
+                           baseY + first_work_item.y,
+                           baseZ + first_work_item.z);
+        }
+    }
+  else
+    {
+      ui_out_field_skip(uiout, "absolute-work-item-id");
+    }
+
+  /* print the pc and the source line */
+  ui_out_field_fmt(uiout, "pc", "0x%x", ((int)snapshot->pcs[wave_index]));
+  ui_out_field_string(uiout, "source-line", source_line);
+  ui_out_text(uiout, "\n");
+
+  do_cleanups(row_chain);
+}
+
+/* Print a table of waves, in the given order and numbered from first_index_to_show.
+   With use_work_item, only the waves running work_item are printed, with only its lane */
+static void hsail_print_wave_table(struct ui_out* uiout, HwDbgInfo_debug dbgInfo,
+                                   const struct hsail_wave_snapshot* snapshot,
+                                   const int* wave_indices, int wave_count, int first_index_to_show,
+                                   HsailWaveDim3 work_item, bool use_work_item, bool mark_active_item)
+{
+  /* the waves printed and their lane masks, either all the active lanes or the ones running the filter work item */
+  int* row_waves = NULL;
+  uint64_t* row_lane_masks = NULL;
+  int row_count = 0;
+  struct hsail_print_pc_sources sources;
+  struct cleanup* old_chain = NULL;
+  struct cleanup* table_chain = NULL;
+  int i = 0;
+
+  gdb_assert(NULL != snapshot);
+  gdb_assert(NULL != uiout);
+
+  row_waves = XNEWVEC(int, wave_count > 0 ? wave_count : 1);
+  old_chain = make_cleanup(xfree, row_waves);
+  row_lane_masks = XNEWVEC(uint64_t, wave_count > 0 ? wave_count : 1);
+  make_cleanup(xfree, row_lane_masks);
+  memset(&sources, 0, sizeof(sources));
+  sources.pcs = XNEWVEC(uint64_t, wave_count > 0 ? wave_count : 1);
+  make_cleanup(xfree, sources.pcs);
 
-  for (nExec = 0 ; nExec < 64 ; nExec++)
+  for (i = 0; i < wave_count; i++)
     {
-      if (wave_info_buffer[wave_index].execMask & current_bit_mask)
+      int wave_index = wave_indices[i];
+      uint64_t lane_mask = use_work_item ? hsail_wave_match_work_item(snapshot, wave_index, &work_item) :
+                                           snapshot->exec_masks[wave_index];
+
+      if (!use_work_item || 0 != lane_mask)
         {
-          /* use the work item if it is the filter work item or not using filter at all */
-          if (!use_work_item || (work_item.x == wave_info_buffer[wave_index].workItemId[nExec].x &&
-                                 work_item.y == wave_info_buffer[wave_index].workItemId[nExec].y &&
-                                 work_item.z == wave_info_buffer[wave_index].workItemId[nExec].z))
+          row_waves[row_count] = wave_index;
+          row_lane_masks[row_count] = lane_mask;
+          sources.pcs[row_count] = snapshot->pcs[wave_index];
+          row_count++;
+        }
+    }
+
+  /* resolve the source line of each distinct pc once */
+  if (row_count > 0)
+    {
+      qsort(sources.pcs, row_count, sizeof(uint64_t), hsail_print_compare_pcs);
+      sources.count = 1;
+      for (i = 1; i < row_count; i++)
+        {
+          if (sources.pcs[i] != sources.pcs[sources.count - 1])
             {
-              last_bit_num = nExec;
-              if (firstExec)
-                {
-                  firstExec = false;
-                  first_bit_num = nExec;
-                  found_work_item = true;
-                }
+              sources.pcs[sources.count++] = sources.pcs[i];
             }
         }
-        /* move the current_bit_mask to the next bit so the next exec mask bit will be checked */
-        current_bit_mask = current_bit_mask<<1;
+
+      if (NULL != dbgInfo)
+        {
+          sources.elfva_addrs = XNEWVEC(HwDbgInfo_addr, sources.count);
+          make_cleanup(xfree, sources.elfva_addrs);
+          sources.mapped_addrs = XNEWVEC(HwDbgInfo_addr, sources.count);
+          make_cleanup(xfree, sources.mapped_addrs);
+          sources.line_nums = XNEWVEC(HwDbgInfo_linenum, sources.count);
+          make_cleanup(xfree, sources.line_nums);
+          sources.file_ids = XNEWVEC(HwDbgInfo_fileid, sources.count);
+          make_cleanup(xfree, sources.file_ids);
+
+          hsail_print_resolve_pc_sources(dbgInfo, &sources);
+        }
     }
 
-  if (!use_work_item || found_work_item)
-  {
-    /* get the source line information */
-    HwDbgInfo_err dbgErr = 0;
-    uint64_t elfva_addr = 0;
-    HwDbgInfo_linenum line_num = 0;
-
-    char* file_name = NULL;
-
-    sprintf(index_buffer,"%s%d",mark_active_item ? "*": "", index_to_show);
-
-    waveSlots.u32All = wave_info_buffer[wave_index].waveAddress;
-    sprintf(wave_addr_buffer, "0x%x {%2d,%2d,%2d,%4d,%4d}",
-            wave_info_buffer[wave_index].waveAddress,
-            waveSlots.bits.se_id,
-            waveSlots.bits.sh_id,
-            waveSlots.bits.cu_id,
-            waveSlots.bits.simd_id,
-            waveSlots.bits.wave_id);
-
-    sprintf(wi_id1_buffer,"[%2d,%2d,%2d",wave_info_buffer[wave_index].workItemId[first_bit_num].x,
-                                        wave_info_buffer[wave_index].workItemId[first_bit_num].y,
-                                        wave_info_buffer[wave_index].workItemId[first_bit_num].z );
-    if (!use_work_item)
-      {
-        sprintf(wi_id2_buffer," - %2d,%2d,%2d]",wave_info_buffer[wave_index].workItemId[last_bit_num].x,
-                                               wave_info_buffer[wave_index].workItemId[last_bit_num].y,
-                                               wave_info_buffer[wave_index].workItemId[last_bit_num].z );
-      }
-    else
-      {
-        sprintf(wi_id2_buffer,"%s","]");
-      }
-    sprintf(wi_id_buffer,"%s%s",wi_id1_buffer,wi_id2_buffer);
-
-    /* print absolute work-item id */
-    if (NULL != active_dispatch)
-      {
-        uint32_t baseX = wave_info_buffer[wave_index].workGroupId.x * active_dispatch->work_groups_size.x;
-        uint32_t baseY = wave_info_buffer[wave_index].workGroupId.y * active_dispatch->work_groups_size.y;
-        uint32_t baseZ = wave_info_buffer[wave_index].workGroupId.z * active_dispatch->work_groups_size.z;
-        sprintf(abs_wi_id1_buffer,"[%3d,%3d,%3d",
-                        baseX + wave_info_buffer[wave_index].workItemId[first_bit_num].x,
-                        baseY + wave_info_buffer[wave_index].workItemId[first_bit_num].y,
-                        baseZ + wave_info_buffer[wave_index].workItemId[first_bit_num].z);
-        if (!use_work_item)
-          {
-            sprintf(abs_wi_id2_buffer," - %3d,%3d,%3d]",
-                        baseX + wave_info_buffer[wave_index].workItemId[last_bit_num].x,
-                        baseY + wave_info_buffer[wave_index].workItemId[last_bit_num].y,
-                        baseZ + wave_info_buffer[wave_index].workItemId[last_bit_num].z);
-          }
-        else
-          {
-            sprintf(abs_wi_id2_buffer, "%s", "]");
-          }
-        sprintf(abs_wi_id_buffer, "%s%s", abs_wi_id1_buffer, abs_wi_id2_buffer);
-      }
-    else
-      {
-        sprintf(abs_wi_id_buffer,"%s","");
-      }
-
-    gdb_assert(hsail_segment_resolve_memva(wave_info_buffer[wave_index].pc, &elfva_addr ) == true);
-
-    /* print the source line and pc */
-    dbgErr = hwdbginfo_nearest_mapped_addr(dbgInfo,
-                                           wave_info_buffer[wave_index].pc,
-                                           (HwDbgInfo_addr*)(&elfva_addr));
-    if (dbgErr != HWDBGINFO_E_SUCCESS)
-      {
-        sprintf(source_line_buffer,"dbginfo error");
-      }
-
-
-    if (!hsail_dbginfo_get_pc_info(elfva_addr, &line_num, &file_name))
-      {
-        sprintf(source_line_buffer,"dbginfo error");
-      }
-    else
-      {
-        sprintf(source_line_buffer,"%s@line %d", file_name, ((int)line_num));
-      }
-
-    sprintf(pc_buffer,"0x%x",((int)wave_info_buffer[wave_index].pc));
-
-    printf_filtered("%5s%33s%24s%31s%10s%23s\n",
-                    index_buffer,
-                    wave_addr_buffer,
-                    wi_id_buffer, abs_wi_id_buffer,
-                    pc_buffer,
-                    source_line_buffer);
-    if (file_name != NULL)
-      {
-        xfree(file_name);
-      }
-  }
+  table_chain = make_cleanup_ui_out_table_begin_end(uiout, 6, row_count, "waves");
+  ui_out_table_header(uiout, 5, ui_right, "index", "Index");
+  ui_out_table_header(uiout, 32, ui_right, "wave-id", "Wave ID {SE,SH,CU,SIMD,Wave}");
+  ui_out_table_header(uiout, 23, ui_right, "work-item-id", "Work-item ID");
+  ui_out_table_header(uiout, 30, ui_right, "absolute-work-item-id", "Absolute Work-item ID");
+  ui_out_table_header(uiout, 9, ui_right, "pc", "PC");
+  ui_out_table_header(uiout, 22, ui_right, "source-line", "Source line");
+  ui_out_table_body(uiout);
+
+  for (i = 0; i < row_count; i++)
+    {
+      const uint64_t* source_pc = NULL;
+      size_t source_index = 0;
+      char* source_line = NULL;
+      struct cleanup* row_chain = NULL;
+
+      source_pc = (const uint64_t*)bsearch(&snapshot->pcs[row_waves[i]], sources.pcs, sources.count,
+                                           sizeof(uint64_t), hsail_print_compare_pcs);
+      gdb_assert(NULL != source_pc);
+      source_index = source_pc - sources.pcs;
+
+      /* A PC without a source line shows as an error, as it does without debug info */
+      if (NULL == dbgInfo || HWDBGINFO_FILEID_NONE == sources.file_ids[source_index])
+        {
+          source_line = xstrdup("dbginfo error");
+        }
+      else
+        {
+          source_line = xstrprintf("%s@line %d",
+                                   hsail_dbginfo_get_file_name(dbgInfo, sources.file_ids[source_index]),
+                                   ((int)sources.line_nums[source_index]));
+        }
+      row_chain = make_cleanup(xfree, source_line);
+
+      hsail_print_wave_row(uiout, snapshot, row_waves[i], first_index_to_show + i, row_lane_masks[i],
+                           use_work_item, mark_active_item, source_line);
+      do_cleanups(row_chain);
+    }
+
+  do_cleanups(table_chain);
+  do_cleanups(old_chain);
 }
 
 void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out* uiout, int from_tty)
 {
   /* vars used to loop through the waves and count the groups */
   int nWorkgroup = 0;
-  int nWave = 0;
   int count_index = 0;
   HsailWaveDim3 dummy_work_item = {-1, -1, -1};
   bool workgroup_found = false;
   /* get the waves info */
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
+  const struct hsail_wave_snapshot* snapshot = hsail_wave_get_snapshot();
 
   /* get the source line information */
   HwDbgInfo_debug dbgInfo = NULL;
@@ -901,7 +1049,7 @@ void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out* uiout,
     workgroupnumY = (active_dispatch->work_items.y == 0 ? 1 : active_dispatch->work_items.y) / (active_dispatch->work_groups_size.y == 0 ? 1 : active_dispatch->work_groups_size.y);
   }
 
-  if (NULL == wave_info_buffer || num_waves == 0)
+  if (NULL == snapshot)
   {
     hsail_print_no_wave_msg(uiout, "work-group <id>");
     return ;
@@ -909,37 +1057,29 @@ void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out* uiout,
 
   dbgInfo = hsail_init_hwdbginfo(NULL);
 
-  /* create the work-group vector and verify the index is valid */
-  hsail_build_workgroups_vector();
-
-  /* pass through all the work-groups in the vector and look for the flattened id */
-  for (nWorkgroup = 0 ; nWorkgroup < gs_num_workgroups_in_vector ; nWorkgroup++)
+  /* pass through all the work-groups in the snapshot and look for the flattened id */
+  for (nWorkgroup = 0 ; nWorkgroup < snapshot->num_work_groups ; nWorkgroup++)
   {
+    const HsailWaveDim3* work_group = &snapshot->work_groups[nWorkgroup];
 
     if (NULL != active_dispatch)
     {
-      flattened_id = gs_workgroup_vector[nWorkgroup].x +
-                     gs_workgroup_vector[nWorkgroup].y * workgroupnumX +
-                     gs_workgroup_vector[nWorkgroup].z * workgroupnumX * workgroupnumY;
+      flattened_id = work_group->x +
+                     work_group->y * workgroupnumX +
+                     work_group->z * workgroupnumX * workgroupnumY;
     }
 
     if (flattened_id == index)
     {
-      /* print the header */
+      /* the waves of the work group, in wave buffer order */
+      int first_wave = snapshot->work_group_wave_start[nWorkgroup];
+      int wave_count = snapshot->work_group_wave_start[nWorkgroup + 1] - first_wave;
+
       printf_filtered("Information for Work-group %d\n",index);
-      printf_filtered("%5s%33s%24s%31s%10s%23s\n","Index","Wave ID {SE,SH,CU,SIMD,Wave}","Work-item ID","Absolute Work-item ID","PC","Source line");
-
-      /* pass through all the waves and check if their information match the work group of the index needed */
-      for (nWave = 0 ; nWave < num_waves ; nWave++)
-      {
-          if (gs_workgroup_vector[nWorkgroup].x == wave_info_buffer[nWave].workGroupId.x &&
-              gs_workgroup_vector[nWorkgroup].y == wave_info_buffer[nWave].workGroupId.y &&
-              gs_workgroup_vector[nWorkgroup].z == wave_info_buffer[nWave].workGroupId.z)
-          {
-            hsail_print_wave_data(dbgInfo, wave_info_buffer, nWave, count_index, dummy_work_item, false, false);
-            count_index++;
-          }
-      }
+      hsail_print_wave_table(uiout, dbgInfo, snapshot,
+                             &snapshot->work_group_waves[first_wave], wave_count,
+                             count_index, dummy_work_item, false, false);
+      count_index += wave_count;
       workgroup_found = true;
     }
   }
@@ -948,13 +1088,6 @@ void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out* uiout,
   {
     ui_out_text(uiout,"Provided work-group ID not found.\n");
   }
-
-  /* release the vector data */
-  free_current_contents(&gs_workgroup_vector);
-  gs_num_workgroups_in_vector = 0;
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_shm_buffer((void*)wave_info_buffer);
 }
 
 void hsail_print_specific_workgroup_info (unsigned int* workgroupid, struct ui_out* uiout, int from_tty)
@@ -985,16 +1118,15 @@ void hsail_print_specific_workgroup_info (unsigned int* workgroupid, struct ui_o
 
 void hsail_print_workitem_info (HsailWaveDim3 active_work_group, HsailWaveDim3 active_work_item, bool mark_active_item, struct ui_out* uiout, int from_tty)
 {
-  int nWave = 0;
+  int wave_index = 0;
   /* get the waves info */
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
+  const struct hsail_wave_snapshot* snapshot = hsail_wave_get_snapshot();
 
   /* get the source line information */
-  int num_waves = hsail_tdep_get_active_wave_count();
   HwDbgInfo_debug dbgInfo = NULL;
 
   gdb_assert(NULL != uiout);
-  if (NULL == wave_info_buffer || num_waves == 0)
+  if (NULL == snapshot)
   {
     hsail_print_no_wave_msg(uiout, "work-item");
     return ;
@@ -1003,19 +1135,13 @@ void hsail_print_workitem_info (HsailWaveDim3 active_work_group, HsailWaveDim3 a
   dbgInfo = hsail_init_hwdbginfo(NULL);
 
   printf_filtered("Information for Work-item\n");
-  printf_filtered("%5s%33s%24s%31s%10s%23s\n","Index","Wave ID {SE,SH,CU,SIMD,Wave}","Work-item ID","Absolute Work-item ID","PC","Source line");
-  for (nWave = 0 ; nWave < num_waves ; nWave++)
+
+  /* Only the wave whose active lane runs the work-item is printed */
+  if (hsail_wave_find_work_item(snapshot, &active_work_group, &active_work_item, &wave_index, NULL))
   {
-      if (active_work_group.x == wave_info_buffer[nWave].workGroupId.x &&
-          active_work_group.y == wave_info_buffer[nWave].workGroupId.y &&
-          active_work_group.z == wave_info_buffer[nWave].workGroupId.z)
-      {
-        hsail_print_wave_data(dbgInfo, wave_info_buffer, nWave, 0, active_work_item, true, mark_active_item);
-      }
+    hsail_print_wave_table(uiout, dbgInfo, snapshot, &wave_index, 1, 0,
+                           active_work_item, true, mark_active_item);
   }
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_shm_buffer((void*)wave_info_buffer);
 }
 
 static
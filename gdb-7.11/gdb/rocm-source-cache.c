@@ -0,0 +1,236 @@
+/*
+   ROCm GDB cache of the line offsets of source files.
+
+   Copyright (c) 2015-2016 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* GDB headers, defs.h has to come first */
+#include "defs.h"
+#include "gdb_assert.h"
+#include "filestuff.h"
+#include "hashtab.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* rocm-gdb headers */
+#include "rocm-source-cache.h"
+
+/* The files in the cache, keyed by path */
+static htab_t gs_source_cache = NULL;
+
+/* The cache is emptied when it holds more files than this */
+#define HSAIL_SOURCE_CACHE_MAX_FILES 64
+
+static hashval_t hsail_source_cache_hash(const void* p)
+{
+  return htab_hash_string(((const struct hsail_source_file*)p)->path);
+}
+
+/* eq_f for the cache, the key is the path */
+static int hsail_source_cache_eq(const void* entry, const void* key)
+{
+  return strcmp(((const struct hsail_source_file*)entry)->path, (const char*)key) == 0;
+}
+
+static void hsail_source_cache_free_file(void* p)
+{
+  struct hsail_source_file* file = (struct hsail_source_file*)p;
+
+  if (file == NULL)
+    {
+      return;
+    }
+
+  if (file->data != NULL)
+    {
+      munmap((void*)file->data, file->size);
+    }
+
+  xfree(file->line_offsets);
+  xfree(file->path);
+  xfree(file);
+}
+
+/* Record the start of every line.
+ * memchr does the newline scan since it is vectorized by the C library */
+static void hsail_source_cache_index_lines(struct hsail_source_file* file)
+{
+  size_t lines_allocated = 1024;
+  size_t size = file->size;
+  size_t offset = 0;
+  const char* newline = NULL;
+
+  file->line_offsets = XNEWVEC(size_t, lines_allocated);
+  file->num_lines = 0;
+
+  while (offset < size)
+    {
+      /* Leave room for the closing offset */
+      if (file->num_lines + 1 >= lines_allocated)
+        {
+          lines_allocated *= 2;
+          file->line_offsets = XRESIZEVEC(size_t, file->line_offsets, lines_allocated);
+        }
+
+      file->line_offsets[file->num_lines++] = offset;
+
+      newline = (const char*)memchr(file->data + offset, '\n', size - offset);
+      offset = (newline == NULL) ? size : (size_t)(newline - file->data) + 1;
+    }
+
+  file->line_offsets[file->num_lines] = size;
+}
+
+/* Map and index a file, NULL if it cannot be mapped */
+static struct hsail_source_file* hsail_source_cache_load(const char* path, int desc,
+                                                         const struct stat* st)
+{
+  struct hsail_source_file* file = XCNEW(struct hsail_source_file);
+  void* data = NULL;
+
+  file->path = xstrdup(path);
+  file->mtime = st->st_mtime;
+  file->size = st->st_size;
+
+  if (file->size > 0)
+    {
+      data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, desc, 0);
+      if (data == MAP_FAILED)
+        {
+          hsail_source_cache_free_file(file);
+          return NULL;
+        }
+      file->data = (const char*)data;
+    }
+
+  hsail_source_cache_index_lines(file);
+
+  return file;
+}
+
+const struct hsail_source_file* hsail_source_cache_lookup_desc(const char* path, int desc)
+{
+  struct hsail_source_file* file = NULL;
+  struct stat st;
+  void** slot = NULL;
+
+  if (path == NULL || desc < 0)
+    {
+      return NULL;
+    }
+
+  if (fstat(desc, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+      return NULL;
+    }
+
+  if (gs_source_cache == NULL)
+    {
+      gs_source_cache = htab_create_alloc(HSAIL_SOURCE_CACHE_MAX_FILES,
+                                          hsail_source_cache_hash,
+                                          hsail_source_cache_eq,
+                                          hsail_source_cache_free_file,
+                                          xcalloc, xfree);
+    }
+
+  slot = htab_find_slot_with_hash(gs_source_cache, path, htab_hash_string(path), NO_INSERT);
+  if (slot != NULL)
+    {
+      file = (struct hsail_source_file*)*slot;
+      if (file->mtime == st.st_mtime && file->size == st.st_size)
+        {
+          return file;
+        }
+
+      /* The file changed since it was cached */
+      htab_clear_slot(gs_source_cache, slot);
+    }
+
+  if (htab_elements(gs_source_cache) >= HSAIL_SOURCE_CACHE_MAX_FILES)
+    {
+      htab_empty(gs_source_cache);
+    }
+
+  file = hsail_source_cache_load(path, desc, &st);
+  if (file == NULL)
+    {
+      return NULL;
+    }
+
+  slot = htab_find_slot_with_hash(gs_source_cache, path, htab_hash_string(path), INSERT);
+  gdb_assert(slot != NULL && *slot == NULL);
+  *slot = file;
+
+  return file;
+}
+
+const struct hsail_source_file* hsail_source_cache_lookup(const char* path)
+{
+  const struct hsail_source_file* file = NULL;
+  int desc = -1;
+
+  if (path == NULL)
+    {
+      return NULL;
+    }
+
+  desc = gdb_open_cloexec(path, O_RDONLY, 0);
+  if (desc < 0)
+    {
+      return NULL;
+    }
+
+  /* The mapping stays valid after the file is closed */
+  file = hsail_source_cache_lookup_desc(path, desc);
+  close(desc);
+
+  return file;
+}
+
+bool hsail_source_cache_get_line(const struct hsail_source_file* file, size_t line_num,
+                                 const char** op_line, size_t* op_len)
+{
+  gdb_assert(op_line != NULL);
+  gdb_assert(op_len != NULL);
+
+  if (file == NULL || line_num < 1 || line_num > file->num_lines)
+    {
+      return false;
+    }
+
+  *op_line = file->data + file->line_offsets[line_num - 1];
+  *op_len = file->line_offsets[line_num] - file->line_offsets[line_num - 1];
+
+  return true;
+}
+
+void hsail_source_cache_clear(void)
+{
+  if (gs_source_cache != NULL)
+    {
+      htab_delete(gs_source_cache);
+      gs_source_cache = NULL;
+    }
+}
@@ -0,0 +1,65 @@
+/*
+   ROCm GDB cache of the line offsets of source files.
+
+   Copyright (c) 2015-2016 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_SOURCE_CACHE_H)
+#define HSAIL_SOURCE_CACHE_H 1
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/* A source file mapped in memory and the offsets of its lines.
+ *
+ * Files are cached by path and reused as long as their modification time
+ * and size do not change.
+ * An entry is only valid till the next lookup, since a lookup can evict it.
+ * */
+struct hsail_source_file
+{
+  char* path;
+  time_t mtime;
+  off_t size;
+
+  /* The mapped content, NULL for an empty file */
+  const char* data;
+
+  /* Line N (starting at 1) is at [line_offsets[N-1], line_offsets[N]),
+   * a newline at the end of the file does not start a new line */
+  size_t num_lines;
+  size_t* line_offsets;
+};
+
+/* Return the cached file for a path, NULL if it cannot be read */
+const struct hsail_source_file* hsail_source_cache_lookup(const char* path);
+
+/* Same as hsail_source_cache_lookup for a file the caller already opened */
+const struct hsail_source_file* hsail_source_cache_lookup_desc(const char* path, int desc);
+
+/* Get the start and length of a line, the newline is included in the length */
+bool hsail_source_cache_get_line(const struct hsail_source_file* file, size_t line_num,
+                                 const char** op_line, size_t* op_len);
+
+/* Unmap all the cached files */
+void hsail_source_cache_clear(void);
+
+#endif // HSAIL_SOURCE_CACHE_H
@@ -30,6 +30,7 @@
 
 /* Headers for signals */
 #include <signal.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
 
@@ -65,10 +66,12 @@
 #include "rocm-kernel.h"
 #include "rocm-print.h"
 #include "rocm-segment-loader.h"
+#include "rocm-source-cache.h"
 #include "rocm-thread.h"
 #include "rocm-trace.h"
 #include "rocm-tdep.h"
 #include "rocm-utils.h"
+#include "rocm-wave.h"
 
 /* Include HwDbgFacilities C interface*/
 #include "FacilitiesInterface.h"
@@ -79,6 +82,10 @@
 
 void hsail_tdep_print_notification_type(const HsailNotification notification);
 
+static void hsail_tdep_map_command_ring(void);
+
+void _initialize_rocm_tdep (void);
+
 /* The HSAIL agent should be closed down only once.
  *
  * If hsail is initialized then this variable is set to 1 */
@@ -97,15 +104,99 @@ static int gs_num_handle_event_function_calls = 0;
 
 static int gs_num_active_waves=-1;
 
+/* Incremented whenever the agent may have rewritten the wave buffer */
+static unsigned int gs_wave_buffer_generation = 1;
+
 static bool gs_stage2_has_run = false;
 
 
 static int gs_gpuBkptCrtCount = 0;
 
+/* The debug session ID shared with the agent, all the IPC names are derived from it */
+static int gs_hsail_session_id = 0;
+
+/* Set when the agent did not take the session ID and uses the fixed IPC names */
+static bool gs_hsail_uses_legacy_ipc_names = false;
+
+static char gs_hsail_gdb_to_agent_fifo_name[128];
+static char gs_hsail_agent_to_gdb_fifo_name[128];
+static char gs_hsail_isa_file_path[128];
+
+/* The shared memory command ring, NULL if the agent did not create one */
+static HsailCommandRing* gs_hsail_command_ring = NULL;
+
+/* The key of a shared memory buffer, for the session unless the agent uses the fixed keys */
+static int hsail_tdep_get_shmem_key(const int legacy_key, const HsailDebugConfigParam param_type)
+{
+  if (gs_hsail_uses_legacy_ipc_names)
+    {
+      return legacy_key;
+    }
+
+  return HsailGetSessionShmKey(gs_hsail_session_id, param_type);
+}
+
+/* Name the fifos and the ISA dump after the session, or use the fixed names */
+static void hsail_tdep_set_ipc_names(bool use_legacy_names)
+{
+  gs_hsail_uses_legacy_ipc_names = use_legacy_names;
+
+  if (use_legacy_names)
+    {
+      xsnprintf(gs_hsail_gdb_to_agent_fifo_name, sizeof(gs_hsail_gdb_to_agent_fifo_name),
+                "%s", gs_GdbToAgentFifoName);
+      xsnprintf(gs_hsail_agent_to_gdb_fifo_name, sizeof(gs_hsail_agent_to_gdb_fifo_name),
+                "%s", gs_AgentToGdbFifoName);
+      xsnprintf(gs_hsail_isa_file_path, sizeof(gs_hsail_isa_file_path),
+                "%s", gs_ISAFileNamePath);
+      return;
+    }
+
+  xsnprintf(gs_hsail_gdb_to_agent_fifo_name, sizeof(gs_hsail_gdb_to_agent_fifo_name),
+            "%s" HSAIL_SESSION_NAME_SUFFIX_FORMAT, gs_GdbToAgentFifoName, gs_hsail_session_id);
+  xsnprintf(gs_hsail_agent_to_gdb_fifo_name, sizeof(gs_hsail_agent_to_gdb_fifo_name),
+            "%s" HSAIL_SESSION_NAME_SUFFIX_FORMAT, gs_AgentToGdbFifoName, gs_hsail_session_id);
+  xsnprintf(gs_hsail_isa_file_path, sizeof(gs_hsail_isa_file_path),
+            "%s" HSAIL_SESSION_NAME_SUFFIX_FORMAT, gs_ISAFileNamePath, gs_hsail_session_id);
+}
+
+static bool hsail_tdep_is_fifo(const char* path)
+{
+  struct stat path_stat;
+
+  return stat(path, &path_stat) == 0 && S_ISFIFO(path_stat.st_mode);
+}
+
+/* Check which names the agent created its fifos with, once it has signaled us.
+ * An agent that takes ROCM_GDB_IPC_SESSION_ID creates the session fifos, an older
+ * agent creates the fixed ones. All the IPC names then follow the agent's choice */
+static void hsail_tdep_negotiate_ipc_names(void)
+{
+  char session_fifo_name[128];
+
+  xsnprintf(session_fifo_name, sizeof(session_fifo_name),
+            "%s" HSAIL_SESSION_NAME_SUFFIX_FORMAT, gs_AgentToGdbFifoName, gs_hsail_session_id);
+
+  if (!hsail_tdep_is_fifo(session_fifo_name) && hsail_tdep_is_fifo(gs_AgentToGdbFifoName))
+    {
+      if (!gs_hsail_uses_legacy_ipc_names)
+        {
+          printf_filtered("[ROCm-gdb]: The agent does not support %s, using the shared IPC names.\n"
+                          "[ROCm-gdb]: Only one debug session at a time can run on this node.\n",
+                          gs_SessionIdEnvVar);
+        }
+      hsail_tdep_set_ipc_names(true);
+    }
+  else
+    {
+      hsail_tdep_set_ipc_names(false);
+    }
+}
+
 /* Return the key for the shared mem location that has the binary*/
 const int hsail_get_agent_binary_shmem_key(void)
 {
-  return g_DBEBINARY_SHMKEY;
+  return hsail_tdep_get_shmem_key(g_DBEBINARY_SHMKEY, HSAIL_DEBUG_CONFIG_CODE_OBJ_SHM);
 }
 
 /* Return the max size for the shared mem location that has the binary*/
@@ -118,7 +209,7 @@ const int hsail_get_agent_binary_shmem_max_size(void)
 /* Return the key for the shared mem location that has the binary*/
 const int hsail_get_wave_buffer_shmem_key(void)
 {
-  return g_WAVE_BUFFER_SHMKEY;
+  return hsail_tdep_get_shmem_key(g_WAVE_BUFFER_SHMKEY, HSAIL_DEBUG_CONFIG_WAVE_INFO_SHM);
 }
 
 /* Return the max size for the shared mem location that has the wave info*/
@@ -130,7 +221,7 @@ const int hsail_get_wave_buffer_shmem_max_size(void)
 /* Return the key for the shared mem location that has the momentary bp list*/
 const int hsail_get_momentary_bp_buffer_shmem_key(void)
 {
-  return g_MOMENTARY_BP_BUFFER_SHMKEY;
+  return hsail_tdep_get_shmem_key(g_MOMENTARY_BP_BUFFER_SHMKEY, HSAIL_DEBUG_CONFIG_MOMENTARY_BP_SHM);
 }
 
 /* Return the max size for the shared mem location that has momentary bp list*/
@@ -143,7 +234,7 @@ const int hsail_get_momentary_bp_buffer_shmem_max_size(void)
 /* Return the key for the shared mem location that has the loaded segment list*/
 static const int hsail_get_loadmap_buffer_shmem_key(void)
 {
-  return g_LOADMAP_SHMKEY;
+  return hsail_tdep_get_shmem_key(g_LOADMAP_SHMKEY, HSAIL_DEBUG_CONFIG_LOADMAP_BUFFER_SHM);
 }
 
 /* Return the max size for the shared mem location that has the loaded segment list*/
@@ -152,6 +243,30 @@ static const int hsail_get_loadmap_buffer_shmem_max_size(void)
   return g_LOADMAP_MAXSIZE;
 }
 
+/* Return the key for the shared mem location that has the ISA*/
+static const int hsail_get_isa_buffer_shmem_key(void)
+{
+  return hsail_tdep_get_shmem_key(g_ISASTREAM_SHMKEY, HSAIL_DEBUG_CONFIG_ISA_BUFFER_SHM);
+}
+
+/* Return the max size for the shared mem location that has the ISA*/
+static const int hsail_get_isa_buffer_shmem_max_size(void)
+{
+  return g_ISASTREAM_MAXSIZE;
+}
+
+/* Return the key for the shared mem location that has the command ring*/
+static const int hsail_get_command_ring_shmem_key(void)
+{
+  return hsail_tdep_get_shmem_key(g_COMMAND_RING_SHMKEY, HSAIL_DEBUG_CONFIG_COMMAND_RING_SHM);
+}
+
+/* Return the max size for the shared mem location that has the command ring*/
+static const int hsail_get_command_ring_shmem_max_size(void)
+{
+  return g_COMMAND_RING_MAXSIZE;
+}
+
 static void
 gpu_solib_loaded (struct so_list *solib)
 {
@@ -204,7 +319,7 @@ void hsail_linux_initialize_stg2(void)
       /*ui_out_text(uiout,"gdb: Initialize write fifo\n");*/
       fflush(stdout);
 
-      fd = open(gs_GdbToAgentFifoName, O_WRONLY);
+      fd = open(gs_hsail_gdb_to_agent_fifo_name, O_WRONLY);
 
       if (fd <=  0)
         {
@@ -220,6 +335,10 @@ void hsail_linux_initialize_stg2(void)
        * The shared memory for the dbe binary is created in the agent
        */
 
+      /* The agent has the read end of the fifo open by now, so the command
+       * ring exists if the agent supports it */
+      hsail_tdep_map_command_ring();
+
       gs_is_hsail_initialized = 1;
       ui_out_text(uiout,"[ROCm-gdb: GPU Debugging has been successfully initialized]\n");
       /*ui_out_text(uiout,"gdb: Finished Initialize write fifo\n");*/
@@ -259,7 +378,10 @@ void hsail_linux_initialize_stg1(void)
       /*ui_out_text(uiout,"gdb: Initialize Nonblocking read fifo\n");*/
       fflush(stdout);
 
-      fd = open(gs_AgentToGdbFifoName, O_RDONLY | O_NONBLOCK);
+      /* The agent has created its fifos by now */
+      hsail_tdep_negotiate_ipc_names();
+
+      fd = open(gs_hsail_agent_to_gdb_fifo_name, O_RDONLY | O_NONBLOCK);
 
       if (fd <=  0)
         {
@@ -350,6 +472,9 @@ static bool hsail_linux_delete_shmem(const key_t shm_key, const int max_buffer_s
 static void hsail_tdep_set_active_wave_count(const int num_active_waves)
 {
   gs_num_active_waves = num_active_waves;
+
+  /* The agent updates the wave buffer before it reports the wave count */
+  gs_wave_buffer_generation++;
 }
 
 int hsail_tdep_get_active_wave_count(void)
@@ -422,7 +547,7 @@ bool hsail_tdep_save_isa(bool is_disassemble_command, const char* hsail_isa_file
     {
       size_t isa_size;
 
-      if (!hsail_utils_read_file_to_array(gs_ISAFileNamePath,
+      if (!hsail_utils_read_file_to_array(gs_hsail_isa_file_path,
                                           &isa_location,
                                           &isa_size))
         {
@@ -472,27 +597,91 @@ bool hsail_tdep_save_isa(bool is_disassemble_command, const char* hsail_isa_file
 }
 
 
-void* hsail_tdep_map_loadmap_buffer(void)
+/* The shared memory buffers that stay mapped while we are debugging a dispatch.
+ *
+ * Mapping used to be done on every access, which put a shmget and shmat in
+ * per wave paths. The buffers are now mapped on first use after
+ * HSAIL_NOTIFY_BEGIN_DEBUGGING and detached on HSAIL_NOTIFY_END_DEBUGGING.
+ * hsail_tdep_unmap_shm_buffer does nothing for these buffers.
+ */
+typedef enum
+{
+  HSAIL_SHM_BUFFER_WAVE_INFO,
+  HSAIL_SHM_BUFFER_MOMENTARY_BP,
+  HSAIL_SHM_BUFFER_LOADMAP,
+  HSAIL_SHM_BUFFER_COUNT
+} HsailCachedShmBuffer;
+
+typedef struct _HsailShmMapping
+{
+  const char* name;     /* Used in the error messages */
+  void* shm;            /* The attached buffer, NULL if not mapped */
+} HsailShmMapping;
+
+static HsailShmMapping gs_shm_mappings[HSAIL_SHM_BUFFER_COUNT] =
+{
+  {"wave info buffer", NULL},
+  {"momentary_bp_buffer", NULL},
+  {"loadmap buffer", NULL}
+};
+
+static void hsail_tdep_get_shm_buffer_params(const HsailCachedShmBuffer buffer,
+                                             int* shm_key, int* max_size)
+{
+  gdb_assert(shm_key != NULL && max_size != NULL);
+
+  switch (buffer)
+  {
+    case HSAIL_SHM_BUFFER_WAVE_INFO:
+      *shm_key = hsail_get_wave_buffer_shmem_key();
+      *max_size = hsail_get_wave_buffer_shmem_max_size();
+      break;
+    case HSAIL_SHM_BUFFER_MOMENTARY_BP:
+      *shm_key = hsail_get_momentary_bp_buffer_shmem_key();
+      *max_size = hsail_get_momentary_bp_buffer_shmem_max_size();
+      break;
+    case HSAIL_SHM_BUFFER_LOADMAP:
+      *shm_key = hsail_get_loadmap_buffer_shmem_key();
+      *max_size = hsail_get_loadmap_buffer_shmem_max_size();
+      break;
+    default:
+      gdb_assert(0);
+      break;
+  }
+}
+
+static void* hsail_tdep_map_cached_shm_buffer(const HsailCachedShmBuffer buffer)
 {
   struct ui_out* uiout = current_uiout;
+  HsailShmMapping* mapping = NULL;
 
   void* pShm = NULL;
   int shmid = -1;
-  const int max_shared_mem_size = hsail_get_loadmap_buffer_shmem_max_size();
+  int shm_key = 0;
+  int max_shared_mem_size = 0;
 
   gdb_assert(NULL != uiout);
-  /*1M used is hard wired for now*/
+  gdb_assert(buffer < HSAIL_SHM_BUFFER_COUNT);
 
   if (hsail_is_focus_device() == false || is_hsail_linux_initialized() == false)
     {
       return NULL;
     }
 
-  shmid = shmget(hsail_get_loadmap_buffer_shmem_key(), max_shared_mem_size, 0666);
+  mapping = &gs_shm_mappings[buffer];
+  if (mapping->shm != NULL)
+    {
+      return mapping->shm;
+    }
+
+  hsail_tdep_get_shm_buffer_params(buffer, &shm_key, &max_shared_mem_size);
+
+  shmid = shmget(shm_key, max_shared_mem_size, 0666);
 
   if (shmid <= 0)
     {
-      ui_out_text(uiout, "wave info buffer mapping: shmid is invalid\n");
+      ui_out_text(uiout, mapping->name);
+      ui_out_text(uiout, " mapping: shmid is invalid\n");
     }
 
   gdb_assert(shmid > 0);
@@ -502,82 +691,229 @@ void* hsail_tdep_map_loadmap_buffer(void)
 
   gdb_assert(pShm != NULL);
 
+  mapping->shm = pShm;
+
   return pShm;
 }
 
+/* Detach all the cached buffers, called when the dispatch is no longer debugged */
+static void hsail_tdep_release_cached_shm_buffers(void)
+{
+  int i = 0;
+
+  for (i = 0; i < HSAIL_SHM_BUFFER_COUNT; i++)
+    {
+      if (gs_shm_mappings[i].shm != NULL)
+        {
+          if (shmdt(gs_shm_mappings[i].shm) == -1)
+            {
+              ui_out_text(current_uiout, "GDB: Error detaching buffer\n");
+            }
+          gs_shm_mappings[i].shm = NULL;
+        }
+    }
+
+  gs_wave_buffer_generation++;
+
+  /* The snapshot points into the wave buffer */
+  hsail_wave_free_snapshot();
+}
+
+/* The generation of the wave buffer's content.
+ * Anything computed from the wave buffer is valid as long as this does not change
+ */
+unsigned int hsail_tdep_get_wave_buffer_generation(void)
+{
+  return gs_wave_buffer_generation;
+}
+
+void* hsail_tdep_map_loadmap_buffer(void)
+{
+  return hsail_tdep_map_cached_shm_buffer(HSAIL_SHM_BUFFER_LOADMAP);
+}
+
 void* hsail_tdep_map_momentary_bp_buffer(void)
 {
-  struct ui_out* uiout = current_uiout;
+  return hsail_tdep_map_cached_shm_buffer(HSAIL_SHM_BUFFER_MOMENTARY_BP);
+}
 
-  void* pShm = NULL;
-  int shmid = -1;
-  int max_shared_mem_size = hsail_get_momentary_bp_buffer_shmem_max_size();
+/* Set once we have complained about a wave buffer header we cannot use */
+static bool gs_wave_buffer_header_warned = false;
 
-  gdb_assert(NULL != uiout);
+static bool hsail_tdep_is_wave_buffer_framed(const void* pShm)
+{
+  return pShm != NULL
+         && ((const HsailWaveBufferHeader*)pShm)->m_magic == HSAIL_WAVE_BUFFER_MAGIC;
+}
 
-  if (hsail_is_focus_device() == false || is_hsail_linux_initialized() == false)
+/* Check that the waves and stamps the header points to are inside the mapped buffer */
+static bool hsail_tdep_is_wave_buffer_layout_valid(const HsailWaveBufferHeader* header)
+{
+  size_t max_size = (size_t)hsail_get_wave_buffer_shmem_max_size();
+  size_t num_waves = 0;
+
+  gdb_assert(header != NULL);
+
+  if (header->m_numWaves < 0)
+    {
+      return false;
+    }
+  num_waves = (size_t)header->m_numWaves;
+
+  if (header->m_wavesOffset < sizeof(HsailWaveBufferHeader)
+      || header->m_wavesOffset % sizeof(uint64_t) != 0
+      || header->m_wavesOffset > max_size
+      || num_waves > (max_size - header->m_wavesOffset) / sizeof(HsailAgentWaveInfo))
+    {
+      return false;
+    }
+
+  if (header->m_stampsOffset < sizeof(HsailWaveBufferHeader)
+      || header->m_stampsOffset % sizeof(uint64_t) != 0
+      || header->m_stampsOffset > max_size
+      || num_waves > (max_size - header->m_stampsOffset) / sizeof(uint64_t))
+    {
+      return false;
+    }
+
+  return true;
+}
+
+/* The header of the incremental wave buffer layout.
+ * NULL if the agent wrote the waves from the start of the buffer,
+ * or if the header has a version or layout we cannot read */
+static const HsailWaveBufferHeader* hsail_tdep_wave_buffer_header(const void* pShm)
+{
+  const HsailWaveBufferHeader* header = (const HsailWaveBufferHeader*)pShm;
+  const char* reason = NULL;
+
+  if (!hsail_tdep_is_wave_buffer_framed(pShm))
     {
       return NULL;
     }
 
-  shmid = shmget(hsail_get_momentary_bp_buffer_shmem_key(),
-                 max_shared_mem_size, 0666);
+  if (header->m_version == 0 || header->m_version > HSAIL_WAVE_BUFFER_VERSION)
+    {
+      reason = "unsupported version";
+    }
+  else if (!hsail_tdep_is_wave_buffer_layout_valid(header))
+    {
+      reason = "offsets outside the buffer";
+    }
 
-  if (shmid <= 0)
+  if (reason != NULL)
     {
-      ui_out_text(uiout, "momentary_bp_buffer mapping: shmid is invalid\n");
+      if (!gs_wave_buffer_header_warned)
+        {
+          printf_filtered("[ROCm-gdb]: Ignoring the agent wave buffer, %s (version %d)\n",
+                          reason, (int)header->m_version);
+          gs_wave_buffer_header_warned = true;
+        }
+      return NULL;
     }
 
-  gdb_assert(shmid > 0);
+  return header;
+}
 
-  /* Get shm pointer */
-  pShm = (void*)shmat(shmid, NULL, 0);
+/* Map and unmap the wave buffer from the shared memory
+ * This returns the HsailAgentWaveInfo array, whatever the layout of the buffer */
+void* hsail_tdep_map_wave_buffer(void)
+{
+  char* pShm = (char*)hsail_tdep_map_cached_shm_buffer(HSAIL_SHM_BUFFER_WAVE_INFO);
+  const HsailWaveBufferHeader* header = hsail_tdep_wave_buffer_header(pShm);
 
-  gdb_assert(pShm != NULL);
+  if (header != NULL)
+    {
+      return pShm + header->m_wavesOffset;
+    }
+
+  /* There is no safe place to read the waves from behind a header we cannot use */
+  if (hsail_tdep_is_wave_buffer_framed(pShm))
+    {
+      return NULL;
+    }
 
   return pShm;
 }
 
-/* Map and unmap the wave buffer from the shared memory */
-void* hsail_tdep_map_wave_buffer(void)
+/* The header of the wave buffer, NULL unless the agent uses the incremental layout */
+const HsailWaveBufferHeader* hsail_tdep_get_wave_buffer_header(void)
 {
-  struct ui_out* uiout = current_uiout;
+  return hsail_tdep_wave_buffer_header(hsail_tdep_map_cached_shm_buffer(HSAIL_SHM_BUFFER_WAVE_INFO));
+}
 
+/* Map the GDB --> agent command ring.
+ * Unlike the other buffers the ring stays mapped until hsail_linux_close.
+ * If the agent did not create the ring, commands are only sent on the fifo.
+ */
+static void hsail_tdep_map_command_ring(void)
+{
   void* pShm = NULL;
   int shmid = -1;
-  const int max_shared_mem_size = hsail_get_wave_buffer_shmem_max_size();
+  HsailCommandRing* ring = NULL;
 
-  gdb_assert(NULL != uiout);
-  /*1M used is hard wired for now*/
+  gdb_assert(sizeof(HsailCommandRing) <= hsail_get_command_ring_shmem_max_size());
 
-  if (hsail_is_focus_device() == false || is_hsail_linux_initialized() == false)
+  if (gs_hsail_command_ring != NULL)
     {
-      return NULL;
+      return;
     }
 
-  shmid = shmget(hsail_get_wave_buffer_shmem_key(), max_shared_mem_size, 0666);
+  shmid = shmget(hsail_get_command_ring_shmem_key(),
+                 hsail_get_command_ring_shmem_max_size(), 0666);
+  if (shmid < 0)
+    {
+      return;
+    }
 
-  if (shmid <= 0)
+  pShm = shmat(shmid, NULL, 0);
+  if (pShm == (void*)-1)
     {
-      ui_out_text(uiout, "wave info buffer mapping: shmid is invalid\n");
+      return;
     }
 
-  gdb_assert(shmid > 0);
+  /* Only accept a ring that matches our layout */
+  ring = (HsailCommandRing*)pShm;
+  if (ring->m_capacity != HSAIL_COMMAND_RING_CAPACITY)
+    {
+      shmdt(pShm);
+      return;
+    }
 
-  /* Get shm pointer */
-  pShm = (void*)shmat(shmid, NULL, 0);
+  gs_hsail_command_ring = ring;
+}
 
-  gdb_assert(pShm != NULL);
+static void hsail_tdep_unmap_command_ring(void)
+{
+  if (gs_hsail_command_ring != NULL)
+    {
+      hsail_tdep_unmap_shm_buffer((void*)gs_hsail_command_ring);
+      gs_hsail_command_ring = NULL;
+    }
+}
 
-  return pShm;
+/* Return the command ring, NULL if the commands should go to the fifo */
+HsailCommandRing* hsail_tdep_get_command_ring(void)
+{
+  return gs_hsail_command_ring;
 }
 
 void hsail_tdep_unmap_shm_buffer(void* pShm)
 {
   struct ui_out* uiout = current_uiout;
+  int i = 0;
   gdb_assert(NULL != uiout);
   gdb_assert(NULL != pShm);
 
+  /* The cached buffers are only detached at the end of debugging */
+  for (i = 0; i < HSAIL_SHM_BUFFER_COUNT; i++)
+    {
+      if (gs_shm_mappings[i].shm == pShm)
+        {
+          return;
+        }
+    }
+
   /* Detach shared memory */
   if (shmdt(pShm) == -1)
     {
@@ -606,11 +942,14 @@ void hsail_linux_close(void)
        */
       if (fifo_descriptor > 0)
         {
+          /* No commands can be sent from now on */
+          hsail_tdep_unmap_command_ring();
+
           /* \todo Add error checking of status */
           status = close(fifo_descriptor );
 
           /* Delete fifo from file system*/
-          unlink(gs_GdbToAgentFifoName);
+          unlink(gs_hsail_gdb_to_agent_fifo_name);
         }
 
       /* use the variable directly and not the function since there is an assertion check there that might happen
@@ -627,35 +966,56 @@ void hsail_linux_close(void)
           status = close(fifo_descriptor );
 
           /* Delete fifo from file system*/
-          unlink(gs_AgentToGdbFifoName);
+          unlink(gs_hsail_agent_to_gdb_fifo_name);
         }
 
 
+      hsail_tdep_release_cached_shm_buffers();
+
       /* We can assert on is_shm_closed() since if the shared memory ID cannot be found,
        * we just dont do the deletion. The assertion catches what happened during the
        * actual deletion
        * */
-      is_shm_closed = hsail_linux_delete_shmem(g_DBEBINARY_SHMKEY, g_BINARY_BUFFER_MAXSIZE);
+      is_shm_closed = hsail_linux_delete_shmem(hsail_get_agent_binary_shmem_key(),
+                                               hsail_get_agent_binary_shmem_max_size());
       if (!is_shm_closed)
         {
           ui_out_text(uiout, "GDB: Binary buffer could not be detached\n");
         }
       gdb_assert(is_shm_closed == true);
 
-      is_shm_closed = hsail_linux_delete_shmem(g_WAVE_BUFFER_SHMKEY, g_WAVE_BUFFER_MAXSIZE);
+      is_shm_closed = hsail_linux_delete_shmem(hsail_get_wave_buffer_shmem_key(),
+                                               hsail_get_wave_buffer_shmem_max_size());
       if (!is_shm_closed)
         {
           ui_out_text(uiout, "GDB: Wave buffer could not be detached\n");
         }
       gdb_assert(is_shm_closed == true);
 
-      is_shm_closed = hsail_linux_delete_shmem(g_MOMENTARY_BP_BUFFER_SHMKEY, g_MOMENTARY_BP_BUFFER_MAXSIZE);
+      is_shm_closed = hsail_linux_delete_shmem(hsail_get_momentary_bp_buffer_shmem_key(),
+                                               hsail_get_momentary_bp_buffer_shmem_max_size());
       if (!is_shm_closed)
         {
           ui_out_text(uiout, "GDB: Momentary BP buffer could not be detached\n");
         }
       gdb_assert(is_shm_closed == true);
 
+      is_shm_closed = hsail_linux_delete_shmem(hsail_get_command_ring_shmem_key(),
+                                               hsail_get_command_ring_shmem_max_size());
+      if (!is_shm_closed)
+        {
+          ui_out_text(uiout, "GDB: Command ring could not be detached\n");
+        }
+      gdb_assert(is_shm_closed == true);
+
+      /* The loadmap and ISA buffers belong to this session too,
+       * they are normally freed by the agent */
+      hsail_linux_delete_shmem(hsail_get_loadmap_buffer_shmem_key(),
+                               hsail_get_loadmap_buffer_shmem_max_size());
+      hsail_linux_delete_shmem(hsail_get_isa_buffer_shmem_key(),
+                               hsail_get_isa_buffer_shmem_max_size());
+      unlink(gs_hsail_isa_file_path);
+
       /* Close tracing if it is on*/
       hsail_trace_stop();
 
@@ -833,219 +1193,641 @@ void hsail_tdep_print_notification_type(const HsailNotification notification)
 }
 
 
-/*
- * This function is called from "handle_file_event (event_data data)"
- * in eventloop.c
- */
-void handle_hsail_event(int err, gdb_client_data client_data)
+/* Process a single notification from the agent,
+ * call the right function in rocm-* files */
+static void hsail_tdep_process_notification(HsailNotificationPayload* fifo_data)
 {
-
-  struct ui_out* uiout = current_uiout;
-  int read_status = 0;
-  int bytes_read = 0;
   bool ret_code = false;
-  HsailNotificationPayload fifo_data;
   HwDbgInfo_debug dbg = NULL;
 
-  gdb_assert(NULL != uiout);
+  gdb_assert(fifo_data != NULL);
 
-  /* Just a debug counter to track how many times the
-   * handle_hsail_event function is called, result printed in linux_nat_close()
-   * */
-  gs_num_handle_event_function_calls = gs_num_handle_event_function_calls + 1;
+  /* Logging function to view notifications */
+  /* hsail_tdep_print_notification_type(fifo_data->m_Notification);*/
+
+  switch (fifo_data->m_Notification)
+  {
+    case HSAIL_NOTIFY_NEW_BINARY:
+      {
+        /* On this event,
+         * 1) Free any existing debug facilities objects. We can do this since we know that
+         * only one binary is active at any point in time, so the new binary notification
+         * should come after the previous kernel has ended debugging
+         *
+         * 2) initialize debug facilities with the new binary
+         * 3) flush the command buffer if there is anything left
+         * 4) Add the dispatch to the list of kernels, and if a new kernel save to a file
+         * */
+        hsail_free_hwdbginfo();
+
+        /* We set to HSAIL_AGENT_BINARY_AVAILABLE just to let hsail_init_hwdbginfo
+         * know about the new binary
+         * */
+        hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
+
+        /* We set to HSAIL_AGENT_BINARY_AVAILABLE if hsail_init_hwdbginfo
+         * can initialize debug facilities with the new binary available.
+         *
+         * If the initialization fails, we restore the status to HSAIL_AGENT_BINARY_UNKNOWN
+         * */
+
+        dbg = NULL;
+        dbg = hsail_init_hwdbginfo(fifo_data);
+
+        /* Save the kernel to the temp_source and update statistics  for the dispatch.
+         *
+         * It is possible that if debug facilities didn't initialize correctly, then the
+         * kernel source buffer may not be present.
+         * */
+        ret_code = hsail_kernel_add_dispatch(fifo_data);
+        gdb_assert(ret_code == true);
+
+        if (dbg != NULL)
+          {
+            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
 
-  memset(&fifo_data,0,sizeof(HsailNotificationPayload));
-  bytes_read  = read(hsail_get_read_fifo_handler(),
-          &fifo_data,
-          sizeof(HsailNotificationPayload));
+            /* Save the kernel's ISA */
+            hsail_tdep_save_isa(false, "temp_isa");
 
-  /* save errno to a local variable*/
-  read_status = errno;
+          }
+        else
+          {
 
-  /* We need to figure out why the event-loop implementation is called multiple times
-   * when the FIFO is not ready with new data
-   * This is not treated as a error for now
-   * */
-  if (bytes_read == -1 && read_status == EAGAIN)
+            rocm_printf_filtered("HSAIL kernel source debugging will not occur\n");
+
+            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
+          }
+
+        /* update the kernel launch trace */
+        hsail_trace_add_dispatch(fifo_data);
+
+        hsail_flush_breakpoint_command_buffer();
+
+        adjust_breakpoint_all_hsail();
+
+        break;
+      }
+    case HSAIL_NOTIFY_PREDISPATCH_STATE:
+      {
+        gdb_assert(fifo_data->payload.PredispatchNotification.m_predispatchState
+                   != HSAIL_PREDISPATCH_STATE_UNKNOWN);
+        gs_hsail_predispatch_state = fifo_data->payload.PredispatchNotification.m_predispatchState;
+
+        hsail_thread_set_dispatch_host_thread_pid(
+            fifo_data->payload.PredispatchNotification.m_HostDispatchTid);
+        break;
+      }
+    case HSAIL_NOTIFY_START_DEBUG_THREAD:
+      {
+        hsail_infcmd_set_dispatch_thread_pid(fifo_data->payload.StartDebugThreadNotification.m_tid);
+        break;
+      }
+    case HSAIL_NOTIFY_BREAKPOINT_HIT:
+      {
+        hsail_breakpoint_update_statistics(fifo_data->payload.BreakpointHit.m_breakpointId,
+                                           fifo_data->payload.BreakpointHit.m_hitCount,
+                                           HSAIL_MAX_REPORTABLE_BREAKPOINTS);
+
+        hsail_tdep_set_active_wave_count(fifo_data->payload.BreakpointHit.m_numActiveWaves);
+
+        break;
+      }
+    case HSAIL_NOTIFY_BEGIN_DEBUGGING:
+      {
+        gs_is_hsail_focus_device = true;
+        hsail_tdep_set_active_wave_count(0);
+        break;
+      }
+    case HSAIL_NOTIFY_END_DEBUGGING:
+      {
+        /*We now focus on the host*/
+        gs_is_hsail_focus_device = false;
+
+        /* The binary we have now is invalid if and only if the dispatch has completed.
+         *
+         * This check handles cases where we end debugging with the DISABLE_DISPATCH
+         * behavior flag and then restart debugging within the callback.
+         */
+        if (fifo_data->payload.EndDebugNotification.hasDispatchCompleted)
+          {
+            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
+          }
+
+        hsail_tdep_set_active_wave_count(0);
+        hsail_thread_clear_focus();
+        rocm_unset_active_device();
+
+        /* The agent may free or rewrite the buffers once the dispatch is released */
+        hsail_tdep_release_cached_shm_buffers();
+        break;
+      }
+    case HSAIL_NOTIFY_FOCUS_CHANGE:
+      {
+        hsail_thread_set_focus(fifo_data->payload.FocusChange.m_focusWorkGroup,
+                               fifo_data->payload.FocusChange.m_focusWorkItem);
+        break;
+      }
+    case HSAIL_NOTIFY_AGENT_ERROR:
+      {
+        printf_filtered("Agent Error: %d \n", fifo_data->payload.AgentErrorNotification.m_errorCode);
+        break;
+      }
+    case HSAIL_NOTIFY_KILL_COMPLETE:
+      {
+        if (fifo_data->payload.KillCompleteNotification.killSuccessful)
+          {
+            hsail_tdep_set_active_wave_count(0);
+          }
+        else
+          {
+            printf_filtered("Could not kill waves safely");
+          }
+        break;
+      }
+    case HSAIL_NOTIFY_NEW_ACTIVE_WAVES:
+      {
+        hsail_tdep_set_active_wave_count(fifo_data->payload.NewActiveWaveNotification.m_numActiveWaves);
+        break;
+      }
+    case HSAIL_NOTIFY_DEVICES:
+      {
+        rocm_set_devices(fifo_data);
+        break;
+      }
+    default:
+      printf_filtered("Unsupported notification type");
+  }
+}
+
+/* The number of full size notifications read from the fifo with one read call */
+#define HSAIL_NOTIFICATION_BATCH_LEN 32
+
+/* The notifications read from the fifo but not processed yet.
+ * A read can end in the middle of a notification, the bytes of the incomplete
+ * notification are kept at the start of the buffer for the next read */
+static char gs_notification_batch[HSAIL_NOTIFICATION_BATCH_LEN * sizeof(HsailNotificationPayload)];
+static size_t gs_notification_batch_bytes = 0;
+
+/* Set once we have complained about a frame version we do not know */
+static bool gs_notification_version_warned = false;
+
+/* State updates from the agent where only the last one in a batch matters.
+ * They are held back till the end of the batch or till a notification that
+ * may depend on them is processed */
+typedef struct _HsailCoalescedState
+{
+  bool has_wave_count;
+  int wave_count;
+
+  bool has_focus;
+  HsailWaveDim3 focus_work_group;
+  HsailWaveDim3 focus_work_item;
+
+  bool has_predispatch_state;
+  HsailPredispatchState predispatch_state;
+  int host_dispatch_tid;
+} HsailCoalescedState;
+
+static void hsail_tdep_apply_coalesced_state(HsailCoalescedState* state)
+{
+  gdb_assert(state != NULL);
+
+  if (state->has_predispatch_state)
     {
-      return;
+      gs_hsail_predispatch_state = state->predispatch_state;
+      hsail_thread_set_dispatch_host_thread_pid(state->host_dispatch_tid);
     }
 
-  /*
-   * Since the read fifo is created in a nonblocking manner.
-   * The read returns instantly if there is no data on the fifo
-   * with bytesRead = 0
-   * */
-  if (bytes_read != sizeof(HsailNotificationPayload))
+  if (state->has_wave_count)
     {
-      /* We have some unusual error code.
-       * We should atleast print it for now
-       * This commonly happens if the shared header used between GDB and the agent are not in sync
-       * */
-      if(bytes_read != 0)
-      {
-          printf_filtered("Handle_hsail_event error %d\t Bytes read %d\t ",err, bytes_read);
-          printf_filtered("Read fifo errno:  %d \n", read_status);
-      }
+      hsail_tdep_set_active_wave_count(state->wave_count);
     }
-  else
+
+  if (state->has_focus)
     {
-      /* Based on the data the agent sent us, call the right function in rocm-* files */
+      hsail_thread_set_focus(state->focus_work_group, state->focus_work_item);
+    }
+
+  memset(state, 0, sizeof(HsailCoalescedState));
+}
 
-      /* Logging function to view notifications */
-      /* hsail_tdep_print_notification_type(fifo_data.m_Notification);*/
+/* Either fold the notification into the coalesced state or
+ * apply the state and then process the notification */
+static void hsail_tdep_coalesce_notification(HsailNotificationPayload* fifo_data,
+                                             HsailCoalescedState* state)
+{
+  gdb_assert(fifo_data != NULL);
+  gdb_assert(state != NULL);
 
-      switch (fifo_data.m_Notification)
+  switch (fifo_data->m_Notification)
+  {
+    case HSAIL_NOTIFY_PREDISPATCH_STATE:
       {
-        case HSAIL_NOTIFY_NEW_BINARY:
-          {
-            /* On this event,
-             * 1) Free any existing debug facilities objects. We can do this since we know that
-             * only one binary is active at any point in time, so the new binary notification
-             * should come after the previous kernel has ended debugging
-             *
-             * 2) initialize debug facilities with the new binary
-             * 3) flush the command buffer if there is anything left
-             * 4) Add the dispatch to the list of kernels, and if a new kernel save to a file
-             * */
-            hsail_free_hwdbginfo();
-
-            /* We set to HSAIL_AGENT_BINARY_AVAILABLE just to let hsail_init_hwdbginfo
-             * know about the new binary
-             * */
-            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
+        gdb_assert(fifo_data->payload.PredispatchNotification.m_predispatchState
+                   != HSAIL_PREDISPATCH_STATE_UNKNOWN);
+        state->has_predispatch_state = true;
+        state->predispatch_state = fifo_data->payload.PredispatchNotification.m_predispatchState;
+        state->host_dispatch_tid = fifo_data->payload.PredispatchNotification.m_HostDispatchTid;
+        break;
+      }
+    case HSAIL_NOTIFY_BREAKPOINT_HIT:
+      {
+        /* The agent sends the full hit count, so the statistics can be applied
+         * straight away and only the wave count needs to wait */
+        hsail_breakpoint_update_statistics(fifo_data->payload.BreakpointHit.m_breakpointId,
+                                           fifo_data->payload.BreakpointHit.m_hitCount,
+                                           HSAIL_MAX_REPORTABLE_BREAKPOINTS);
+        state->has_wave_count = true;
+        state->wave_count = fifo_data->payload.BreakpointHit.m_numActiveWaves;
+        break;
+      }
+    case HSAIL_NOTIFY_NEW_ACTIVE_WAVES:
+      {
+        state->has_wave_count = true;
+        state->wave_count = fifo_data->payload.NewActiveWaveNotification.m_numActiveWaves;
+        break;
+      }
+    case HSAIL_NOTIFY_FOCUS_CHANGE:
+      {
+        state->has_focus = true;
+        hsail_utils_copy_wavedim3(&state->focus_work_group,
+                                  &fifo_data->payload.FocusChange.m_focusWorkGroup);
+        hsail_utils_copy_wavedim3(&state->focus_work_item,
+                                  &fifo_data->payload.FocusChange.m_focusWorkItem);
+        break;
+      }
+    default:
+      {
+        hsail_tdep_apply_coalesced_state(state);
+        hsail_tdep_process_notification(fifo_data);
+        break;
+      }
+  }
+}
 
-            /* We set to HSAIL_AGENT_BINARY_AVAILABLE if hsail_init_hwdbginfo
-             * can initialize debug facilities with the new binary available.
-             *
-             * If the initialization fails, we restore the status to HSAIL_AGENT_BINARY_UNKNOWN
-             * */
+/* Return true if the first 4 bytes of the buffer are a frame header
+ * and not the m_Notification of a full size notification */
+static bool hsail_tdep_is_notification_frame(const char* buffer)
+{
+  HsailNotificationHeader header;
 
-            dbg = NULL;
-            dbg = hsail_init_hwdbginfo(&fifo_data);
+  memcpy(&header.m_magic, buffer, sizeof(header.m_magic));
 
-            /* Save the kernel to the temp_source and update statistics  for the dispatch.
-             *
-             * It is possible that if debug facilities didn't initialize correctly, then the
-             * kernel source buffer may not be present.
-             * */
-            ret_code = hsail_kernel_add_dispatch(&fifo_data);
-            gdb_assert(ret_code == true);
+  return (header.m_magic == HSAIL_NOTIFICATION_FRAME_MAGIC);
+}
 
-            if (dbg != NULL)
-              {
-                hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
+/* Return the size of the notification at the start of the buffer,
+ * 0 if more bytes are needed to know it or (size_t)-1 if the bytes
+ * are neither a frame nor a full size notification */
+static size_t hsail_tdep_get_notification_size(const char* buffer, const size_t num_bytes)
+{
+  HsailNotificationHeader header;
+  HsailNotification notification = HSAIL_NOTIFY_UNKNOWN;
 
-                /* Save the kernel's ISA */
-                hsail_tdep_save_isa(false, "temp_isa");
+  if (num_bytes < sizeof(uint32_t))
+    {
+      return 0;
+    }
 
-              }
-            else
-              {
+  if (!hsail_tdep_is_notification_frame(buffer))
+    {
+      memcpy(&notification, buffer, sizeof(HsailNotification));
+      if (notification <= HSAIL_NOTIFY_UNKNOWN || notification > HSAIL_NOTIFY_DEVICES)
+        {
+          return (size_t)-1;
+        }
 
-                rocm_printf_filtered("HSAIL kernel source debugging will not occur\n");
+      return sizeof(HsailNotificationPayload);
+    }
 
-                hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
-              }
+  if (num_bytes < sizeof(HsailNotificationHeader))
+    {
+      return 0;
+    }
 
-            /* update the kernel launch trace */
-            hsail_trace_add_dispatch(&fifo_data);
+  memcpy(&header, buffer, sizeof(HsailNotificationHeader));
 
-            hsail_flush_breakpoint_command_buffer();
+  /* The whole frame has to fit in the batch buffer */
+  if (header.m_payloadSize > sizeof(gs_notification_batch) - sizeof(HsailNotificationHeader))
+    {
+      return (size_t)-1;
+    }
 
-            adjust_breakpoint_all_hsail();
+  return sizeof(HsailNotificationHeader) + header.m_payloadSize;
+}
 
-            break;
-          }
-        case HSAIL_NOTIFY_PREDISPATCH_STATE:
-          {
-            gdb_assert(fifo_data.payload.PredispatchNotification.m_predispatchState
-                       != HSAIL_PREDISPATCH_STATE_UNKNOWN);
-            gs_hsail_predispatch_state = fifo_data.payload.PredispatchNotification.m_predispatchState;
+/* Expand a frame into full size notifications and coalesce them.
+ * Breakpoint hits with more than HSAIL_MAX_REPORTABLE_BREAKPOINTS records
+ * are split, they all carry the same wave count.
+ *
+ * Returns false if the frame is malformed */
+static bool hsail_tdep_coalesce_notification_frame(const char* frame,
+                                                   HsailCoalescedState* state)
+{
+  HsailNotificationHeader header;
+  HsailNotificationPayload fifo_data;
+  const char* payload = frame + sizeof(HsailNotificationHeader);
 
-            hsail_thread_set_dispatch_host_thread_pid(
-                fifo_data.payload.PredispatchNotification.m_HostDispatchTid);
-            break;
-          }
-        case HSAIL_NOTIFY_START_DEBUG_THREAD:
-          {
-            hsail_infcmd_set_dispatch_thread_pid(fifo_data.payload.StartDebugThreadNotification.m_tid);
-            break;
-          }
-        case HSAIL_NOTIFY_BREAKPOINT_HIT:
-          {
-            hsail_breakpoint_update_statistics(fifo_data.payload.BreakpointHit.m_breakpointId,
-                                               fifo_data.payload.BreakpointHit.m_hitCount,
-                                               HSAIL_MAX_REPORTABLE_BREAKPOINTS);
+  memcpy(&header, frame, sizeof(HsailNotificationHeader));
+
+  if (header.m_version == 0 || header.m_version > HSAIL_NOTIFICATION_FRAME_VERSION)
+    {
+      /* The length is still valid so we can skip the frame */
+      if (!gs_notification_version_warned)
+        {
+          printf_filtered("[ROCm-gdb]: Ignoring agent notifications with unsupported version %d\n",
+                          header.m_version);
+          gs_notification_version_warned = true;
+        }
+      return true;
+    }
+
+  memset(&fifo_data, 0, sizeof(HsailNotificationPayload));
+  fifo_data.m_Notification = (HsailNotification)header.m_notification;
 
-            hsail_tdep_set_active_wave_count(fifo_data.payload.BreakpointHit.m_numActiveWaves);
+  switch (fifo_data.m_Notification)
+  {
+    case HSAIL_NOTIFY_BREAKPOINT_HIT:
+      {
+        HsailBreakpointHitFrame hit_frame;
+        const HsailBreakpointHitRecord* records = NULL;
+        int i = 0;
+        int j = 0;
 
-            break;
+        if (header.m_payloadSize < sizeof(HsailBreakpointHitFrame))
+          {
+            return false;
           }
-        case HSAIL_NOTIFY_BEGIN_DEBUGGING:
+
+        memcpy(&hit_frame, payload, sizeof(HsailBreakpointHitFrame));
+        if (hit_frame.m_numBreakpoints < 0
+            || header.m_payloadSize != sizeof(HsailBreakpointHitFrame)
+               + hit_frame.m_numBreakpoints * sizeof(HsailBreakpointHitRecord))
           {
-            gs_is_hsail_focus_device = true;
-            hsail_tdep_set_active_wave_count(0);
-            break;
+            return false;
           }
-        case HSAIL_NOTIFY_END_DEBUGGING:
+
+        records = (const HsailBreakpointHitRecord*)(payload + sizeof(HsailBreakpointHitFrame));
+
+        /* Send at least one notification so that the wave count is updated */
+        i = 0;
+        do
           {
-            /*We now focus on the host*/
-            gs_is_hsail_focus_device = false;
-
-            /* The binary we have now is invalid if and only if the dispatch has completed.
-             *
-             * This check handles cases where we end debugging with the DISABLE_DISPATCH
-             * behavior flag and then restart debugging within the callback.
-             */
-            if (fifo_data.payload.EndDebugNotification.hasDispatchCompleted)
+            for (j = 0; j < HSAIL_MAX_REPORTABLE_BREAKPOINTS; j++, i++)
               {
-                hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
+                if (i < hit_frame.m_numBreakpoints)
+                  {
+                    fifo_data.payload.BreakpointHit.m_breakpointId[j] = records[i].m_breakpointId;
+                    fifo_data.payload.BreakpointHit.m_hitCount[j] = records[i].m_hitCount;
+                  }
+                else
+                  {
+                    fifo_data.payload.BreakpointHit.m_breakpointId[j] = -1;
+                    fifo_data.payload.BreakpointHit.m_hitCount[j] = 0;
+                  }
               }
+            fifo_data.payload.BreakpointHit.m_numActiveWaves = hit_frame.m_numActiveWaves;
 
-            hsail_tdep_set_active_wave_count(0);
-            hsail_thread_clear_focus();
-            rocm_unset_active_device();
-            break;
-          }
-        case HSAIL_NOTIFY_FOCUS_CHANGE:
-          {
-            hsail_thread_set_focus(fifo_data.payload.FocusChange.m_focusWorkGroup,
-                                   fifo_data.payload.FocusChange.m_focusWorkItem);
-            break;
+            hsail_tdep_coalesce_notification(&fifo_data, state);
           }
-        case HSAIL_NOTIFY_AGENT_ERROR:
-          {
-            printf_filtered("Agent Error: %d \n", fifo_data.payload.AgentErrorNotification.m_errorCode);
-            break;
-          }
-        case HSAIL_NOTIFY_KILL_COMPLETE:
+        while (i < hit_frame.m_numBreakpoints);
+
+        return true;
+      }
+    case HSAIL_NOTIFY_DEVICES:
+      {
+        HsailDevicesFrame devices_frame;
+
+        if (header.m_payloadSize < sizeof(HsailDevicesFrame))
           {
-            if (fifo_data.payload.KillCompleteNotification.killSuccessful)
-              {
-                hsail_tdep_set_active_wave_count(0);
-              }
-            else
-              {
-                printf_filtered("Could not kill waves safely");
-              }
-            break;
+            return false;
           }
-        case HSAIL_NOTIFY_NEW_ACTIVE_WAVES:
+
+        memcpy(&devices_frame, payload, sizeof(HsailDevicesFrame));
+        if (devices_frame.m_devicesNum < 0
+            || devices_frame.m_devicesNum > AGENT_MAX_DEVICES_NUM
+            || header.m_payloadSize != sizeof(HsailDevicesFrame)
+               + devices_frame.m_devicesNum * sizeof(RocmDeviceDesc))
           {
-            hsail_tdep_set_active_wave_count(fifo_data.payload.NewActiveWaveNotification.m_numActiveWaves);
-            break;
+            return false;
           }
-        case HSAIL_NOTIFY_DEVICES:
+
+        fifo_data.payload.DevicesNotification.m_devicesNum = devices_frame.m_devicesNum;
+        memcpy(fifo_data.payload.DevicesNotification.m_deviceDescriptors,
+               payload + sizeof(HsailDevicesFrame),
+               devices_frame.m_devicesNum * sizeof(RocmDeviceDesc));
+        break;
+      }
+    default:
+      {
+        /* The payload is the notification's member of the union,
+         * anything not sent stays zeroed */
+        if (fifo_data.m_Notification <= HSAIL_NOTIFY_UNKNOWN
+            || fifo_data.m_Notification > HSAIL_NOTIFY_DEVICES
+            || header.m_payloadSize > sizeof(fifo_data.payload))
           {
-            rocm_set_devices(&fifo_data);
-            break;
+            return false;
           }
-        default:
-          printf_filtered("Unsupported notification type");
+
+        memcpy(&fifo_data.payload, payload, header.m_payloadSize);
+        break;
       }
+  }
+
+  hsail_tdep_coalesce_notification(&fifo_data, state);
+
+  return true;
+}
+
+/*
+ * This function is called from "handle_file_event (event_data data)"
+ * in eventloop.c
+ *
+ * All the notifications pending on the fifo are read and processed as a batch.
+ * Both framed and full size notifications are accepted.
+ */
+void handle_hsail_event(int err, gdb_client_data client_data)
+{
+  struct ui_out* uiout = current_uiout;
+  int read_status = 0;
+  ssize_t bytes_read = 0;
+  size_t bytes_requested = 0;
+  size_t bytes_processed = 0;
+  size_t notification_size = 0;
+  bool is_valid = true;
+  HsailCoalescedState coalesced_state;
+
+  gdb_assert(NULL != uiout);
+
+  /* Just a debug counter to track how many times the
+   * handle_hsail_event function is called, result printed in linux_nat_close()
+   * */
+  gs_num_handle_event_function_calls = gs_num_handle_event_function_calls + 1;
+
+  memset(&coalesced_state, 0, sizeof(HsailCoalescedState));
+
+  do
+    {
+      bytes_requested = sizeof(gs_notification_batch) - gs_notification_batch_bytes;
+      bytes_read = read(hsail_get_read_fifo_handler(),
+                        gs_notification_batch + gs_notification_batch_bytes,
+                        bytes_requested);
+
+      /* save errno to a local variable*/
+      read_status = errno;
+
+      /* We need to figure out why the event-loop implementation is called multiple times
+       * when the FIFO is not ready with new data
+       * This is not treated as a error for now
+       *
+       * Since the read fifo is created in a nonblocking manner,
+       * the read also returns 0 instantly if the agent has closed its end
+       * */
+      if (bytes_read <= 0)
+        {
+          if (bytes_read == -1 && read_status != EAGAIN && read_status != EINTR)
+            {
+              printf_filtered("Handle_hsail_event error %d\t Bytes read %d\t ",
+                              err, (int)bytes_read);
+              printf_filtered("Read fifo errno:  %d \n", read_status);
+            }
+          break;
+        }
+
+      gs_notification_batch_bytes += bytes_read;
+
+      bytes_processed = 0;
+      while (true)
+        {
+          const char* notification = gs_notification_batch + bytes_processed;
+
+          notification_size = hsail_tdep_get_notification_size(notification,
+                                                               gs_notification_batch_bytes - bytes_processed);
+
+          if (notification_size == (size_t)-1)
+            {
+              is_valid = false;
+              break;
+            }
+
+          if (notification_size == 0
+              || notification_size > gs_notification_batch_bytes - bytes_processed)
+            {
+              break;
+            }
+
+          if (hsail_tdep_is_notification_frame(notification))
+            {
+              is_valid = hsail_tdep_coalesce_notification_frame(notification, &coalesced_state);
+            }
+          else
+            {
+              HsailNotificationPayload fifo_data;
+              memcpy(&fifo_data, notification, sizeof(HsailNotificationPayload));
+              hsail_tdep_coalesce_notification(&fifo_data, &coalesced_state);
+            }
+
+          /* Processing a notification may close the fifo.
+           * The rest of the batch and the held back state cannot be applied
+           * to a closed session, so drop them but say so */
+          if (!is_hsail_linux_initialized())
+            {
+              size_t bytes_dropped = gs_notification_batch_bytes - bytes_processed
+                                     - notification_size;
+
+              if (bytes_dropped > 0
+                  || coalesced_state.has_wave_count
+                  || coalesced_state.has_focus
+                  || coalesced_state.has_predispatch_state)
+                {
+                  printf_filtered("[ROCm-gdb]: The agent fifo was closed, "
+                                  "dropping %d bytes of notifications "
+                                  "and the pending agent state\n",
+                                  (int)bytes_dropped);
+                }
+
+              memset(&coalesced_state, 0, sizeof(HsailCoalescedState));
+              gs_notification_batch_bytes = 0;
+              return;
+            }
+
+          if (!is_valid)
+            {
+              break;
+            }
+
+          bytes_processed += notification_size;
+        }
+
+      if (!is_valid)
+        {
+          /* We cannot find the start of the next notification anymore.
+           * This commonly happens if the shared header used between GDB and the agent are not in sync
+           * */
+          printf_filtered("[ROCm-gdb]: Unrecognized notification from the agent, "
+                          "dropping %d bytes\n",
+                          (int)(gs_notification_batch_bytes - bytes_processed));
+          gs_notification_batch_bytes = 0;
+          break;
+        }
+
+      /* Keep the incomplete notification, if any, for the next read */
+      gs_notification_batch_bytes -= bytes_processed;
+      if (gs_notification_batch_bytes > 0 && bytes_processed > 0)
+        {
+          memmove(gs_notification_batch,
+                  gs_notification_batch + bytes_processed,
+                  gs_notification_batch_bytes);
+        }
     }
+  /* A short read means the fifo has been drained */
+  while ((size_t)bytes_read == bytes_requested);
 
+  hsail_tdep_apply_coalesced_state(&coalesced_state);
+}
+
+/* Pick the debug session ID and derive the fifo names from it.
+ * The rocm-gdb script sets the ID so it can clean up after us, otherwise we use our pid.
+ * The ID is passed on to the agent through the inferior's environment.
+ */
+static void hsail_tdep_initialize_session(void)
+{
+  const char* session_env = getenv(gs_SessionIdEnvVar);
+  char session_id[16];
+
+  gs_hsail_session_id = 0;
+  if (session_env != NULL)
+    {
+      gs_hsail_session_id = atoi(session_env);
+    }
+
+  if (gs_hsail_session_id <= 0)
+    {
+      gs_hsail_session_id = (int)getpid();
+    }
+
+  xsnprintf(session_id, sizeof(session_id), "%d", gs_hsail_session_id);
+  setenv(gs_SessionIdEnvVar, session_id, 1);
+
+  hsail_tdep_set_ipc_names(false);
+}
+
+/* Let the agent know that it can send framed notifications,
+ * write the incremental wave buffer layout and skip copying cached code objects.
+ * This has to be done before the first inferior is created,
+ * since the inferior's environment is copied from ours */
+static void hsail_tdep_advertise_ipc_formats(void)
+{
+  char version[16];
+
+  xsnprintf(version, sizeof(version), "%d", HSAIL_NOTIFICATION_FRAME_VERSION);
+  setenv(gs_NotificationFormatEnvVar, version, 1);
+
+  xsnprintf(version, sizeof(version), "%d", HSAIL_WAVE_BUFFER_VERSION);
+  setenv(gs_WaveBufferFormatEnvVar, version, 1);
+
+  xsnprintf(version, sizeof(version), "%d", HSAIL_CODE_OBJECT_VERSION);
+  setenv(gs_CodeObjectCacheEnvVar, version, 1);
 }
 
 /* Called when gdb is shut down */
@@ -1059,4 +1841,15 @@ void hsail_linux_do_final_cleanup(void)
   hsail_command_clear_argument_buff();
 
   hsail_free_command_buffer();
+
+  hsail_source_cache_clear();
+
+  hsail_dbginfo_clear_cache();
+}
+
+void
+_initialize_rocm_tdep (void)
+{
+  hsail_tdep_initialize_session();
+  hsail_tdep_advertise_ipc_formats();
 }
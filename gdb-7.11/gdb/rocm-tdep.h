@@ -81,8 +81,14 @@ void* hsail_tdep_map_momentary_bp_buffer(void);
 
 void* hsail_tdep_map_wave_buffer(void);
 
+const HsailWaveBufferHeader* hsail_tdep_get_wave_buffer_header(void);
+
 void hsail_tdep_unmap_shm_buffer(void* pShm);
 
+unsigned int hsail_tdep_get_wave_buffer_generation(void);
+
+HsailCommandRing* hsail_tdep_get_command_ring(void);
+
 bool hsail_tdep_save_isa(bool is_disassemble_command, const char* hsail_isa_file_name);
 
 /*
@@ -43,6 +43,7 @@
 #include "rocm-thread.h"
 #include "rocm-tdep.h"
 #include "rocm-utils.h"
+#include "rocm-wave.h"
 
 /* The header files shared with the agent*/
 #include "CommunicationControl.h"
@@ -59,55 +60,29 @@ static long gs_active_host_dispatch_thread_id = 0;
 
 static bool hsail_thread_validate_thread_active(const unsigned int* workGroup, const unsigned int* workItem)
 {
-  /* get the waves info */
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-  int nWave = 0;
-  /* a single bit rotated left each time to compare whether each workitem in  a wave is active */
-  uint64_t current_bit = 0;
-  bool found = false;
+  const struct hsail_wave_snapshot* snapshot = hsail_wave_get_snapshot();
+  HsailWaveDim3 wg;
+  HsailWaveDim3 wi;
 
   /* A NULL is possible if no dispatch is active*/
-  if (NULL == wave_info_buffer)
+  if (NULL == snapshot)
     {
-      return found;
+      return false;
     }
 
   gdb_assert(NULL != workGroup);
   gdb_assert(NULL != workItem);
 
+  wg.x = workGroup[0];
+  wg.y = workGroup[1];
+  wg.z = workGroup[2];
 
-  for (nWave = 0 ; nWave < num_waves ; nWave++)
-    {
-      /* check the work-group first */
-      if (workGroup[0] == wave_info_buffer[nWave].workGroupId.x &&
-          workGroup[1] == wave_info_buffer[nWave].workGroupId.y &&
-          workGroup[2] == wave_info_buffer[nWave].workGroupId.z)
-        {
-          int wi_index = 0;
-          /* check all exec flags for the work item */
-          current_bit = 1;
-          for (wi_index = 0 ; wi_index < 64 ; wi_index++)
-            {
-              /* if the work item's exec bit in the wave's execMask is true */
-              if (wave_info_buffer[nWave].execMask & current_bit)
-                {
-                  if (workItem[0] == wave_info_buffer[nWave].workItemId[wi_index].x &&
-                      workItem[1] == wave_info_buffer[nWave].workItemId[wi_index].y &&
-                      workItem[2] == wave_info_buffer[nWave].workItemId[wi_index].z)
-                    {
-                      found = true;
-                    }
-                  current_bit = current_bit<<1;
-                }
-            }
-        }
-    }
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_shm_buffer((void*)wave_info_buffer);
+  wi.x = workItem[0];
+  wi.y = workItem[1];
+  wi.z = workItem[2];
 
-  return found;
+  /* Only work-items whose exec bit is set in their wave are indexed */
+  return hsail_wave_find_work_item(snapshot, &wg, &wi, NULL, NULL);
 }
 
 static void hsail_thread_print_focus_change(void)
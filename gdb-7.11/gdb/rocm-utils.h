@@ -75,6 +75,9 @@ char* hsail_utils_get_timestamp(void);
 /* Return the home directory for the user */
 char* hsail_utils_get_home_directory(void);
 
+/* Format a source line to be sent to the agent, the caller has to free it */
+char* hsail_utils_format_source_line(const char* raw_line, size_t len);
+
 char* hsail_utils_read_line_from_file(const char* file_name, HwDbgInfo_linenum line_num);
 
 /* Read file into a array, allocates the array and returns the size. The caller has to free it. */
@@ -0,0 +1,555 @@
+/*
+   ROCm GDB indexed snapshot of the active waves.
+
+   Copyright (c) 2015-2016 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdbool.h>
+#include <string.h>
+
+/* GDB headers */
+#include "defs.h"
+#include "gdb_assert.h"
+#include "hashtab.h"
+
+/* rocm-gdb headers */
+#include "rocm-tdep.h"
+#include "rocm-utils.h"
+#include "rocm-wave.h"
+
+/* The header files shared with the agent*/
+#include "CommunicationControl.h"
+
+/* The snapshot of the present stop */
+static struct hsail_wave_snapshot gs_wave_snapshot;
+static bool gs_is_wave_snapshot_valid = false;
+
+/* Key used to look up the work-item index */
+struct hsail_wave_work_item_key
+{
+  const HsailWaveDim3* work_group;
+  const HsailWaveDim3* work_item;
+};
+
+static hashval_t hsail_wave_hash_dim3(const HsailWaveDim3* dim, hashval_t hash)
+{
+  hash = iterative_hash_object(dim->x, hash);
+  hash = iterative_hash_object(dim->y, hash);
+  hash = iterative_hash_object(dim->z, hash);
+  return hash;
+}
+
+/* hash_f for the work-group index, the entries point into work_groups */
+static hashval_t hsail_wave_hash_work_group(const void* p)
+{
+  return hsail_wave_hash_dim3((const HsailWaveDim3*)p, 0);
+}
+
+/* eq_f for the work-group index */
+static int hsail_wave_eq_work_group(const void* entry, const void* key)
+{
+  return hsail_utils_compare_wavedim3((const HsailWaveDim3*)entry, (const HsailWaveDim3*)key);
+}
+
+static hashval_t hsail_wave_hash_work_item_key(const struct hsail_wave_work_item_key* key)
+{
+  return hsail_wave_hash_dim3(key->work_item,
+                              hsail_wave_hash_dim3(key->work_group, 0));
+}
+
+/* hash_f for the work-item index, the entries point into lanes */
+static hashval_t hsail_wave_hash_lane(const void* p)
+{
+  const struct hsail_wave_lane* lane = (const struct hsail_wave_lane*)p;
+  struct hsail_wave_work_item_key key;
+  HsailWaveDim3 work_item;
+
+  hsail_wave_get_work_item(&gs_wave_snapshot, lane->wave_index, lane->lane, &work_item);
+
+  key.work_group = &gs_wave_snapshot.waves[lane->wave_index].workGroupId;
+  key.work_item = &work_item;
+
+  return hsail_wave_hash_work_item_key(&key);
+}
+
+/* eq_f for the work-item index, the key is a struct hsail_wave_work_item_key */
+static int hsail_wave_eq_lane(const void* entry, const void* p)
+{
+  const struct hsail_wave_lane* lane = (const struct hsail_wave_lane*)entry;
+  const struct hsail_wave_work_item_key* key = (const struct hsail_wave_work_item_key*)p;
+  int column_index = lane->wave_index * HSAIL_WAVE_LANE_COUNT + lane->lane;
+
+  return (gs_wave_snapshot.work_item_x[column_index] == key->work_item->x &&
+          gs_wave_snapshot.work_item_y[column_index] == key->work_item->y &&
+          gs_wave_snapshot.work_item_z[column_index] == key->work_item->z &&
+          hsail_utils_compare_wavedim3(&gs_wave_snapshot.waves[lane->wave_index].workGroupId,
+                                       key->work_group));
+}
+
+/* Release the work-group and work-item indices, the columns are kept */
+static void hsail_wave_free_indices(struct hsail_wave_snapshot* snapshot)
+{
+  if (snapshot->work_group_index != NULL)
+    {
+      htab_delete(snapshot->work_group_index);
+      snapshot->work_group_index = NULL;
+    }
+
+  if (snapshot->work_item_index != NULL)
+    {
+      htab_delete(snapshot->work_item_index);
+      snapshot->work_item_index = NULL;
+    }
+
+  xfree(snapshot->work_groups);
+  snapshot->work_groups = NULL;
+  snapshot->num_work_groups = 0;
+
+  xfree(snapshot->wave_work_group);
+  snapshot->wave_work_group = NULL;
+
+  xfree(snapshot->work_group_wave_start);
+  snapshot->work_group_wave_start = NULL;
+
+  xfree(snapshot->work_group_waves);
+  snapshot->work_group_waves = NULL;
+
+  xfree(snapshot->lanes);
+  snapshot->lanes = NULL;
+  snapshot->num_lanes = 0;
+}
+
+void hsail_wave_free_snapshot(void)
+{
+  struct hsail_wave_snapshot* snapshot = &gs_wave_snapshot;
+
+  hsail_wave_free_indices(snapshot);
+
+  xfree(snapshot->exec_masks);
+  xfree(snapshot->pcs);
+  xfree(snapshot->work_item_x);
+  xfree(snapshot->work_item_y);
+  xfree(snapshot->work_item_z);
+
+  memset(snapshot, 0, sizeof(struct hsail_wave_snapshot));
+  gs_is_wave_snapshot_valid = false;
+}
+
+/* Group the waves by work-group, keeping the order of the first wave of each group */
+static void hsail_wave_index_work_groups(struct hsail_wave_snapshot* snapshot)
+{
+  int nWave = 0;
+  int nWorkgroup = 0;
+  int* wave_work_group = NULL;
+  int* fill_position = NULL;
+  void** slot = NULL;
+
+  snapshot->work_groups = (HsailWaveDim3*)xmalloc(sizeof(HsailWaveDim3) * snapshot->num_waves);
+  snapshot->work_group_index = htab_create_alloc(snapshot->num_waves,
+                                                 hsail_wave_hash_work_group,
+                                                 hsail_wave_eq_work_group,
+                                                 NULL, xcalloc, xfree);
+
+  /* The work-group of each wave, used to fill the per group wave lists */
+  wave_work_group = (int*)xmalloc(sizeof(int) * snapshot->num_waves);
+  snapshot->wave_work_group = wave_work_group;
+
+  snapshot->num_work_groups = 0;
+  for (nWave = 0; nWave < snapshot->num_waves; nWave++)
+    {
+      const HsailWaveDim3* wg = &snapshot->waves[nWave].workGroupId;
+
+      slot = htab_find_slot(snapshot->work_group_index, wg, INSERT);
+      if (*slot == NULL)
+        {
+          hsail_utils_copy_wavedim3(&snapshot->work_groups[snapshot->num_work_groups], wg);
+          *slot = &snapshot->work_groups[snapshot->num_work_groups];
+          snapshot->num_work_groups++;
+        }
+
+      wave_work_group[nWave] = (HsailWaveDim3*)*slot - snapshot->work_groups;
+    }
+
+  /* Count the waves of each group, then place them */
+  snapshot->work_group_wave_start = (int*)xcalloc(snapshot->num_work_groups + 1, sizeof(int));
+  snapshot->work_group_waves = (int*)xmalloc(sizeof(int) * snapshot->num_waves);
+
+  for (nWave = 0; nWave < snapshot->num_waves; nWave++)
+    {
+      snapshot->work_group_wave_start[wave_work_group[nWave] + 1]++;
+    }
+
+  for (nWorkgroup = 0; nWorkgroup < snapshot->num_work_groups; nWorkgroup++)
+    {
+      snapshot->work_group_wave_start[nWorkgroup + 1] += snapshot->work_group_wave_start[nWorkgroup];
+    }
+
+  fill_position = (int*)xmalloc(sizeof(int) * (snapshot->num_work_groups + 1));
+  memcpy(fill_position, snapshot->work_group_wave_start,
+         sizeof(int) * (snapshot->num_work_groups + 1));
+
+  for (nWave = 0; nWave < snapshot->num_waves; nWave++)
+    {
+      snapshot->work_group_waves[fill_position[wave_work_group[nWave]]++] = nWave;
+    }
+
+  xfree(fill_position);
+}
+
+/* Copy a wave into the snapshot columns.
+ * Return true if its exec mask, work-group or work-items changed,
+ * in which case the indices have to be rebuilt */
+static bool hsail_wave_update_columns(struct hsail_wave_snapshot* snapshot, int wave_index)
+{
+  const HsailAgentWaveInfo* wave = &snapshot->waves[wave_index];
+  int column_base = wave_index * HSAIL_WAVE_LANE_COUNT;
+  bool is_changed = false;
+  int nLane = 0;
+
+  if (snapshot->exec_masks[wave_index] != wave->execMask ||
+      (snapshot->wave_work_group != NULL &&
+       !hsail_utils_compare_wavedim3(&snapshot->work_groups[snapshot->wave_work_group[wave_index]],
+                                     &wave->workGroupId)))
+    {
+      is_changed = true;
+    }
+
+  snapshot->exec_masks[wave_index] = wave->execMask;
+  snapshot->pcs[wave_index] = wave->pc;
+
+  for (nLane = 0; nLane < HSAIL_WAVE_LANE_COUNT; nLane++)
+    {
+      is_changed |= (snapshot->work_item_x[column_base + nLane] != wave->workItemId[nLane].x ||
+                     snapshot->work_item_y[column_base + nLane] != wave->workItemId[nLane].y ||
+                     snapshot->work_item_z[column_base + nLane] != wave->workItemId[nLane].z);
+
+      snapshot->work_item_x[column_base + nLane] = wave->workItemId[nLane].x;
+      snapshot->work_item_y[column_base + nLane] = wave->workItemId[nLane].y;
+      snapshot->work_item_z[column_base + nLane] = wave->workItemId[nLane].z;
+    }
+
+  return is_changed;
+}
+
+/* Transpose the fields used by the queries into the snapshot columns */
+static void hsail_wave_build_columns(struct hsail_wave_snapshot* snapshot)
+{
+  int nWave = 0;
+  size_t num_columns = (size_t)snapshot->num_waves * HSAIL_WAVE_LANE_COUNT;
+
+  snapshot->exec_masks = (uint64_t*)xcalloc(snapshot->num_waves, sizeof(uint64_t));
+  snapshot->pcs = (uint64_t*)xcalloc(snapshot->num_waves, sizeof(uint64_t));
+  snapshot->work_item_x = (uint32_t*)xcalloc(num_columns, sizeof(uint32_t));
+  snapshot->work_item_y = (uint32_t*)xcalloc(num_columns, sizeof(uint32_t));
+  snapshot->work_item_z = (uint32_t*)xcalloc(num_columns, sizeof(uint32_t));
+
+  for (nWave = 0; nWave < snapshot->num_waves; nWave++)
+    {
+      hsail_wave_update_columns(snapshot, nWave);
+    }
+}
+
+/* Index every active lane by its work-group and work-item */
+static void hsail_wave_index_work_items(struct hsail_wave_snapshot* snapshot)
+{
+  int nWave = 0;
+  int nLane = 0;
+  int num_lanes = 0;
+  uint64_t lanes_left = 0;
+  struct hsail_wave_work_item_key key;
+  HsailWaveDim3 work_item;
+  void** slot = NULL;
+
+  for (nWave = 0; nWave < snapshot->num_waves; nWave++)
+    {
+      num_lanes += hsail_wave_lane_count(snapshot->exec_masks[nWave]);
+    }
+
+  snapshot->lanes = (struct hsail_wave_lane*)xmalloc(sizeof(struct hsail_wave_lane) * (num_lanes + 1));
+  snapshot->work_item_index = htab_create_alloc(num_lanes,
+                                                hsail_wave_hash_lane,
+                                                hsail_wave_eq_lane,
+                                                NULL, xcalloc, xfree);
+
+  snapshot->num_lanes = 0;
+  for (nWave = 0; nWave < snapshot->num_waves; nWave++)
+    {
+      ALL_HSAIL_WAVE_LANES (snapshot->exec_masks[nWave], lanes_left, nLane)
+        {
+          hsail_wave_get_work_item(snapshot, nWave, nLane, &work_item);
+          key.work_group = &snapshot->waves[nWave].workGroupId;
+          key.work_item = &work_item;
+
+          slot = htab_find_slot_with_hash(snapshot->work_item_index, &key,
+                                          hsail_wave_hash_work_item_key(&key),
+                                          INSERT);
+
+          /* A work-item should only be active in one lane, keep the first one */
+          if (*slot == NULL)
+            {
+              struct hsail_wave_lane* lane = &snapshot->lanes[snapshot->num_lanes++];
+              lane->wave_index = nWave;
+              lane->lane = nLane;
+              *slot = lane;
+            }
+        }
+    }
+}
+
+/* Bring the snapshot up to date with an update of the incremental wave buffer,
+ * reading only the waves the agent rewrote.
+ * Return false if the update cannot be applied and the snapshot has to be rebuilt */
+static bool hsail_wave_apply_update(struct hsail_wave_snapshot* snapshot,
+                                    const HsailWaveBufferHeader* header,
+                                    const HsailAgentWaveInfo* waves,
+                                    int num_waves)
+{
+  const uint64_t* stamps = NULL;
+  bool is_reindex_needed = false;
+  int nDirty = 0;
+  int nWave = 0;
+
+  if (!gs_is_wave_snapshot_valid || !snapshot->is_incremental ||
+      header == NULL || snapshot->waves != waves ||
+      snapshot->num_waves == 0 || snapshot->num_waves != num_waves ||
+      header->m_numWaves != num_waves ||
+      header->m_generation < snapshot->agent_generation)
+    {
+      return false;
+    }
+
+  if (header->m_baseGeneration == snapshot->agent_generation &&
+      header->m_numDirtyWaves != HSAIL_WAVE_BUFFER_ALL_DIRTY)
+    {
+      /* The dirty list is relative to the generation we have */
+      if (header->m_numDirtyWaves < 0 ||
+          header->m_numDirtyWaves > HSAIL_WAVE_BUFFER_MAX_DIRTY_WAVES)
+        {
+          return false;
+        }
+
+      for (nDirty = 0; nDirty < header->m_numDirtyWaves; nDirty++)
+        {
+          nWave = header->m_dirtyWaves[nDirty];
+          if (nWave < 0 || nWave >= num_waves)
+            {
+              return false;
+            }
+
+          is_reindex_needed |= hsail_wave_update_columns(snapshot, nWave);
+        }
+    }
+  else
+    {
+      /* We missed an update or the list overflowed, use the stamps.
+       * The header has been checked to hold m_numWaves stamps inside the buffer */
+      stamps = (const uint64_t*)((const char*)header + header->m_stampsOffset);
+
+      for (nWave = 0; nWave < num_waves; nWave++)
+        {
+          if (stamps[nWave] > snapshot->agent_generation)
+            {
+              is_reindex_needed |= hsail_wave_update_columns(snapshot, nWave);
+            }
+        }
+    }
+
+  /* In a single step usually only the PCs move */
+  if (is_reindex_needed)
+    {
+      hsail_wave_free_indices(snapshot);
+      hsail_wave_index_work_groups(snapshot);
+      hsail_wave_index_work_items(snapshot);
+    }
+
+  snapshot->agent_generation = header->m_generation;
+
+  return true;
+}
+
+const struct hsail_wave_snapshot* hsail_wave_get_snapshot(void)
+{
+  struct hsail_wave_snapshot* snapshot = &gs_wave_snapshot;
+  unsigned int generation = hsail_tdep_get_wave_buffer_generation();
+  int num_waves = 0;
+  HsailAgentWaveInfo* wave_info_buffer = NULL;
+  const HsailWaveBufferHeader* header = NULL;
+
+  if (gs_is_wave_snapshot_valid && snapshot->generation == generation)
+    {
+      return (snapshot->num_waves > 0) ? snapshot : NULL;
+    }
+
+  num_waves = hsail_tdep_get_active_wave_count();
+  wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
+  header = hsail_tdep_get_wave_buffer_header();
+
+  /* Do not read past the waves the agent wrote */
+  if (header != NULL && num_waves > header->m_numWaves)
+    {
+      num_waves = header->m_numWaves;
+    }
+
+  if (wave_info_buffer != NULL && num_waves > 0 &&
+      hsail_wave_apply_update(snapshot, header, wave_info_buffer, num_waves))
+    {
+      snapshot->generation = generation;
+      return snapshot;
+    }
+
+  hsail_wave_free_snapshot();
+
+  snapshot->generation = generation;
+  gs_is_wave_snapshot_valid = true;
+
+  /* A NULL is possible if no dispatch is active */
+  if (wave_info_buffer == NULL || num_waves <= 0)
+    {
+      return NULL;
+    }
+
+  /* The wave buffer stays mapped till the end of debugging,
+   * which also changes the generation */
+  snapshot->waves = wave_info_buffer;
+  snapshot->num_waves = num_waves;
+
+  if (header != NULL)
+    {
+      snapshot->is_incremental = true;
+      snapshot->agent_generation = header->m_generation;
+    }
+
+  hsail_wave_build_columns(snapshot);
+  hsail_wave_index_work_groups(snapshot);
+  hsail_wave_index_work_items(snapshot);
+
+  return snapshot;
+}
+
+int hsail_wave_find_work_group(const struct hsail_wave_snapshot* snapshot,
+                               const HsailWaveDim3* work_group)
+{
+  const HsailWaveDim3* entry = NULL;
+
+  gdb_assert(work_group != NULL);
+
+  if (snapshot == NULL)
+    {
+      return -1;
+    }
+
+  entry = (const HsailWaveDim3*)htab_find(snapshot->work_group_index, work_group);
+  if (entry == NULL)
+    {
+      return -1;
+    }
+
+  return entry - snapshot->work_groups;
+}
+
+bool hsail_wave_find_work_item(const struct hsail_wave_snapshot* snapshot,
+                               const HsailWaveDim3* work_group,
+                               const HsailWaveDim3* work_item,
+                               int* wave_index, int* lane)
+{
+  struct hsail_wave_work_item_key key;
+  const struct hsail_wave_lane* entry = NULL;
+
+  gdb_assert(work_group != NULL);
+  gdb_assert(work_item != NULL);
+
+  if (snapshot == NULL)
+    {
+      return false;
+    }
+
+  key.work_group = work_group;
+  key.work_item = work_item;
+
+  entry = (const struct hsail_wave_lane*)htab_find_with_hash(snapshot->work_item_index, &key,
+                                                             hsail_wave_hash_work_item_key(&key));
+  if (entry == NULL)
+    {
+      return false;
+    }
+
+  if (wave_index != NULL)
+    {
+      *wave_index = entry->wave_index;
+    }
+
+  if (lane != NULL)
+    {
+      *lane = entry->lane;
+    }
+
+  return true;
+}
+
+uint64_t hsail_wave_match_work_item(const struct hsail_wave_snapshot* snapshot,
+                                    int wave_index,
+                                    const HsailWaveDim3* work_item)
+{
+  const uint32_t* x = NULL;
+  const uint32_t* y = NULL;
+  const uint32_t* z = NULL;
+  uint8_t lane_match[HSAIL_WAVE_LANE_COUNT];
+  uint64_t match_mask = 0;
+  int nLane = 0;
+
+  gdb_assert(snapshot != NULL);
+  gdb_assert(work_item != NULL);
+  gdb_assert(wave_index >= 0 && wave_index < snapshot->num_waves);
+
+  x = &snapshot->work_item_x[wave_index * HSAIL_WAVE_LANE_COUNT];
+  y = &snapshot->work_item_y[wave_index * HSAIL_WAVE_LANE_COUNT];
+  z = &snapshot->work_item_z[wave_index * HSAIL_WAVE_LANE_COUNT];
+
+  /* Compare all the lanes without branching so that the loop is vectorized,
+   * then pack the result into a mask */
+  for (nLane = 0; nLane < HSAIL_WAVE_LANE_COUNT; nLane++)
+    {
+      lane_match[nLane] = (x[nLane] == work_item->x) &
+                          (y[nLane] == work_item->y) &
+                          (z[nLane] == work_item->z);
+    }
+
+  for (nLane = 0; nLane < HSAIL_WAVE_LANE_COUNT; nLane++)
+    {
+      match_mask |= (uint64_t)lane_match[nLane] << nLane;
+    }
+
+  return match_mask & snapshot->exec_masks[wave_index];
+}
+
+void hsail_wave_get_work_item(const struct hsail_wave_snapshot* snapshot,
+                              int wave_index, int lane,
+                              HsailWaveDim3* work_item)
+{
+  int column_index = wave_index * HSAIL_WAVE_LANE_COUNT + lane;
+
+  gdb_assert(snapshot != NULL);
+  gdb_assert(work_item != NULL);
+  gdb_assert(lane >= 0 && lane < HSAIL_WAVE_LANE_COUNT);
+
+  work_item->x = snapshot->work_item_x[column_index];
+  work_item->y = snapshot->work_item_y[column_index];
+  work_item->z = snapshot->work_item_z[column_index];
+}
@@ -0,0 +1,154 @@
+/*
+   ROCm GDB indexed snapshot of the active waves.
+
+   Copyright (c) 2015-2016 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_WAVE_H)
+#define HSAIL_WAVE_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hashtab.h"
+
+/* The header files shared with the agent*/
+#include "CommunicationControl.h"
+
+/* The number of lanes of a wave, one bit of the exec mask each */
+#define HSAIL_WAVE_LANE_COUNT 64
+
+/* A snapshot of the wave buffer with the indices needed by the
+ * work-group and work-item queries.
+ *
+ * The snapshot is built once per stop, the first time it is asked for, and
+ * reused till the wave buffer generation changes.
+ * Nothing in it should be kept across a resume of the inferior.
+ *
+ * The per lane and per wave fields used by the queries are also kept as
+ * separate columns, so that scanning them does not pull in the rest of
+ * HsailAgentWaveInfo and the lane comparisons can be vectorized.
+ * */
+struct hsail_wave_snapshot
+{
+  /* The wave buffer generation the snapshot was built from */
+  unsigned int generation;
+
+  /* The agent's generation of the wave buffer, only used with the incremental
+   * layout. A later update can then be applied to the snapshot
+   * by reading only the waves the agent rewrote */
+  bool is_incremental;
+  uint64_t agent_generation;
+
+  /* The waves reported by the agent, this points to the mapped wave buffer */
+  int num_waves;
+  const HsailAgentWaveInfo* waves;
+
+  /* Per wave columns, indexed by wave */
+  uint64_t* exec_masks;
+  uint64_t* pcs;
+
+  /* Per lane columns of the work-item IDs,
+   * lane L of wave W is at W * HSAIL_WAVE_LANE_COUNT + L */
+  uint32_t* work_item_x;
+  uint32_t* work_item_y;
+  uint32_t* work_item_z;
+
+  /* The distinct work-groups, in the order of their first wave */
+  int num_work_groups;
+  HsailWaveDim3* work_groups;
+
+  /* The entry in work_groups of each wave */
+  int* wave_work_group;
+
+  /* The waves of work-group i are
+   * work_group_waves[work_group_wave_start[i] .. work_group_wave_start[i+1]-1] */
+  int* work_group_wave_start;
+  int* work_group_waves;
+
+  /* Work-group ID --> entry in work_groups */
+  htab_t work_group_index;
+
+  /* (Work-group ID, work-item ID) --> active lane */
+  int num_lanes;
+  struct hsail_wave_lane* lanes;
+  htab_t work_item_index;
+};
+
+/* An active lane of a wave */
+struct hsail_wave_lane
+{
+  int wave_index;
+  int lane;
+};
+
+/* Iterate over the set bits of MASK from the lowest, LANE is set to the
+ * index of each bit in turn and TMP holds the bits that are left */
+#define ALL_HSAIL_WAVE_LANES(MASK, TMP, LANE)                   \
+  for ((TMP) = (MASK);                                          \
+       (TMP) != 0 && ((LANE) = __builtin_ctzll(TMP), 1);        \
+       (TMP) &= (TMP) - 1)
+
+/* The number of lanes set in an exec mask */
+static inline int hsail_wave_lane_count(uint64_t exec_mask)
+{
+  return __builtin_popcountll(exec_mask);
+}
+
+/* The lowest lane set in an exec mask, the mask should not be 0 */
+static inline int hsail_wave_first_lane(uint64_t exec_mask)
+{
+  return __builtin_ctzll(exec_mask);
+}
+
+/* The highest lane set in an exec mask, the mask should not be 0 */
+static inline int hsail_wave_last_lane(uint64_t exec_mask)
+{
+  return (HSAIL_WAVE_LANE_COUNT - 1) - __builtin_clzll(exec_mask);
+}
+
+/* Return the snapshot for the present stop,
+ * NULL if no dispatch is active or no waves were reported */
+const struct hsail_wave_snapshot* hsail_wave_get_snapshot(void);
+
+/* Return the index of a work-group in the snapshot's work_groups or -1 */
+int hsail_wave_find_work_group(const struct hsail_wave_snapshot* snapshot,
+                               const HsailWaveDim3* work_group);
+
+/* Find the wave and lane that run a work-item, only active lanes are considered */
+bool hsail_wave_find_work_item(const struct hsail_wave_snapshot* snapshot,
+                               const HsailWaveDim3* work_group,
+                               const HsailWaveDim3* work_item,
+                               int* wave_index, int* lane);
+
+/* Return the mask of the active lanes of a wave that run a work-item */
+uint64_t hsail_wave_match_work_item(const struct hsail_wave_snapshot* snapshot,
+                                    int wave_index,
+                                    const HsailWaveDim3* work_item);
+
+/* Copy the work-item ID of a lane from the snapshot columns */
+void hsail_wave_get_work_item(const struct hsail_wave_snapshot* snapshot,
+                              int wave_index, int lane,
+                              HsailWaveDim3* work_item);
+
+/* Release the snapshot, called when the dispatch ends */
+void hsail_wave_free_snapshot(void);
+
+#endif // HSAIL_WAVE_H
@@ -43,6 +43,7 @@
 #include "ui-out.h"
 #include "readline/readline.h"
 #include "common/enum-flags.h"
+#include "rocm-source-cache.h"
 
 #define OPEN_MODE (O_RDONLY | O_BINARY)
 #define FDOPEN_MODE FOPEN_RB
@@ -1203,6 +1204,7 @@ find_source_lines (struct symtab *s, int desc)
   int *line_charpos;
   long mtime = 0;
   int size;
+  const struct hsail_source_file *cached_file;
 
   gdb_assert (s);
   line_charpos = XNEWVEC (int, lines_allocated);
@@ -1217,6 +1219,25 @@ find_source_lines (struct symtab *s, int desc)
   if (mtime && mtime < st.st_mtime)
     warning (_("Source file is more recent than executable."));
 
+  /* Use the line offsets of the ROCm source cache, so that a file
+     whose lines were already indexed is not read again.  */
+  cached_file = hsail_source_cache_lookup_desc (s->fullname, desc);
+  if (cached_file != NULL)
+    {
+      int i;
+
+      nlines = cached_file->num_lines > 0 ? cached_file->num_lines : 1;
+      xfree (line_charpos);
+      line_charpos = XNEWVEC (int, nlines);
+      line_charpos[0] = 0;
+      for (i = 1; i < nlines; i++)
+	line_charpos[i] = cached_file->line_offsets[i];
+
+      s->nlines = nlines;
+      s->line_charpos = line_charpos;
+      return;
+    }
+
   {
     struct cleanup *old_cleanups;
 
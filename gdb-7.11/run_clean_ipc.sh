@@ -2,12 +2,33 @@
 # Useful only while debugging.
 # To kill all the processes and also delete the leftover ipc handlers
 # Added since we dont clean up resources on crashes.
+#
+# Usage: run_clean_ipc.sh [session ID ...]
+# The IPC resources are named after the debug session ID (ROCM_GDB_IPC_SESSION_ID).
+# Without arguments, the IDs are taken from the leftover fifos in gdb/
 
 pkill -9 amd-gdb
 pkill -9 VectorAdd
+
+SESSION_IDS="$*"
+if [ -z "$SESSION_IDS" ]; then
+    for FIFO in gdb/fifo-agent-w-gdb-r-* gdb/fifo-gdb-w-agent-r-*; do
+        if [ -e "$FIFO" ]; then
+            SESSION_IDS="$SESSION_IDS ${FIFO##*-}"
+        fi
+    done
+    SESSION_IDS=$( echo $SESSION_IDS | tr ' ' '\n' | sort -u )
+fi
+
 ipcs
-ipcrm -M 5678
-ipcrm -M 1234
-rm gdb/fifo-agent-w-gdb-r
-rm gdb/fifo-gdb-w-agent-r
+for SESSION_ID in $SESSION_IDS; do
+    # The keys are derived as in HsailGetSessionShmKey (CommunicationParams.h),
+    # the slots are the shm HsailDebugConfigParam values plus one
+    for SHMSLOT in 1 2 3 4 5 8; do
+        ipcrm -M $(( 0x40000000 | (($SESSION_ID & 0x3ffffff) << 4) | SHMSLOT )) 2> /dev/null
+    done
+    rm -f gdb/fifo-agent-w-gdb-r-$SESSION_ID
+    rm -f gdb/fifo-gdb-w-agent-r-$SESSION_ID
+    rm -f /tmp/debugger_isa_dump-$SESSION_ID
+done
 ipcs